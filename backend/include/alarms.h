@@ -0,0 +1,147 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <Eigen/Dense>
+#include "target.h"
+#include "motion-model.h"
+#include "worker-pool.h"
+
+// Zones are looked up on a range-bearing grid over the coverage; bearings
+// are a power of two, so a bearing maps to its bin with a mask.
+constexpr int ALARM_GRID_BEARINGS = 1024;     // ~0.35 degrees
+constexpr int ALARM_GRID_RANGE_BINS = 256;    // ~3.9 m over MAX_DISTANCE
+
+struct AlarmZone {
+    enum class Shape : uint8_t {
+        Polygon = 0,
+        Sector = 1,
+    };
+
+    std::string name;
+    Shape shape = Shape::Polygon;
+    std::vector<Eigen::Vector2d> vertices;    // metres, x = d cos(angle), y = d sin(angle)
+    double min_range = 0.0;                   // sector, metres
+    double max_range = 0.0;
+    double from_angle = 0.0;                  // sector, radians counterclockwise to to_angle
+    double to_angle = 0.0;
+};
+
+// A target raises a rule's alarm on the tick it starts to meet all of the
+// rule's conditions, and can raise it again only once it has stopped. Speed
+// is the target's current velocity, or for a replayed frame the distance
+// covered since the previous one.
+struct AlarmRule {
+    std::string name;
+    int zone = -1;                            // index into the zones; -1 for anywhere
+    double max_range = -1.0;                  // metres from the radar; negative for no limit
+    double min_speed = -1.0;                  // metres per tick; negative for no limit
+};
+
+struct AlarmConfig {
+    std::vector<AlarmZone> zones;
+    std::vector<AlarmRule> rules;
+};
+
+// One definition per line, '#' starts a comment, bearings in degrees:
+//   zone NAME polygon x,y x,y x,y ...
+//   zone NAME sector MIN_RANGE MAX_RANGE FROM_BEARING TO_BEARING
+//   rule NAME [in ZONE] [within METRES] [faster METRES_PER_TICK]
+AlarmConfig loadAlarmConfig(const std::string& path);
+
+struct AlarmEvent {
+    uint64_t tick;
+    uint16_t rule;
+    int id;
+    float distance;
+    float angle;
+};
+
+// Evaluates every rule against every target once per tick. Zones are
+// rasterised once: each grid cell holds the set of rules whose zone covers
+// it, deduplicated into a small table of rule masks, so a target's zones are
+// one lookup. Each mask also keeps the loosest range and speed limits among
+// its rules, so a target that passes none of them meets just the mask's
+// rules without limits; if that is what it met on the previous tick, it is
+// done after the lookup. Only the few that remain have their rules checked
+// one by one against what they met before.
+class AlarmEngine {
+public:
+    AlarmEngine(const AlarmConfig& config, WorkerPool& workers);
+
+    // Appends one event per target and rule that became true this tick.
+    void evaluate(uint64_t tick, const MotionColumns* parts, size_t count, std::vector<AlarmEvent>& out);
+    // The same for a frame of targets, with speeds taken from their trails.
+    void evaluate(uint64_t tick, const Target* targets, size_t count, std::vector<AlarmEvent>& out);
+
+    const std::vector<AlarmRule>& rules() const;
+    // Distinct sets of rules over the grid cells.
+    size_t maskCount() const;
+
+private:
+    // A target passes some limited rule of a mask only if it is within range
+    // of a range-limited rule, fast enough for a speed-limited one, or both
+    // for a rule with both limits.
+    struct MaskBounds {
+        double range;
+        double speed_squared;
+        double both_range;
+        double both_speed_squared;
+        bool unlimited;                       // some rule has neither limit
+    };
+
+    // What each target slot met on the previous tick, for a page of slots.
+    // Pages are allocated as slots first need their rules checked.
+    struct StatePage {
+        std::vector<uint64_t> met;            // _words per slot
+        std::vector<int> ids;                 // target owning each slot, -1 for none
+    };
+
+    struct Block {
+        const MotionColumns* part;
+        size_t first;
+        size_t count;
+        std::vector<AlarmEvent> events;
+    };
+
+    // Targets of a block that need their rules checked.
+    struct Hits {
+        std::vector<uint32_t> index;
+        std::vector<int32_t> cell;
+    };
+
+    void rasterise(const AlarmZone& zone, std::vector<uint8_t>& inside) const;
+    void findHits(const Block& block, Hits& hits) const;
+    void claimPages(const Block& block, const Hits& hits);
+    void matchHits(uint64_t tick, Block& block, const Hits& hits);
+
+    WorkerPool& _workers;
+    std::vector<AlarmRule> _rules;
+    size_t _words;                            // uint64 words per rule mask
+    bool _needs_speed = false;
+    std::vector<double> _max_range;           // per rule, infinite for no limit
+    std::vector<double> _min_speed_squared;   // per rule, -1 for no limit
+    std::vector<uint64_t> _limited;           // rules with a range or speed limit
+    std::vector<uint16_t> _cell_mask;         // grid cells, then one cell beyond MAX_DISTANCE
+    std::vector<uint64_t> _masks;             // distinct rule masks, _words each
+    std::vector<MaskBounds> _bounds;          // per distinct mask
+
+    // Per slot, what it met on the previous tick: nothing, just the rules
+    // without limits of one mask for one generation of the slot, or anything
+    // else.
+    std::vector<uint32_t> _last;
+    std::vector<std::unique_ptr<StatePage>> _pages;   // by slot index
+    std::mutex _pages_mutex;
+    std::vector<Block> _blocks;
+
+    // A frame gathered into columns. Rules only need the speed, so it goes
+    // in vx with vy left at zero.
+    std::vector<int> _frame_ids;
+    std::vector<double> _frame_distance;
+    std::vector<double> _frame_angle;
+    std::vector<double> _frame_speed;
+    std::vector<double> _frame_zero;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "spatial-grid.h"
+#include "worker-pool.h"
+#include "sensor.h"
+
+struct AssociationConfig {
+    double gate = 9.21;             // squared Mahalanobis distance, 99% for 2 dof
+    double cell_size = 50.0;        // metres, grid over predicted track positions
+    double auction_epsilon = 0.01;  // final assignment is within n * epsilon of optimal
+};
+
+// Predicted track position and innovation covariance [sxx sxy; sxy syy].
+struct TrackGate {
+    double x;
+    double y;
+    double sxx;
+    double sxy;
+    double syy;
+};
+
+struct AssociationStats {
+    size_t edges = 0;
+    size_t clusters = 0;
+    size_t largest_cluster = 0;
+    size_t assigned = 0;
+    double gate_ms = 0.0;
+    double cluster_ms = 0.0;
+    double assign_ms = 0.0;
+};
+
+// Global nearest neighbour plot-to-track assignment. Plots are gated
+// against a grid of predicted track positions, tracks sharing a gated plot
+// form a cluster, and each cluster is solved on its own by an auction over
+// its sparse gate edges, clusters in parallel. Every track may also stay
+// unassigned at the cost of the gate, so a plot is only taken if it is
+// inside the gate and not better used by a neighbour.
+class Associator {
+public:
+    Associator(const AssociationConfig& config, WorkerPool& workers);
+
+    // track_plot[i] receives the plot index assigned to track i, or -1.
+    void associate(const std::vector<TrackGate>& tracks, const PlotBatch& plots, std::vector<int32_t>& track_plot);
+
+    const AssociationStats& stats() const;
+
+private:
+    struct Edge {
+        uint32_t track;
+        uint32_t plot;
+        float benefit;
+    };
+
+    void gatePlots(const std::vector<TrackGate>& tracks, const PlotBatch& plots);
+    void buildClusters(size_t track_count, size_t plot_count);
+    void auction(const uint32_t* tracks, size_t count, std::vector<int32_t>& track_plot);
+    uint32_t findRoot(uint32_t track);
+
+    AssociationConfig _config;
+    WorkerPool& _workers;
+    SpatialGrid _grid;
+    AssociationStats _stats;
+
+    std::vector<double> _track_xs;
+    std::vector<double> _track_ys;
+    std::vector<double> _inv_xx;
+    std::vector<double> _inv_xy;
+    std::vector<double> _inv_yy;
+    std::vector<std::vector<Edge>> _chunk_edges;
+
+    // Gate edges grouped by track (CSR), clusters as lists of tracks.
+    std::vector<uint32_t> _edge_start;
+    std::vector<Edge> _edges;
+    std::vector<uint32_t> _parent;
+    std::vector<int32_t> _plot_first_track;
+    std::vector<uint32_t> _cluster_start;
+    std::vector<uint32_t> _cluster_tracks;
+
+    std::vector<double> _prices;
+    std::vector<int32_t> _owners;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "sensor.h"
+#include "video.h"
+#include "clutter-map.h"
+#include "worker-pool.h"
+
+enum class CfarMethod : uint8_t {
+    CellAveraging,
+    OrderedStatistic,
+};
+
+CfarMethod parseCfarMethod(const std::string& name);
+
+struct CfarConfig {
+    CfarMethod method = CfarMethod::CellAveraging;
+    double training_length = 16.0;    // metres per side of the cell under test
+    double guard_length = 8.0;        // metres per side, kept out of the estimate so an echo does not raise its own threshold
+    double false_alarm_rate = 1e-6;   // per cell, in noise
+    double os_rank = 0.75;            // ordered statistic: rank within the training cells, as a fraction
+};
+
+// Constant false alarm rate detection over raw video, one spoke at a time.
+// The background power of each cell is estimated from training cells on
+// both sides in range: their mean (CA), or their k-th smallest value (OS),
+// which a second echo or a clutter edge in the window does not drag up.
+// Cells above the estimate times a factor set by the false alarm rate are
+// detections; touching detections in range and in neighbouring spokes are
+// merged into one plot at their power-weighted centre.
+//
+// With a clutter map a cell must also beat its own average over past
+// scans, which holds steady land clutter that the window in range cannot
+// tell from a target; each scan is then folded into the map.
+class CfarDetector {
+public:
+    CfarDetector(const CfarConfig& config, const VideoConfig& video, WorkerPool& workers);
+
+    // The map must match the video layout; null detaches it.
+    void setClutterMap(ClutterMap* map);
+    void detect(const VideoScan& video, PlotBatch& out);
+
+    const CfarConfig& config() const;
+    // Rough plot accuracy for the tracker: about a quarter of the beam and
+    // half the pulse.
+    double rangeSigma() const;
+    double bearingSigma() const;
+    size_t detectedCells() const { return _detected_cells; }
+
+private:
+    // Run of detected cells along one spoke.
+    struct Hit {
+        uint16_t first;
+        uint16_t last;
+        float power;          // summed over the run
+        float range_moment;   // sum of power * bin centre
+    };
+
+    // Per spoke; a cell is detected where excess > 0.
+    struct Scratch {
+        std::vector<float> power;
+        std::vector<double> prefix;
+        std::vector<float> level;
+        std::vector<float> excess;
+    };
+
+    void detectSpoke(int azimuth, const float* amplitude, std::vector<Hit>& hits, Scratch& scratch) const;
+    void window(int b, int& lag_first, int& lag_end, int& lead_first, int& lead_end) const;
+    void cellAveraging(Scratch& scratch) const;
+    void orderedStatistic(Scratch& scratch) const;
+    void mergeHits(uint64_t tick, PlotBatch& out);
+
+    CfarConfig _config;
+    VideoConfig _video;
+    WorkerPool& _workers;
+    ClutterMap* _clutter_map = nullptr;
+    int _training;                    // cells per side
+    int _guard;
+    std::vector<float> _scale;        // threshold factor by number of training cells in the window
+    std::vector<int> _rank;           // OS: rank used by number of training cells
+    std::vector<std::vector<Hit>> _hits;
+    std::vector<uint32_t> _parent;
+    std::vector<uint32_t> _hit_offsets;
+    std::vector<double> _sums;
+    size_t _detected_cells = 0;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+constexpr char CLUTTER_MAP_MAGIC[8] = { 'R', 'A', 'D', 'C', 'M', 'A', 'P', '1' };
+constexpr uint32_t CLUTTER_MAP_VERSION = 1;
+
+// On-disk layout: header, then azimuths x range_bins floats spoke by spoke.
+struct ClutterMapHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t azimuths;
+    uint32_t range_bins;
+    uint64_t scans;
+};
+
+struct ClutterMapConfig {
+    double time_constant = 16.0;      // scans; each scan moves a cell 1 / time_constant of the way
+    double false_alarm_rate = 1e-6;   // per cell, against the map alone
+    std::string path;                 // snapshot file, loaded at startup if present; empty for none
+    int snapshot_interval = 120;      // scans between snapshots
+};
+
+// Mean power of every range-azimuth cell over past scans, estimated from the
+// video: one contiguous float grid, spoke by spoke, updated in place with an
+// exponential moving average. Land clutter builds up in it, while a moving
+// target crosses a cell in a scan or two and hardly shows, so the map times
+// a factor is a threshold that follows the clutter cell by cell. Until it
+// has seen time_constant scans the map is a plain running mean.
+class ClutterMap {
+public:
+    ClutterMap(const ClutterMapConfig& config, int azimuths, int range_bins);
+
+    // False if there is no file; throws if it is not a map of this layout.
+    bool load(const std::string& path);
+    // Written beside the target and renamed over it, so a crash mid-write
+    // leaves the previous snapshot.
+    void save(const std::string& path) const;
+
+    // Starts a scan: fixes this scan's averaging weight and threshold factor.
+    void beginScan();
+    // Folds one spoke of cell powers into the map. Spokes of one scan may be
+    // updated in parallel.
+    void update(int spoke, const float* power);
+
+    const float* spoke(int azimuth) const { return _mean.data() + size_t(azimuth) * _range_bins; }
+    // Threshold factor on the map mean; zero while the map has seen nothing.
+    float scale() const { return _scale; }
+    uint64_t scans() const { return _scans; }
+    int azimuths() const { return _azimuths; }
+    int rangeBins() const { return _range_bins; }
+    const ClutterMapConfig& config() const { return _config; }
+
+private:
+    ClutterMapConfig _config;
+    int _azimuths;
+    int _range_bins;
+    uint64_t _scans = 0;
+    float _weight = 1.0f;
+    float _scale = 0.0f;
+    std::vector<float> _mean;
+};
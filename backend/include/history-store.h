@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+#include <cstdint>
+#include "tick-log.h"
+
+constexpr char HISTORY_CHUNK_MAGIC[8] = { 'R', 'A', 'D', 'H', 'S', 'T', '0', '1' };
+constexpr uint32_t HISTORY_CHUNK_VERSION = 1;
+constexpr int HISTORY_SECTORS = 64;
+
+struct HistoryConfig {
+    int chunk_ticks = 64;
+    size_t memory_chunks = 8;
+    size_t disk_chunks = 256;
+    std::string directory;
+};
+
+// Range interval plus bearing sector in degrees (the sector may wrap
+// through 0), over the inclusive tick interval [from_tick, to_tick].
+struct HistoryRegion {
+    double min_distance = 0.0;
+    double max_distance = 0.0;
+    double from_deg = 0.0;
+    double to_deg = 360.0;
+    uint64_t from_tick = 0;
+    uint64_t to_tick = 0;
+};
+
+struct HistoryRecord {
+    uint64_t tick;
+    int32_t id;
+    float distance;
+    float angle;
+};
+
+using HistorySink = std::function<void(const std::vector<HistoryRecord>& batch)>;
+
+// Summary kept in memory for every chunk, also the on-disk chunk header.
+struct HistoryChunkHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectors;
+    uint64_t first_tick;
+    uint64_t last_tick;
+    uint64_t count;
+    float min_distance;
+    float max_distance;
+    uint64_t sector_mask;
+};
+
+// Rows of a sealed chunk are ordered by bearing sector, then tick, so a
+// region query touches only the sectors it overlaps and a tick range within
+// each. track_rows orders the same rows by target slot, then tick.
+struct HistoryChunkView {
+    HistoryChunkHeader header;
+    const uint32_t* ticks;
+    const int32_t* ids;
+    const float* distances;
+    const float* angles;
+    const uint32_t* sector_offsets;
+    const uint32_t* track_rows;
+};
+
+struct HistoryChunk {
+    HistoryChunkHeader header{};
+    std::vector<uint32_t> ticks;
+    std::vector<int32_t> ids;
+    std::vector<float> distances;
+    std::vector<float> angles;
+    std::array<uint32_t, HISTORY_SECTORS + 1> sector_offsets{};
+    std::vector<uint32_t> track_rows;
+
+    HistoryChunkView view() const;
+};
+
+// Bounded tick history: an open chunk receiving the current ticks, a ring of
+// sealed chunks in memory and, if a directory is configured, an older ring
+// of chunk files. Sealing and disk writes run on a background thread.
+class HistoryStore {
+public:
+    explicit HistoryStore(const HistoryConfig& config);
+    ~HistoryStore();
+
+    void append(const TickSnapshot& snapshot);
+    void close();
+
+    size_t queryRegion(const HistoryRegion& region, const HistorySink& sink) const;
+    size_t queryTrack(int id, uint64_t from_tick, uint64_t to_tick, const HistorySink& sink) const;
+
+private:
+    struct DiskChunk {
+        HistoryChunkHeader header;
+        std::string path;
+    };
+
+    template<typename CollectSealed, typename AcceptRow>
+    size_t query(uint64_t from_tick, uint64_t to_tick, const HistorySink& sink,
+        CollectSealed&& collect, AcceptRow&& accept) const;
+
+    void workLoop();
+    void writeChunk(const HistoryChunk& chunk);
+
+    HistoryConfig _config;
+
+    mutable std::mutex _mutex;
+    std::shared_ptr<HistoryChunk> _open;
+    std::shared_ptr<HistoryChunk> _spare;
+    int _open_ticks = 0;
+    std::deque<std::shared_ptr<const HistoryChunk>> _unsealed;
+    std::deque<std::shared_ptr<const HistoryChunk>> _memory;
+    std::deque<DiskChunk> _disk;
+
+    std::condition_variable _cv;
+    bool _closing = false;
+    std::thread _worker;
+};
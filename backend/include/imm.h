@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <Eigen/Dense>
+
+struct ImmConfig {
+    double cv_process_noise = 0.1;        // white acceleration variance of the straight model, (m/tick^2)^2
+    double ct_process_noise = 30.0;       // same for the turning model, which also absorbs sharp manoeuvres
+    double turn_noise = 0.003;            // white turn-rate variance, (rad/tick)^2 per tick
+    double initial_turn_sigma = 0.1;      // rad/tick
+    double switch_probability = 0.1;      // per tick, of leaving the current model
+};
+
+// Interacting multiple model filters for many tracks: a constant-velocity
+// and a coordinated-turn model over the common state [x, y, vx, vy, w],
+// with w held at zero by the straight model. Both models keep one column
+// per state and unique covariance entry, like KalmanBank, so mixing, the
+// straight model and the measurement update are array expressions over
+// blocks of tracks. The turn model is nonlinear and is predicted per track
+// with fixed-size matrices gathered from the columns.
+class ImmBank {
+public:
+    static constexpr int MODELS = 2;
+    using Vector = Eigen::Matrix<double, 4, 1>;
+    using Matrix = Eigen::Matrix<double, 4, 4>;
+
+    explicit ImmBank(const ImmConfig& config = ImmConfig{});
+
+    uint32_t add(int id, const Vector& state, const Matrix& covariance);
+    // Swap-removes row index; returns the id now stored there, or -1.
+    int remove(uint32_t index);
+    void clear();
+
+    void predict(double dt);
+    void setMeasurement(uint32_t index, double x, double y, double rxx, double rxy, double ryy);
+    void update();
+
+    size_t size() const { return _ids.size(); }
+    int id(uint32_t index) const { return _ids[index]; }
+    // Combined estimate over both models.
+    Vector state(uint32_t index) const;
+    Matrix covariance(uint32_t index) const;
+    double turnRate(uint32_t index) const;
+    double modelProbability(uint32_t index, int model) const;
+
+private:
+    static constexpr int STATE = 5;
+    static constexpr int COVARIANCE = 15;
+    static constexpr int TURN = 4;
+
+    using FullVector = Eigen::Matrix<double, STATE, 1>;
+    using FullMatrix = Eigen::Matrix<double, STATE, STATE>;
+
+    static constexpr int sym(int i, int j) {
+        return i <= j ? i * STATE - i * (i - 1) / 2 + (j - i) : sym(j, i);
+    }
+
+    struct Model {
+        std::array<std::vector<double>, STATE> x;
+        std::array<std::vector<double>, COVARIANCE> p;
+        std::vector<double> probability;
+    };
+
+    void mix();
+    void predictStraight(double dt);
+    void predictTurn(double dt);
+    FullVector modelState(int model, uint32_t index) const;
+    FullMatrix modelCovariance(int model, uint32_t index) const;
+    void combine(uint32_t index, FullVector& x, FullMatrix& p) const;
+
+    ImmConfig _config;
+    std::vector<int> _ids;
+    std::array<Model, MODELS> _models;
+    std::vector<double> _zx;
+    std::vector<double> _zy;
+    std::vector<double> _rxx;
+    std::vector<double> _rxy;
+    std::vector<double> _ryy;
+    std::vector<double> _has_measurement;
+    bool _pending = false;
+};
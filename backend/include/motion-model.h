@@ -0,0 +1,292 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include "target.h"
+#include "slot-map.h"
+#include "philox.h"
+
+enum class MotionModel : uint8_t {
+    ConstantVelocity,
+    CoordinatedTurn,
+    ConstantAcceleration,
+    RandomWalk,
+};
+
+MotionModel parseMotionModel(const std::string& name);
+const char* motionModelName(MotionModel model);
+
+// Per-target parameters are drawn uniformly from these ranges at spawn.
+// Speeds are in metres per tick, turn rates in radians per tick.
+struct MotionConfig {
+    std::vector<MotionModel> models = { MotionModel::RandomWalk };
+    double min_speed = 20.0;
+    double max_speed = 20.0;
+    double max_turn_rate = EIGEN_PI / 60;
+    double max_acceleration = 0.5;
+    double random_walk_turn = EIGEN_PI / 4;
+};
+
+struct MotionParams {
+    MotionModel model = MotionModel::RandomWalk;
+    double speed = 20.0;
+    double turn_rate = 0.0;
+    double acceleration = 0.0;
+};
+
+// Read-only view of one group's columns; velocities in metres per tick.
+struct MotionColumns {
+    const int* ids = nullptr;
+    const double* distance = nullptr;
+    const double* angle = nullptr;
+    const double* vx = nullptr;
+    const double* vy = nullptr;
+    size_t count = 0;
+};
+
+// Cartesian view of one group's columns, as left by the last step.
+struct MotionPositions {
+    const int* ids = nullptr;
+    const double* x = nullptr;
+    const double* y = nullptr;
+    const double* heading = nullptr;
+    size_t count = 0;
+};
+
+// Cartesian state of all targets sharing one model, one column per field.
+// Derived groups implement advance() as a single loop over their columns;
+// dispatch to it is static, so there is no per-target virtual call. Targets
+// leaving the coverage are reflected back inward with reversed velocity,
+// unless reflection is off and they are left outside to be despawned.
+// Polar coordinates are derived on demand: per target while the columns are
+// stale, or for the whole group once someone asks for the columns.
+template<typename Derived>
+class MotionGroup {
+public:
+    uint32_t add(int id, double x, double y, double heading, const MotionParams& params) {
+        const uint32_t index = static_cast<uint32_t>(_ids.size());
+        _ids.push_back(id);
+        _x.push_back(x);
+        _y.push_back(y);
+        _vx.push_back(params.speed * std::cos(heading));
+        _vy.push_back(params.speed * std::sin(heading));
+        _heading.push_back(heading);
+        _distance.push_back(std::hypot(x, y));
+        _angle.push_back(wrapAngle(std::atan2(y, x)));
+        derived().addModel(heading, params);
+        return index;
+    }
+
+    // Swap-removes row index; returns the id now stored there, or -1.
+    int remove(uint32_t index) {
+        const size_t last = _ids.size() - 1;
+        swapOut(index, last, _ids, _x, _y, _vx, _vy, _heading, _distance, _angle);
+        derived().removeModel(index, last);
+        return index < _ids.size() ? _ids[index] : -1;
+    }
+
+    void clear() {
+        while (!_ids.empty()) {
+            remove(static_cast<uint32_t>(_ids.size() - 1));
+        }
+    }
+
+    void step(const CounterRng& rng, uint64_t tick) {
+        derived().advance(rng, tick);
+        if (_reflect) {
+            reflect();
+        }
+        _polar_stale = true;
+    }
+
+    void updatePolar() {
+        if (_polar_stale) {
+            toPolar();
+            _polar_stale = false;
+        }
+    }
+
+    void setReflect(bool reflect) { _reflect = reflect; }
+
+    size_t size() const { return _ids.size(); }
+    MotionColumns columns() {
+        updatePolar();
+        return { _ids.data(), _distance.data(), _angle.data(), _vx.data(), _vy.data(), _ids.size() };
+    }
+    MotionPositions positions() const {
+        return { _ids.data(), _x.data(), _y.data(), _heading.data(), _ids.size() };
+    }
+    double distance(uint32_t i) const {
+        return _polar_stale ? std::sqrt(_x[i] * _x[i] + _y[i] * _y[i]) : _distance[i];
+    }
+    double angle(uint32_t i) const {
+        return _polar_stale ? wrapAngle(std::atan2(_y[i], _x[i])) : _angle[i];
+    }
+    double heading(uint32_t i) const { return _heading[i]; }
+
+protected:
+    template<typename... Columns>
+    static void swapOut(size_t index, size_t last, Columns&... columns) {
+        ((columns[index] = columns[last], columns.pop_back()), ...);
+    }
+
+    static double wrapAngle(double a) {
+        constexpr double TWO_PI = 2 * EIGEN_PI;
+        a = a >= TWO_PI ? a - TWO_PI : a;
+        return a < 0.0 ? a + TWO_PI : a;
+    }
+
+    void reverse(size_t) {}
+
+    std::vector<int> _ids;
+    std::vector<double> _x;
+    std::vector<double> _y;
+    std::vector<double> _vx;
+    std::vector<double> _vy;
+    std::vector<double> _heading;
+    std::vector<double> _distance;
+    std::vector<double> _angle;
+
+private:
+    Derived& derived() { return static_cast<Derived&>(*this); }
+
+    bool _reflect = true;
+    bool _polar_stale = false;
+
+    void reflect() {
+        constexpr double MAX_SQ = MAX_DISTANCE * MAX_DISTANCE;
+        const size_t n = _ids.size();
+        for (size_t i = 0; i < n; ++i) {
+            const double r2 = _x[i] * _x[i] + _y[i] * _y[i];
+            if (r2 <= MAX_SQ) {
+                continue;
+            }
+            const double r = std::sqrt(r2);
+            const double k = (2 * MAX_DISTANCE - r) / r;
+            _x[i] *= k;
+            _y[i] *= k;
+            _vx[i] = -_vx[i];
+            _vy[i] = -_vy[i];
+            _heading[i] = wrapAngle(_heading[i] + EIGEN_PI);
+            derived().reverse(i);
+        }
+    }
+
+    void toPolar() {
+        const size_t n = _ids.size();
+        const double* x = _x.data();
+        const double* y = _y.data();
+        double* distance = _distance.data();
+        double* angle = _angle.data();
+        for (size_t i = 0; i < n; ++i) {
+            distance[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const double a = std::atan2(y[i], x[i]);
+            angle[i] = a < 0.0 ? a + 2 * EIGEN_PI : a;
+        }
+    }
+};
+
+class ConstantVelocityGroup : public MotionGroup<ConstantVelocityGroup> {
+public:
+    void addModel(double, const MotionParams&) {}
+    void removeModel(size_t, size_t) {}
+    void advance(const CounterRng& rng, uint64_t tick);
+};
+
+// Velocity is rotated by a fixed per-target angle each tick; its cosine and
+// sine are computed once at spawn.
+class CoordinatedTurnGroup : public MotionGroup<CoordinatedTurnGroup> {
+public:
+    void addModel(double heading, const MotionParams& params);
+    void removeModel(size_t index, size_t last);
+    void advance(const CounterRng& rng, uint64_t tick);
+
+private:
+    std::vector<double> _turn;
+    std::vector<double> _turn_cos;
+    std::vector<double> _turn_sin;
+};
+
+// Speed changes along a fixed heading and is clamped to the configured range.
+class ConstantAccelerationGroup : public MotionGroup<ConstantAccelerationGroup> {
+public:
+    friend class MotionGroup<ConstantAccelerationGroup>;
+
+    void setSpeedRange(double min_speed, double max_speed);
+    void addModel(double heading, const MotionParams& params);
+    void removeModel(size_t index, size_t last);
+    void advance(const CounterRng& rng, uint64_t tick);
+
+private:
+    void reverse(size_t i);
+
+    double _min_speed = 0.0;
+    double _max_speed = 0.0;
+    std::vector<double> _speed;
+    std::vector<double> _acceleration;
+    std::vector<double> _ux;
+    std::vector<double> _uy;
+};
+
+// The original model: a random heading change of up to +-max_turn each tick.
+// The only group that needs trig per step.
+class RandomWalkGroup : public MotionGroup<RandomWalkGroup> {
+public:
+    void setMaxTurn(double max_turn);
+    void addModel(double heading, const MotionParams& params);
+    void removeModel(size_t index, size_t last);
+    void advance(const CounterRng& rng, uint64_t tick);
+
+private:
+    double _max_turn = EIGEN_PI / 4;
+    std::vector<double> _speed;
+};
+
+class MotionSystem {
+public:
+    void configure(const MotionConfig& config);
+    MotionParams draw(const CounterRng& rng, uint32_t seq, uint64_t tick) const;
+
+    void add(const Target& target, const MotionParams& params);
+    void remove(int id);
+    void clear();
+
+    void step(const CounterRng& rng, uint64_t tick);
+    // Whether targets bounce off the coverage edge or are let through it.
+    void setReflect(bool reflect);
+    void apply(Target& target) const;
+    // The bearing apply() would move target to.
+    double nextAngle(const Target& target) const;
+    // Derives polar coordinates for every target at once, for when all of
+    // them are about to be read.
+    void updatePolar();
+
+    size_t size() const;
+    // Every target, group by group, as left by the last step.
+    std::array<MotionColumns, 4> columns();
+    std::array<MotionPositions, 4> positions() const;
+
+private:
+    struct Location {
+        MotionModel model = MotionModel::RandomWalk;
+        uint32_t index = 0;
+    };
+
+    template<typename Visitor>
+    auto visit(MotionModel model, Visitor&& visitor);
+
+    template<typename Visitor>
+    auto visit(MotionModel model, Visitor&& visitor) const;
+
+    MotionConfig _config;
+    ConstantVelocityGroup _cv;
+    CoordinatedTurnGroup _ct;
+    ConstantAccelerationGroup _ca;
+    RandomWalkGroup _rw;
+    HandleTable<Location> _locations;
+};
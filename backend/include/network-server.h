@@ -4,6 +4,11 @@
 #include <vector>
 #include <asio.hpp>
 #include "sim-engine.h"
+#include "protocol.h"
+#include "history-store.h"
+#include "sensor.h"
+#include "video.h"
+#include "alarms.h"
 
 class NetworkServer {
 public:
@@ -18,7 +23,27 @@ private:
     void startAccept();
     void startBroadcast();
     void readCommands(asio::ip::tcp::socket& socket);
-    void handleCommand(const std::string& command);
+    void handleCommand(asio::ip::tcp::socket& socket, const std::string& command);
+    void handleHistoryQuery(asio::ip::tcp::socket& socket, const std::string& query);
+    void sendToClients(const std::vector<uint8_t>& buffer);
+    void sendTo(asio::ip::tcp::socket& socket, const std::vector<uint8_t>& buffer);
+
+    void broadcastSweep(std::vector<uint8_t>& buffer, const std::vector<SweepSector>& sectors);
+
+    static void appendFrame(std::vector<uint8_t>& buffer, const std::vector<Target>& targets);
+    static void appendSector(std::vector<uint8_t>& buffer, const SweepSector& sector);
+    static void appendTarget(std::vector<uint8_t>& buffer, const Target& target);
+    static void appendEvents(std::vector<uint8_t>& buffer, const std::vector<TargetEvent>& events);
+    static void appendAlarms(std::vector<uint8_t>& buffer, const std::vector<AlarmEvent>& alarms,
+        const std::vector<std::string>& names);
+    static void appendPlots(std::vector<uint8_t>& buffer, const PlotBatch& plots);
+    static void appendTracks(std::vector<uint8_t>& buffer, const std::vector<TrackReport>& tracks);
+    static void appendTrackerStats(std::vector<uint8_t>& buffer, const TrackerStats& stats);
+    static void appendVideo(std::vector<uint8_t>& buffer, const VideoScan& video, int first, int count);
+    static void appendHistoryResult(std::vector<uint8_t>& buffer, uint32_t query_id, bool final,
+        const std::vector<HistoryRecord>& records);
+    static size_t beginMessage(std::vector<uint8_t>& buffer, MessageType type);
+    static void endMessage(std::vector<uint8_t>& buffer, size_t header_pos);
 
     template<typename T>
     static void appendToBuffer(std::vector<uint8_t>& buffer, const T& value) {
@@ -32,6 +57,7 @@ private:
     std::unique_ptr<asio::steady_timer> _broadcast_timer;
     asio::ip::tcp::acceptor _acceptor;
     std::mutex _clients_mutex;
+    uint32_t _next_query_id = 1;
 
     std::atomic<bool> _stopped{ false };
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <Eigen/Dense>
+
+// Power of two, so a bearing maps to its bin with a mask: ~0.09 degrees.
+constexpr int OCCLUSION_AZIMUTHS = 4096;
+
+// Polygon in metres around the radar, x = d cos(angle), y = d sin(angle).
+struct Obstacle {
+    std::vector<Eigen::Vector2d> vertices;
+};
+
+// One polygon per line as "x,y x,y x,y ..."; '#' starts a comment.
+std::vector<Obstacle> loadObstacles(const std::string& path);
+
+// Line of sight from the radar, rasterised once from the obstacle polygons
+// into the nearest blocked range per bearing bin. Whatever lies at or
+// beyond that range, behind the obstacle or inside it, is hidden, so the
+// per-target test is one lookup instead of intersecting every edge.
+class OcclusionMap {
+public:
+    explicit OcclusionMap(const std::vector<Obstacle>& obstacles);
+
+    // Infinite where nothing blocks the bearing.
+    float blockedRange(double angle) const {
+        const auto bin = static_cast<int64_t>(std::floor(angle * _bins_per_radian));
+        return _blocked[bin & (OCCLUSION_AZIMUTHS - 1)];
+    }
+    bool visible(double distance, double angle) const { return distance < blockedRange(angle); }
+
+    size_t obstacleCount() const { return _obstacles; }
+
+private:
+    void rasteriseEdge(const Eigen::Vector2d& p, const Eigen::Vector2d& q);
+    void block(int64_t bin, double range);
+
+    double _bins_per_radian;
+    size_t _obstacles;
+    std::vector<float> _blocked;
+};
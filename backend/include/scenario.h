@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "mapped-file.h"
+
+constexpr char SCENARIO_MAGIC[8] = { 'R', 'A', 'D', 'S', 'C', 'N', '0', '1' };
+constexpr uint32_t SCENARIO_VERSION = 1;
+
+// On-disk layout: header, then one 64-byte aligned column per field.
+// Colour is stored as three consecutive float columns (r[n], g[n], b[n]).
+struct ScenarioHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t target_count;
+    uint64_t seed;
+    uint64_t start_tick;
+    uint64_t distance_offset;
+    uint64_t angle_offset;
+    uint64_t direction_offset;
+    uint64_t color_offset;
+};
+
+struct ScenarioColumns {
+    std::vector<double> distance;
+    std::vector<double> angle;
+    std::vector<double> direction;
+    std::vector<float> red;
+    std::vector<float> green;
+    std::vector<float> blue;
+    uint64_t seed = 0;
+    uint64_t start_tick = 0;
+};
+
+enum class ScenarioDistribution {
+    Uniform,
+    Gaussian,
+    Clusters,
+    Ring,
+};
+
+struct ScenarioSpec {
+    size_t count = 0;
+    ScenarioDistribution distribution = ScenarioDistribution::Uniform;
+    int clusters = 8;
+    uint64_t seed = 0;
+};
+
+ScenarioDistribution parseScenarioDistribution(const std::string& name);
+ScenarioColumns generateScenario(const ScenarioSpec& spec);
+
+class Scenario {
+public:
+    explicit Scenario(const std::string& path);
+
+    size_t count() const;
+    uint64_t seed() const;
+    uint64_t startTick() const;
+
+    const double* distances() const;
+    const double* angles() const;
+    const double* directions() const;
+    const float* reds() const;
+    const float* greens() const;
+    const float* blues() const;
+
+    static void write(const std::string& path, const ScenarioColumns& columns);
+
+private:
+    template<typename T>
+    const T* column(uint64_t offset) const {
+        return reinterpret_cast<const T*>(_file.data() + offset);
+    }
+
+    MappedFile _file;
+    ScenarioHeader _header{};
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include "target.h"
+#include "philox.h"
+#include "worker-pool.h"
+#include "occlusion.h"
+
+// Clutter is drawn per bearing sector, so plots come out grouped by sector
+// and the result does not depend on the number of threads.
+constexpr int SENSOR_SECTORS = 256;
+
+struct SensorConfig {
+    double range_sigma = 5.0;             // metres
+    double bearing_sigma = 0.005;         // radians
+    double detection_probability = 0.9;
+    double clutter_rate = 0.0;            // mean false plots per scan over the whole coverage
+};
+
+// Plots of one scan in columns: detections first, then clutter by sector.
+struct PlotBatch {
+    uint64_t tick = 0;
+    size_t detections = 0;
+    std::vector<float> distances;
+    std::vector<float> angles;
+    std::vector<int32_t> target_ids;      // -1 for clutter
+
+    size_t size() const { return distances.size(); }
+    void resize(size_t n);
+};
+
+// Cartesian covariance [rxx rxy; rxy ryy] of a plot with independent range
+// and bearing errors, linearised at the plot position.
+inline void plotCovariance(double distance, double angle, double range_sigma, double bearing_sigma,
+    double& rxx, double& rxy, double& ryy) {
+    const double c = std::cos(angle);
+    const double s = std::sin(angle);
+    const double vr = range_sigma * range_sigma;
+    const double va = distance * distance * bearing_sigma * bearing_sigma;
+    rxx = c * c * vr + s * s * va;
+    rxy = c * s * (vr - va);
+    ryy = s * s * vr + c * c * va;
+}
+
+// Turns true target positions into what a radar would report: range and
+// bearing noise, missed detections and Poisson clutter uniform over the
+// coverage area. Draws are counter-based, so a scan is reproducible from
+// (seed, tick) regardless of threading. Targets hidden by the occlusion
+// map are never detected.
+class Sensor {
+public:
+    Sensor(const SensorConfig& config, WorkerPool& workers);
+
+    // Null for a clear line of sight everywhere.
+    void setOcclusion(const OcclusionMap* occlusion);
+
+    void scan(const CounterRng& rng, uint64_t tick, const Target* targets, size_t count, PlotBatch& out);
+
+    const SensorConfig& config() const;
+
+private:
+    size_t drawClutterCounts(const CounterRng& rng, uint64_t tick);
+
+    SensorConfig _config;
+    WorkerPool& _workers;
+    const OcclusionMap* _occlusion = nullptr;
+    std::vector<float> _detect_distance;
+    std::vector<float> _detect_angle;
+    std::vector<uint8_t> _detected;
+    std::vector<size_t> _sector_offsets;
+};
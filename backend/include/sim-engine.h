@@ -1,16 +1,68 @@
 #pragma once
 
 #include <vector>
+#include <string>
 #include <mutex>
 #include <atomic>
 #include <chrono>
 #include <memory>
 #include <condition_variable>
 #include "target.h"
+#include "slot-map.h"
+#include "protocol.h"
+#include "philox.h"
+#include "motion-model.h"
+
+class Scenario;
+class TickLog;
+class TickLogWriter;
+class TickReplayer;
+struct TickColor;
+struct TickSnapshot;
+class HistoryStore;
+struct HistoryConfig;
+class Tracker;
+struct TrackerConfig;
+class Sensor;
+struct SensorConfig;
+struct PlotBatch;
+class VideoGenerator;
+struct VideoConfig;
+struct VideoScan;
+class CfarDetector;
+struct CfarConfig;
+class ClutterMap;
+class OcclusionMap;
+class AlarmEngine;
+struct AlarmConfig;
+struct AlarmEvent;
+struct Obstacle;
+struct ClutterMapConfig;
+class WorkerPool;
+class Associator;
+struct AssociationConfig;
+
+constexpr std::chrono::milliseconds TICK_INTERVAL(500);
+
+// One bearing sector of a sweep, with the targets that took their new state
+// as the beam passed over it. Sector i covers [i, i + 1) * 2 pi / sectors.
+struct SweepSector {
+    uint64_t tick = 0;
+    int sector = 0;
+    int sectors = 0;
+    std::vector<Target> targets;
+};
+
+struct LifecycleConfig {
+    int spawn_interval_ticks = 20;
+    size_t max_targets = 10000;
+    int max_age_ticks = 0;
+    bool despawn_outside_coverage = true;
+};
 
 class SimulationEngine {
 public:
-    SimulationEngine();
+    explicit SimulationEngine(const LifecycleConfig& config = LifecycleConfig{}, uint64_t seed = 0);
     ~SimulationEngine();
 
     void start();
@@ -18,16 +70,106 @@ public:
     void togglePause();
 
     void update();
+    size_t spawn(size_t count);
+    size_t loadScenario(const Scenario& scenario);
+    void record(const std::string& path);
+    void replay(std::unique_ptr<TickLog> log, double speed = 1.0, uint64_t from_tick = 0);
+    void setMotion(const MotionConfig& config);
+    void enableHistory(const HistoryConfig& config);
+    const HistoryStore* history() const;
+    void enableTracking(const TrackerConfig& config, const AssociationConfig& association);
+    void enableSensor(const SensorConfig& config);
+    void enableVideo(const VideoConfig& config);
+    // Hides targets behind the obstacles from the sensor model and video.
+    void enableOcclusion(const std::vector<Obstacle>& obstacles);
+    // Turns video into the plots the tracker and clients see; needs video
+    // and replaces the sensor model.
+    void enableDetector(const CfarConfig& config);
+    // Adds a clutter map to detection, loaded from its snapshot file if there
+    // is one and written back every snapshot_interval scans and on stop.
+    void enableClutterMap(const ClutterMapConfig& config);
+    // Evaluates the alarm rules against the targets every tick.
+    void enableAlarms(const AlarmConfig& config);
+    // Spreads each tick over a revolution of the beam in this many sectors;
+    // update() then advances one sector.
+    void enableSweep(int sectors);
+    void setWorkerThreads(unsigned threads);
 
     std::vector<Target> getTargets() const;
+    std::vector<TargetEvent> drainEvents();
+    std::vector<SweepSector> drainSweep();
+    std::vector<AlarmEvent> drainAlarms();
+    // Indexed by AlarmEvent::rule; empty without alarms.
+    std::vector<std::string> alarmRuleNames() const;
+    std::vector<TrackReport> getTracks() const;
+    TrackerStats getTrackerStats() const;
+    bool isTracking() const;
+    PlotBatch getPlots() const;
+    bool isSensing() const;
+    VideoScan getVideo() const;
+    bool hasVideo() const;
+    size_t targetCount() const;
+    uint64_t seed() const;
     bool isRunning() const;
     bool isPaused() const;
+    bool isReplaying() const;
+    bool isSweeping() const;
+    std::chrono::microseconds tickInterval() const;
+    // Time between updates: a tick, or one sector of a sweep.
+    std::chrono::microseconds publishInterval() const;
 
 private:
-    void addTarget();
+    bool addTarget();
+    void removeTarget(int id);
+    bool isExpired(const Target& t) const;
+    void despawnExpired();
+    void replayStep();
+    void sweepSector();
+    void sortBySector();
+    void finishTick(TickSnapshot* snapshot, size_t recorded);
+    void trackTargets();
+    void saveClutterMap();
+    void evaluateAlarms();
+    WorkerPool& workers();
+    TickSnapshot* beginSnapshot();
+    void recordTick();
+    void settleRecording();
     void runLoop();
 
-    std::vector<Target> _targets;
+    LifecycleConfig _config;
+    CounterRng _rng;
+    uint64_t _spawned_total = 0;
+    SlotMap<Target> _targets;
+    MotionSystem _motion;
+    std::vector<TargetEvent> _events;
+    uint64_t _tick = 0;
+    std::unique_ptr<TickLogWriter> _recorder;
+    std::vector<int> _unrecorded;               // spawned, colour not yet handed to the recorder
+    std::vector<TickColor> _spawned_colors;
+    std::unique_ptr<TickReplayer> _replayer;
+    std::unique_ptr<HistoryStore> _history;
+    std::unique_ptr<TickSnapshot> _history_snapshot;
+    std::unique_ptr<Tracker> _tracker;
+    std::unique_ptr<WorkerPool> _workers;
+    unsigned _worker_threads = 0;
+    std::unique_ptr<OcclusionMap> _occlusion;
+    std::unique_ptr<Sensor> _sensor;
+    std::unique_ptr<PlotBatch> _plots;
+    std::unique_ptr<VideoGenerator> _video;
+    std::unique_ptr<VideoScan> _video_scan;
+    std::unique_ptr<CfarDetector> _detector;
+    std::unique_ptr<ClutterMap> _clutter_map;
+    std::unique_ptr<Associator> _associator;
+    std::unique_ptr<AlarmEngine> _alarms;
+    std::vector<AlarmEvent> _alarm_events;
+    float _track_ms = 0.0f;
+    int _sweep_sectors = 0;
+    int _sweep_sector = 0;                    // next to be swept
+    std::vector<uint32_t> _sector_offsets;    // into _sector_ids, by sector
+    std::vector<int> _sector_ids;
+    std::vector<uint16_t> _target_sector;
+    std::vector<SweepSector> _swept;          // not yet drained, at most one revolution
+    double _replay_speed = 1.0;
     std::unique_ptr<std::thread> _sim_thread;
     mutable std::mutex _data_mutex;
     std::atomic<bool> _running{ false };
@@ -35,4 +177,4 @@ private:
     std::chrono::steady_clock::time_point _last_update_time;
     std::condition_variable _cv;
     std::mutex _cv_mutex;
-};
\ No newline at end of file
+};
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <condition_variable>
+#include <cstdint>
+#include "target.h"
+#include "slot-map.h"
+#include "protocol.h"
+#include "mapped-file.h"
+#include "track-codec.h"
+#include "motion-model.h"
+
+constexpr char TICK_LOG_MAGIC[8] = { 'R', 'A', 'D', 'L', 'O', 'G', '0', '1' };
+constexpr uint32_t TICK_LOG_VERSION = 2;
+constexpr uint32_t TICK_BLOCK_MAGIC = 0x4B434954;
+constexpr uint32_t TICK_DELTA_MAGIC = 0x41544C44;
+constexpr uint32_t TICK_INDEX_MAGIC = 0x58444E49;
+constexpr uint64_t TICK_KEYFRAME_INTERVAL = 64;
+constexpr double TICK_DISTANCE_QUANTUM = 1e-3;
+constexpr double TICK_ANGLE_QUANTUM = 1e-6;
+
+// On-disk layout: header, one block per tick, tick index, footer.
+// A raw block (keyframe) is a TickBlockHeader followed by 8-byte aligned
+// columns: id[n], distance[n], angle[n], direction[n], red[n], green[n],
+// blue[n]. Every TICK_KEYFRAME_INTERVAL-th written tick is raw; the ticks in
+// between are delta blocks (see TickDeltaCodec). The index is only written
+// on close; a log cut short by a crash is still readable by walking the
+// blocks. Version 1 logs contain raw blocks only.
+struct TickLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t seed;
+    uint64_t tick_interval_us;
+};
+
+struct TickBlockHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t tick;
+    uint64_t size;
+};
+
+struct TickIndexEntry {
+    uint64_t tick;
+    uint64_t offset;
+};
+
+struct TickLogFooter {
+    uint64_t index_offset;
+    uint64_t tick_count;
+    uint32_t magic;
+    uint32_t reserved;
+};
+
+struct TickView {
+    uint64_t tick;
+    size_t count;
+    const int32_t* ids;
+    const double* distances;
+    const double* angles;
+    const double* directions;
+    const float* reds;
+    const float* greens;
+    const float* blues;
+};
+
+// Columns are sized up front so set() is a plain indexed store; the caller
+// fills rows [0, count).
+struct TickSnapshot {
+    uint64_t tick = 0;
+    size_t count = 0;
+    std::vector<int32_t> ids;
+    std::vector<double> distances;
+    std::vector<double> angles;
+    std::vector<double> directions;
+    std::vector<float> reds;
+    std::vector<float> greens;
+    std::vector<float> blues;
+
+    void resize(size_t n);
+    TickView view() const;
+
+    void set(size_t i, const Target& t) {
+        ids[i] = t.id;
+        distances[i] = t.distance;
+        angles[i] = t.angle;
+        directions[i] = t.direction;
+        reds[i] = static_cast<float>(t.color.x());
+        greens[i] = static_cast<float>(t.color.y());
+        blues[i] = static_cast<float>(t.color.z());
+    }
+};
+
+// Delta block payload: per group of PACK_GROUP_SIZE rows, one bit-packed
+// residual column each for ids (against the id in the same row of the
+// previous tick), distance and angle (fixed-point,
+// against the target's previous position extrapolated by its last step),
+// direction (fixed-point delta) and colour (XOR of the float bits). Targets
+// are matched to the previous tick by id; new ones are coded against zero.
+// Writer and reader run the same state machine from the last keyframe.
+class TickDeltaCodec {
+public:
+    void reset(const TickView& keyframe);
+    void encode(const TickSnapshot& snapshot, std::vector<uint8_t>& out);
+    void decode(const uint8_t* in, uint64_t tick, size_t count);
+
+    TickView view() const;
+
+private:
+    struct Row {
+        int32_t id;
+        int64_t distance;
+        int64_t angle;
+        int64_t direction;
+        int64_t distance_step;
+        int64_t angle_step;
+        uint32_t color[3];
+    };
+
+    void advance(size_t count);
+    const Row* previousRow(int32_t id) const;
+
+    uint64_t _tick = 0;
+    std::vector<Row> _rows;
+    std::vector<Row> _previous;
+    HandleTable<int> _row_index;
+    HandleTable<int> _previous_index;
+
+    std::vector<int32_t> _ids;
+    std::vector<double> _distances;
+    std::vector<double> _angles;
+    std::vector<double> _directions;
+    std::vector<float> _reds;
+    std::vector<float> _greens;
+    std::vector<float> _blues;
+};
+
+struct TickColor {
+    int32_t id;
+    float rgb[3];
+};
+
+// One tick as copied by the writer: the cartesian motion columns and the
+// colours of targets not handed over before. The polar rows are derived
+// from them on the writer thread too.
+struct TickColumns {
+    uint64_t tick = 0;
+    std::vector<int32_t> ids;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<double> headings;
+    std::vector<TickColor> spawned;
+
+    void clear();
+    void append(const MotionPositions& part);
+};
+
+// The simulation offers each tick's motion columns in place (offerTick) and
+// the writer thread copies them while the simulation is idle; settle() must
+// be called before the columns change again, and copies them on the
+// caller's thread if the writer has not got to them yet. Blocks are encoded
+// and written out in batches. If the disk falls behind by more than
+// max_pending ticks, further ticks are dropped and counted instead of
+// stalling the simulation. A failed write stops the recording; later ticks
+// are counted as dropped.
+class TickLogWriter {
+public:
+    TickLogWriter(const std::string& path, uint64_t seed, std::chrono::microseconds tick_interval, size_t max_pending = 64);
+    ~TickLogWriter();
+
+    // Returns false if the tick was dropped.
+    bool offerTick(uint64_t tick, const std::array<MotionPositions, 4>& parts, const std::vector<TickColor>& spawned);
+    void settle();
+    void close();
+
+    uint64_t writtenTicks() const;
+    uint64_t droppedTicks() const;
+
+private:
+    void writeLoop();
+    void takeOffer(std::unique_lock<std::mutex>& lock);
+    const TickSnapshot& rows(const TickColumns& columns);
+    void writeSnapshot(const TickSnapshot& snapshot);
+    void writeColumn(const void* data, size_t bytes);
+    void finishBlock(const TickBlockHeader& header);
+
+    std::ofstream _out;
+    uint64_t _offset = 0;
+    std::vector<TickIndexEntry> _index;
+    TickDeltaCodec _codec;
+    std::vector<uint8_t> _delta;
+    TickSnapshot _rows;
+    HandleTable<std::array<float, 3>> _colors;
+
+    size_t _max_pending;
+    std::unique_ptr<TickColumns> _offered;
+    std::array<MotionPositions, 4> _offered_parts;
+    bool _copying = false;
+    std::deque<std::unique_ptr<TickColumns>> _pending;
+    std::vector<std::unique_ptr<TickColumns>> _free;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::condition_variable _copied;
+    bool _closing = false;
+    std::thread _thread;
+
+    std::atomic<uint64_t> _written{ 0 };
+    std::atomic<uint64_t> _dropped{ 0 };
+    std::atomic<bool> _failed{ false };
+};
+
+// tick() decodes delta blocks sequentially from the preceding keyframe;
+// views of delta blocks stay valid until the next call.
+class TickLog {
+public:
+    explicit TickLog(const std::string& path);
+
+    size_t tickCount() const;
+    uint64_t seed() const;
+    std::chrono::microseconds tickInterval() const;
+
+    TickView tick(size_t i);
+    size_t findTick(uint64_t tick) const;
+
+private:
+    TickBlockHeader blockHeader(size_t i) const;
+    TickView rawView(size_t i) const;
+
+    MappedFile _file;
+    TickLogHeader _header{};
+    std::vector<TickIndexEntry> _index;
+    TickDeltaCodec _codec;
+    size_t _decoded = SIZE_MAX;
+};
+
+// Turns consecutive log blocks back into target frames. Trails are rebuilt
+// from the recorded positions, spawn/despawn events from the id sets.
+class TickReplayer {
+public:
+    TickReplayer(std::unique_ptr<TickLog> log, uint64_t from_tick = 0);
+
+    bool step(std::vector<TargetEvent>& events);
+
+    const std::vector<Target>& targets() const;
+    const TickLog& log() const;
+    uint64_t currentTick() const;
+
+private:
+    std::unique_ptr<TickLog> _log;
+    size_t _next = 0;
+    uint64_t _current_tick = 0;
+
+    std::vector<Target> _frame;
+    std::vector<Target> _previous;
+    HandleTable<int> _frame_index;
+    HandleTable<int> _previous_index;
+};
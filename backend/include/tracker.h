@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <variant>
+#include <cstdint>
+#include <Eigen/Dense>
+#include "slot-map.h"
+#include "protocol.h"
+#include "target.h"
+#include "spatial-grid.h"
+#include "association.h"
+#include "imm.h"
+
+// Tracks per block in the batched kernels; all columns of a block stay in L1.
+constexpr size_t KALMAN_BLOCK = 256;
+
+enum class TrackModel : uint8_t {
+    ConstantVelocity,
+    Interacting,
+};
+
+TrackModel parseTrackModel(const std::string& name);
+
+struct TrackerConfig {
+    TrackModel model = TrackModel::ConstantVelocity;
+    double process_noise = 4.0;       // white acceleration variance, (m/tick^2)^2
+    double measurement_sigma = 5.0;   // per axis, metres
+    double initial_speed_sigma = 30.0;
+    ImmConfig imm;
+
+    // Life cycle of tracks started from plots. Besides its hits, a tentative
+    // track carries a log likelihood ratio of target against clutter at the
+    // scan's leftover plot density, which confirmation also needs and which
+    // drops the track once it falls below delete_score.
+    int confirm_hits = 3;             // M hits ...
+    int confirm_window = 4;           // ... within the last N scans confirm a tentative track
+    double confirm_score = 1.5;       // ~ln 4.5
+    double delete_score = -2.3;       // ~ln 0.1
+    double max_initiation_speed = 30.0;   // m/tick, reach of a plot from the one that starts its track
+    double detection_probability = 0.9;
+    double quality_decay = 0.5;       // per scan, quality moves this much less towards 1 on a hit, 0 on a miss;
+                                      // a confirmed track then survives three straight misses
+    double delete_quality = 0.1;      // confirmed tracks below this are deleted
+};
+
+struct TrackingError {
+    size_t matched = 0;
+    double position_rmse = 0.0;       // metres
+    double velocity_rmse = 0.0;       // metres per tick
+};
+
+// Compares tracks with the targets carrying the same id; velocity is taken
+// from each target's last displacement, so targets that have not moved yet
+// only count towards position.
+TrackingError trackingError(const std::vector<TrackReport>& tracks, const std::vector<Target>& truth);
+
+// Constant-velocity Kalman filters for many tracks, state [x, y, vx, vy].
+// Tracks are stored LANES at a time: a block holds the state, the 10 unique
+// covariance entries and the staged measurement of LANES consecutive tracks,
+// field by field. A pass over the bank is then one sequential stream, and
+// each field of a block is a fixed-size Eigen array of LANES values,
+// instead of a 4x4 product per track or one stream per field.
+class KalmanBank {
+public:
+    using Vector = Eigen::Matrix<double, 4, 1>;
+    using Matrix = Eigen::Matrix<double, 4, 4>;
+
+    explicit KalmanBank(const TrackerConfig& config = TrackerConfig{});
+
+    uint32_t add(int id, const Vector& state, const Matrix& covariance);
+    // Swap-removes row index; returns the id now stored there, or -1.
+    int remove(uint32_t index);
+    void clear();
+
+    void predict(double dt);
+    // Stages a position measurement with covariance [rxx rxy; rxy ryy] for
+    // the next update(); tracks without one are left unchanged.
+    void setMeasurement(uint32_t index, double x, double y, double rxx, double rxy, double ryy);
+    void update();
+
+    size_t size() const { return _ids.size(); }
+    int id(uint32_t index) const { return _ids[index]; }
+    Vector state(uint32_t index) const;
+    Matrix covariance(uint32_t index) const;
+
+    static Matrix transition(double dt);
+    static Matrix processNoise(double dt, double q);
+
+private:
+    static constexpr int STATE = 4;
+    static constexpr int COVARIANCE = 10;
+    static constexpr size_t LANES = 4;
+    using Lanes = Eigen::Array<double, LANES, 1>;
+
+    enum Field : int {
+        FIELD_X = 0,
+        FIELD_P = FIELD_X + STATE,
+        FIELD_ZX = FIELD_P + COVARIANCE,
+        FIELD_ZY,
+        FIELD_RXX,
+        FIELD_RXY,
+        FIELD_RYY,
+        FIELD_HAS_MEASUREMENT,
+        FIELDS
+    };
+
+    static constexpr int sym(int i, int j) {
+        return i <= j ? i * STATE - i * (i - 1) / 2 + (j - i) : sym(j, i);
+    }
+    static constexpr size_t slot(int field, size_t lane) {
+        return static_cast<size_t>(field) * LANES + lane;
+    }
+
+    double& at(int field, size_t index) {
+        return _blocks[index / LANES * FIELDS * LANES + slot(field, index % LANES)];
+    }
+    double at(int field, size_t index) const {
+        return _blocks[index / LANES * FIELDS * LANES + slot(field, index % LANES)];
+    }
+    void clearMeasurement(size_t index);
+
+    TrackerConfig _config;
+    std::vector<int> _ids;
+    std::vector<double> _blocks;
+    bool _pending = false;
+};
+
+// Confirmed tracks in one bank, either plain constant velocity or IMM,
+// picked once so every batch call dispatches statically inside a single
+// visit. Tracks are either keyed by target id and fed directly, or started
+// from plots by scan(): an unassigned plot that lies within reach of an
+// unassigned plot of the previous scan opens a tentative track with the
+// velocity between them, kept in a separate constant-velocity bank that the
+// confirmed tracks never iterate, and promoted by M hits in N scans once
+// its score is high enough. Plots that pair with nothing are held for the
+// next scan only.
+// Confirmed tracks coast through misses and are deleted once their quality
+// has decayed.
+class Tracker {
+public:
+    explicit Tracker(const TrackerConfig& config = TrackerConfig{});
+
+    void predict(double dt = 1.0);
+    void observe(int id, double x, double y);
+    void observe(int id, double x, double y, double rxx, double rxy, double ryy);
+    void update();
+    void drop(int id);
+    void clear();
+
+    // A whole scan: predicts, gives the plots to confirmed tracks first and
+    // what is left to tentative ones, updates, then starts, confirms and
+    // deletes tracks.
+    void scan(const PlotBatch& plots, double range_sigma, double bearing_sigma, Associator& associator, double dt = 1.0);
+
+    // Predicted positions of confirmed tracks with the innovation covariance
+    // of a plot taken there, one per track in bank order.
+    void gates(double range_sigma, double bearing_sigma, std::vector<TrackGate>& out) const;
+
+    void report(std::vector<TrackReport>& out) const;
+    size_t size() const;
+    size_t tentativeCount() const;
+    size_t coastingCount() const;
+
+private:
+    KalmanBank::Matrix initialCovariance(double rxx, double rxy, double ryy) const;
+    uint32_t addConfirmed(int id, const KalmanBank::Vector& state, const KalmanBank::Matrix& covariance);
+    void removeConfirmed(uint32_t index);
+    void removeTentative(uint32_t index);
+    void observeAt(uint32_t index, double x, double y, double rxx, double rxy, double ryy);
+    void updateConfirmed(const PlotBatch& plots, double range_sigma, double bearing_sigma);
+    void updateTentative(double range_sigma, double bearing_sigma, double density);
+    void promoteAndDelete();
+    void startTracks(double range_sigma, double bearing_sigma, double density, double dt);
+    int nextTrackId();
+
+    TrackerConfig _config;
+    std::variant<KalmanBank, ImmBank> _bank;
+    HandleTable<uint32_t> _index;
+    // Per confirmed track, in bank order.
+    std::vector<double> _quality;
+    std::vector<uint16_t> _misses;
+
+    // Tentative tracks, hits as a bit history of the last N scans.
+    KalmanBank _tentative;
+    std::vector<uint32_t> _tentative_hits;
+    std::vector<uint8_t> _tentative_age;
+    std::vector<double> _tentative_score;
+
+    // Plots of the previous scan that no track took and that started
+    // nothing, as positions and covariances [rxx rxy ryy]; those of this
+    // scan collect alongside and replace them.
+    std::vector<double> _initiator_xs;
+    std::vector<double> _initiator_ys;
+    std::vector<std::array<double, 3>> _initiator_r;
+    std::vector<uint8_t> _initiator_used;
+    SpatialGrid _initiator_grid;
+    std::vector<double> _unpaired_xs;
+    std::vector<double> _unpaired_ys;
+    std::vector<std::array<double, 3>> _unpaired_r;
+
+    std::vector<TrackGate> _gates;
+    std::vector<int32_t> _track_plot;
+    std::vector<uint8_t> _plot_used;
+    PlotBatch _leftover;
+    std::vector<uint32_t> _leftover_plot;
+    int _next_id = 0;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include "target.h"
+#include "philox.h"
+#include "worker-pool.h"
+#include "occlusion.h"
+
+struct VideoConfig {
+    int azimuths = 360;                            // spokes per antenna revolution
+    int range_bins = 1000;                         // over MAX_DISTANCE
+    double beam_width = 2.0 * EIGEN_PI / 180.0;    // radians, two-way 3 dB width
+    double pulse_length = 6.0;                     // metres, 3 dB width of an echo in range
+    double target_snr = 30.0;                      // dB over thermal noise
+    double clutter_cnr = 25.0;                     // dB over noise inside clutter_range
+    double clutter_range = 100.0;                  // metres; beyond it clutter falls with range^-3
+    double clutter_spread = 4.0;                   // dB, standard deviation of land patches around that
+    double display_floor = -10.0;                  // dB mapped to intensity 0
+    double display_range = 60.0;                   // dB mapped onto 0..255
+};
+
+// One antenna revolution in spoke-major order: spoke s holds range_bins
+// cells covering bearings [s, s + 1) * 2 pi / azimuths. Amplitudes are
+// linear, in units of the thermal noise rms; intensities are the same cells
+// log-compressed to a byte for display.
+struct VideoScan {
+    uint64_t tick = 0;
+    int azimuths = 0;
+    int range_bins = 0;
+    std::vector<float> amplitude;
+    std::vector<uint8_t> intensity;
+
+    const float* spoke(int azimuth) const { return amplitude.data() + size_t(azimuth) * range_bins; }
+    const uint8_t* spokeIntensity(int azimuth) const { return intensity.data() + size_t(azimuth) * range_bins; }
+};
+
+// Synthesises raw radar video: Rayleigh noise whose power per cell is
+// thermal noise plus a fixed land clutter map, and target echoes shaped by
+// the beam and pulse. Spokes are independent and run in parallel; noise and
+// compression are array kernels over a whole spoke. Draws are counter-based,
+// so a scan is reproducible from (seed, tick) regardless of threading.
+// Targets hidden by the occlusion map return no echo.
+class VideoGenerator {
+public:
+    VideoGenerator(const VideoConfig& config, const CounterRng& rng, WorkerPool& workers);
+
+    // Null for a clear line of sight everywhere.
+    void setOcclusion(const OcclusionMap* occlusion);
+
+    void scan(const CounterRng& rng, uint64_t tick, const Target* targets, size_t count, VideoScan& out);
+
+    const VideoConfig& config() const;
+
+private:
+    void buildClutterMap(const CounterRng& rng);
+    void sortTargets(const CounterRng& rng, uint64_t tick, const Target* targets, size_t count);
+    void generateSpoke(const CounterRng& rng, uint64_t tick, int azimuth, float* amplitude,
+        float* echo_i, float* echo_q, std::vector<int>& touched) const;
+    void compress(const float* amplitude, float* scratch, uint8_t* intensity) const;
+
+    VideoConfig _config;
+    WorkerPool& _workers;
+    const OcclusionMap* _occlusion = nullptr;
+    double _azimuth_step;
+    double _bin_length;
+    int _beam_spokes;
+    std::vector<float> _noise_sigma;          // azimuths x range_bins, rms amplitude of noise plus clutter
+    std::vector<int32_t> _target_spoke;
+    std::vector<uint32_t> _spoke_offsets;     // targets sorted by the spoke they fall in
+    std::vector<uint32_t> _spoke_fill;
+    std::vector<float> _echo_range;
+    std::vector<float> _echo_angle;
+    std::vector<float> _echo_phase;
+};
@@ -0,0 +1,475 @@
+#include "alarms.h"
+#include "slot-map.h"
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+
+constexpr size_t MATCH_BLOCK = 4096;
+constexpr int STATE_PAGE_BITS = 12;
+constexpr size_t STATE_PAGE_SLOTS = size_t(1) << STATE_PAGE_BITS;
+constexpr size_t GRID_CELLS = size_t(ALARM_GRID_BEARINGS) * ALARM_GRID_RANGE_BINS;
+constexpr double BEARING_STEP = 2 * EIGEN_PI / ALARM_GRID_BEARINGS;
+constexpr double RANGE_STEP = MAX_DISTANCE / ALARM_GRID_RANGE_BINS;
+constexpr uint32_t MET_NOTHING = 0;
+constexpr uint32_t MET_LIMITED = 1;
+
+uint32_t metMask(uint16_t mask, int id) {
+    return (uint32_t(mask) + 1) * (SLOT_GENERATION_MASK + 1) + slotGeneration(id);
+}
+
+double cross(const Eigen::Vector2d& a, const Eigen::Vector2d& b) {
+    return a.x() * b.y() - a.y() * b.x();
+}
+
+double positiveAngle(double angle) {
+    angle = std::fmod(angle, 2 * EIGEN_PI);
+    return angle < 0.0 ? angle + 2 * EIGEN_PI : angle;
+}
+
+}
+
+AlarmConfig loadAlarmConfig(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open alarm file: " + path);
+    }
+
+    AlarmConfig config;
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        auto fail = [&](const std::string& message) {
+            throw std::runtime_error(path + ":" + std::to_string(number) + ": " + message);
+        };
+        auto parse = [&](const std::string& text) -> double {
+            size_t used = 0;
+            double value = 0.0;
+            try {
+                value = std::stod(text, &used);
+            }
+            catch (const std::logic_error&) {
+                used = 0;
+            }
+            if (used == 0 || used != text.size()) {
+                fail("expected a number but got " + text);
+            }
+            return value;
+        };
+
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::vector<std::string> words;
+        for (std::string word; fields >> word;) {
+            words.push_back(word);
+        }
+        if (words.empty()) {
+            continue;
+        }
+        if (words.size() < 3) {
+            fail("incomplete definition");
+        }
+
+        if (words[0] == "zone") {
+            AlarmZone zone;
+            zone.name = words[1];
+            for (const auto& other : config.zones) {
+                if (other.name == zone.name) {
+                    fail("zone " + zone.name + " is already defined");
+                }
+            }
+            if (words[2] == "polygon") {
+                zone.shape = AlarmZone::Shape::Polygon;
+                for (size_t i = 3; i < words.size(); ++i) {
+                    const size_t comma = words[i].find(',');
+                    if (comma == std::string::npos) {
+                        fail("expected x,y but got " + words[i]);
+                    }
+                    zone.vertices.emplace_back(parse(words[i].substr(0, comma)), parse(words[i].substr(comma + 1)));
+                }
+                if (zone.vertices.size() < 3) {
+                    fail("a polygon needs at least 3 vertices");
+                }
+            }
+            else if (words[2] == "sector") {
+                if (words.size() != 7) {
+                    fail("a sector is MIN_RANGE MAX_RANGE FROM_BEARING TO_BEARING");
+                }
+                zone.shape = AlarmZone::Shape::Sector;
+                zone.min_range = parse(words[3]);
+                zone.max_range = parse(words[4]);
+                zone.from_angle = parse(words[5]) * EIGEN_PI / 180.0;
+                zone.to_angle = parse(words[6]) * EIGEN_PI / 180.0;
+                if (zone.min_range < 0.0 || zone.max_range <= zone.min_range) {
+                    fail("a sector needs 0 <= MIN_RANGE < MAX_RANGE");
+                }
+            }
+            else {
+                fail("expected polygon or sector but got " + words[2]);
+            }
+            config.zones.push_back(std::move(zone));
+        }
+        else if (words[0] == "rule") {
+            AlarmRule rule;
+            rule.name = words[1];
+            for (size_t i = 2; i < words.size(); i += 2) {
+                if (i + 1 >= words.size()) {
+                    fail(words[i] + " needs a value");
+                }
+                const std::string& value = words[i + 1];
+                if (words[i] == "in") {
+                    auto zone = std::find_if(config.zones.begin(), config.zones.end(),
+                        [&](const AlarmZone& z) { return z.name == value; });
+                    if (zone == config.zones.end()) {
+                        fail("zone " + value + " is not defined above");
+                    }
+                    rule.zone = static_cast<int>(zone - config.zones.begin());
+                }
+                else if (words[i] == "within") {
+                    rule.max_range = parse(value);
+                }
+                else if (words[i] == "faster") {
+                    rule.min_speed = parse(value);
+                }
+                else {
+                    fail("expected in, within or faster but got " + words[i]);
+                }
+            }
+            config.rules.push_back(std::move(rule));
+        }
+        else {
+            fail("expected zone or rule but got " + words[0]);
+        }
+    }
+    return config;
+}
+
+AlarmEngine::AlarmEngine(const AlarmConfig& config, WorkerPool& workers) :
+    _workers(workers),
+    _rules(config.rules),
+    _words((config.rules.size() + 63) / 64),
+    _pages(SLOT_CAPACITY >> STATE_PAGE_BITS)
+{
+    if (_rules.empty() || _rules.size() > 65536) {
+        throw std::invalid_argument("Alarms need 1 to 65536 rules");
+    }
+
+    const size_t n = _rules.size();
+    _max_range.resize(n);
+    _min_speed_squared.resize(n);
+    _limited.assign(_words, 0);
+    std::vector<uint64_t> anywhere(_words, 0);
+    for (size_t r = 0; r < n; ++r) {
+        const AlarmRule& rule = _rules[r];
+        if (rule.zone >= static_cast<int>(config.zones.size())) {
+            throw std::invalid_argument("Alarm rule " + rule.name + " refers to a missing zone");
+        }
+        if (rule.zone < 0 && rule.max_range < 0.0 && rule.min_speed < 0.0) {
+            throw std::invalid_argument("Alarm rule " + rule.name + " has no condition");
+        }
+        const uint64_t bit = uint64_t{ 1 } << (r % 64);
+        _max_range[r] = rule.max_range < 0.0 ? std::numeric_limits<double>::infinity() : rule.max_range;
+        _min_speed_squared[r] = rule.min_speed < 0.0 ? -1.0 : rule.min_speed * rule.min_speed;
+        if (rule.max_range >= 0.0 || rule.min_speed >= 0.0) {
+            _limited[r / 64] |= bit;
+        }
+        if (rule.zone < 0) {
+            anywhere[r / 64] |= bit;
+        }
+        _needs_speed |= rule.min_speed >= 0.0;
+    }
+
+    // The cell past the grid holds targets beyond MAX_DISTANCE, which no
+    // zone covers.
+    std::vector<uint64_t> cell_rules((GRID_CELLS + 1) * _words);
+    for (size_t c = 0; c <= GRID_CELLS; ++c) {
+        std::copy(anywhere.begin(), anywhere.end(), cell_rules.begin() + c * _words);
+    }
+    std::vector<uint8_t> inside(GRID_CELLS);
+    for (size_t z = 0; z < config.zones.size(); ++z) {
+        rasterise(config.zones[z], inside);
+        for (size_t r = 0; r < n; ++r) {
+            if (_rules[r].zone != static_cast<int>(z)) {
+                continue;
+            }
+            const uint64_t bit = uint64_t{ 1 } << (r % 64);
+            for (size_t c = 0; c < GRID_CELLS; ++c) {
+                if (inside[c]) {
+                    cell_rules[c * _words + r / 64] |= bit;
+                }
+            }
+        }
+    }
+
+    // Neighbouring cells along a bearing mostly share a mask, so the map is
+    // only consulted where it changes.
+    std::map<std::vector<uint64_t>, uint16_t> ids;
+    std::vector<uint64_t> key(_words);
+    _cell_mask.resize(GRID_CELLS + 1);
+    for (size_t c = 0; c <= GRID_CELLS; ++c) {
+        const auto first = cell_rules.begin() + c * _words;
+        if (c > 0 && std::equal(first, first + _words, key.begin())) {
+            _cell_mask[c] = _cell_mask[c - 1];
+            continue;
+        }
+        key.assign(first, first + _words);
+        if (ids.size() == 65536 && !ids.count(key)) {
+            throw std::invalid_argument("Alarm zones overlap in too many combinations");
+        }
+        auto [it, added] = ids.emplace(key, static_cast<uint16_t>(ids.size()));
+        if (added) {
+            _masks.insert(_masks.end(), key.begin(), key.end());
+        }
+        _cell_mask[c] = it->second;
+    }
+
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    for (size_t m = 0; m < maskCount(); ++m) {
+        MaskBounds bounds = { -INF, INF, -INF, INF, false };
+        for (size_t w = 0; w < _words; ++w) {
+            for (uint64_t bits = _masks[m * _words + w]; bits; bits &= bits - 1) {
+                const size_t r = w * 64 + std::countr_zero(bits);
+                const AlarmRule& rule = _rules[r];
+                if (rule.max_range < 0.0 && rule.min_speed < 0.0) {
+                    bounds.unlimited = true;
+                }
+                else if (rule.min_speed < 0.0) {
+                    bounds.range = std::max(bounds.range, _max_range[r]);
+                }
+                else if (rule.max_range < 0.0) {
+                    bounds.speed_squared = std::min(bounds.speed_squared, _min_speed_squared[r]);
+                }
+                else {
+                    bounds.both_range = std::max(bounds.both_range, _max_range[r]);
+                    bounds.both_speed_squared = std::min(bounds.both_speed_squared, _min_speed_squared[r]);
+                }
+            }
+        }
+        _bounds.push_back(bounds);
+    }
+}
+
+const std::vector<AlarmRule>& AlarmEngine::rules() const {
+    return _rules;
+}
+
+size_t AlarmEngine::maskCount() const {
+    return _masks.size() / _words;
+}
+
+// Marks the cells whose centre lies in the zone, bearing by bearing. For a
+// polygon the ray through the bearing is crossed with every edge, and a
+// cell is inside when an odd number of crossings lie beyond its centre.
+void AlarmEngine::rasterise(const AlarmZone& zone, std::vector<uint8_t>& inside) const {
+    std::fill(inside.begin(), inside.end(), 0);
+    const int bins = ALARM_GRID_RANGE_BINS;
+    std::vector<double> crossings;
+
+    for (int b = 0; b < ALARM_GRID_BEARINGS; ++b) {
+        const double theta = (b + 0.5) * BEARING_STEP;
+        uint8_t* row = inside.data() + size_t(b) * bins;
+
+        if (zone.shape == AlarmZone::Shape::Sector) {
+            double span = positiveAngle(zone.to_angle - zone.from_angle);
+            span = span == 0.0 ? 2 * EIGEN_PI : span;
+            if (positiveAngle(theta - zone.from_angle) >= span) {
+                continue;
+            }
+            const int first = std::max(0, static_cast<int>(std::ceil(zone.min_range / RANGE_STEP - 0.5)));
+            const int last = std::min(bins - 1, static_cast<int>(std::floor(zone.max_range / RANGE_STEP - 0.5)));
+            for (int j = first; j <= last; ++j) {
+                row[j] = 1;
+            }
+            continue;
+        }
+
+        const Eigen::Vector2d u(std::cos(theta), std::sin(theta));
+        const auto& v = zone.vertices;
+        crossings.clear();
+        for (size_t i = 0, k = v.size() - 1; i < v.size(); k = i++) {
+            if ((cross(u, v[k]) > 0.0) == (cross(u, v[i]) > 0.0)) {
+                continue;
+            }
+            const Eigen::Vector2d d = v[i] - v[k];
+            const double r = cross(v[k], d) / cross(u, d);
+            if (r > 0.0) {
+                crossings.push_back(r);
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        size_t passed = 0;
+        for (int j = 0; j < bins; ++j) {
+            const double rho = (j + 0.5) * RANGE_STEP;
+            while (passed < crossings.size() && crossings[passed] <= rho) {
+                ++passed;
+            }
+            row[j] = (crossings.size() - passed) & 1;
+        }
+    }
+}
+
+// Angles are in [0, 2 pi), as targets keep them, so the bearing bin is a
+// truncation and a mask.
+void AlarmEngine::findHits(const Block& block, Hits& hits) const {
+    constexpr double BEARINGS_PER_RADIAN = ALARM_GRID_BEARINGS / (2 * EIGEN_PI);
+    constexpr double BINS_PER_METRE = ALARM_GRID_RANGE_BINS / MAX_DISTANCE;
+    const int* ids = block.part->ids;
+    const double* distance = block.part->distance;
+    const double* angle = block.part->angle;
+    const double* vx = block.part->vx;
+    const double* vy = block.part->vy;
+    const uint16_t* cell_mask = _cell_mask.data();
+    const MaskBounds* all_bounds = _bounds.data();
+    const uint32_t* last = _last.data();
+    hits.index.clear();
+    hits.cell.clear();
+    for (size_t i = block.first; i < block.first + block.count; ++i) {
+        const double d = distance[i];
+        const int bearing = static_cast<int>(angle[i] * BEARINGS_PER_RADIAN) & (ALARM_GRID_BEARINGS - 1);
+        const int range = static_cast<int>(d * BINS_PER_METRE);
+        const int32_t cell = range < ALARM_GRID_RANGE_BINS
+            ? bearing * ALARM_GRID_RANGE_BINS + range : static_cast<int32_t>(GRID_CELLS);
+        const uint16_t mask = cell_mask[cell];
+        const MaskBounds& bounds = all_bounds[mask];
+        const double speed_squared = vx[i] * vx[i] + vy[i] * vy[i];
+        const bool passes = d <= bounds.range || speed_squared >= bounds.speed_squared
+            || (d <= bounds.both_range && speed_squared >= bounds.both_speed_squared);
+        const uint32_t unchanged = bounds.unlimited ? metMask(mask, ids[i]) : MET_NOTHING;
+        if (passes || last[slotIndex(ids[i])] != unchanged) {
+            hits.index.push_back(static_cast<uint32_t>(i));
+            hits.cell.push_back(cell);
+        }
+    }
+}
+
+void AlarmEngine::claimPages(const Block& block, const Hits& hits) {
+    std::lock_guard<std::mutex> lock(_pages_mutex);
+    for (const uint32_t i : hits.index) {
+        auto& page = _pages[slotIndex(block.part->ids[i]) >> STATE_PAGE_BITS];
+        if (!page) {
+            page = std::make_unique<StatePage>();
+            page->met.assign(STATE_PAGE_SLOTS * _words, 0);
+            page->ids.assign(STATE_PAGE_SLOTS, -1);
+        }
+    }
+}
+
+// Targets own distinct slots, so blocks never share state, and a page is
+// only ever created under the lock; events are gathered per block and kept
+// in column order. The per-slot summary is grown up front to the highest
+// slot in use.
+void AlarmEngine::evaluate(uint64_t tick, const MotionColumns* parts, size_t count, std::vector<AlarmEvent>& out) {
+    uint32_t slots = 0;
+    for (size_t p = 0; p < count; ++p) {
+        for (size_t i = 0; i < parts[p].count; ++i) {
+            slots = std::max(slots, slotIndex(parts[p].ids[i]) + 1);
+        }
+    }
+    if (_last.size() < slots) {
+        _last.resize(slots, MET_NOTHING);
+    }
+
+    size_t blocks = 0;
+    for (size_t p = 0; p < count; ++p) {
+        for (size_t first = 0; first < parts[p].count; first += MATCH_BLOCK) {
+            if (blocks == _blocks.size()) {
+                _blocks.emplace_back();
+            }
+            Block& block = _blocks[blocks++];
+            block.part = &parts[p];
+            block.first = first;
+            block.count = std::min(MATCH_BLOCK, parts[p].count - first);
+        }
+    }
+
+    _workers.parallelFor(blocks, 1, [&](size_t begin, size_t end) {
+        Hits hits;
+        hits.index.reserve(MATCH_BLOCK);
+        hits.cell.reserve(MATCH_BLOCK);
+        for (size_t b = begin; b < end; ++b) {
+            findHits(_blocks[b], hits);
+            if (!hits.index.empty()) {
+                claimPages(_blocks[b], hits);
+            }
+            matchHits(tick, _blocks[b], hits);
+        }
+    });
+    for (size_t b = 0; b < blocks; ++b) {
+        out.insert(out.end(), _blocks[b].events.begin(), _blocks[b].events.end());
+    }
+}
+
+// A frame's speeds come from the last two trail points, by the law of
+// cosines, and only if a rule has a speed limit.
+void AlarmEngine::evaluate(uint64_t tick, const Target* targets, size_t count, std::vector<AlarmEvent>& out) {
+    _frame_ids.resize(count);
+    _frame_distance.resize(count);
+    _frame_angle.resize(count);
+    _frame_speed.resize(count);
+    _frame_zero.assign(count, 0.0);
+    for (size_t i = 0; i < count; ++i) {
+        const Target& t = targets[i];
+        _frame_ids[i] = t.id;
+        _frame_distance[i] = t.distance;
+        _frame_angle[i] = t.angle;
+        _frame_speed[i] = 0.0;
+        if (_needs_speed) {
+            const Eigen::Vector2d& from = t.trail[TRAIL_SIZE - 1];
+            const Eigen::Vector2d& to = t.trail[TRAIL_SIZE];
+            const double step = to.x() * to.x() + from.x() * from.x() - 2.0 * to.x() * from.x() * std::cos(to.y() - from.y());
+            _frame_speed[i] = std::sqrt(std::max(step, 0.0));
+        }
+    }
+    const MotionColumns frame{
+        _frame_ids.data(), _frame_distance.data(), _frame_angle.data(), _frame_speed.data(), _frame_zero.data(), count
+    };
+    evaluate(tick, &frame, 1, out);
+}
+
+void AlarmEngine::matchHits(uint64_t tick, Block& block, const Hits& hits) {
+    const MotionColumns& part = *block.part;
+    const size_t words = _words;
+    block.events.clear();
+    for (size_t h = 0; h < hits.index.size(); ++h) {
+        const size_t i = hits.index[h];
+        const int id = part.ids[i];
+        const uint32_t slot = slotIndex(id);
+        StatePage& page = *_pages[slot >> STATE_PAGE_BITS];
+        const size_t k = slot & (STATE_PAGE_SLOTS - 1);
+        uint64_t* last = page.met.data() + k * words;
+        if (page.ids[k] != id) {
+            std::fill_n(last, words, 0);
+            page.ids[k] = id;
+        }
+
+        const uint16_t mask_id = _cell_mask[hits.cell[h]];
+        const uint64_t* mask = _masks.data() + size_t(mask_id) * words;
+        const double distance = part.distance[i];
+        const double speed_squared = part.vx[i] * part.vx[i] + part.vy[i] * part.vy[i];
+        uint64_t any = 0;
+        uint64_t limited_met = 0;
+        for (size_t w = 0; w < words; ++w) {
+            uint64_t met = mask[w];
+            for (uint64_t limited = met & _limited[w]; limited; limited &= limited - 1) {
+                const int bit = std::countr_zero(limited);
+                const size_t r = w * 64 + bit;
+                if (distance > _max_range[r] || speed_squared < _min_speed_squared[r]) {
+                    met &= ~(uint64_t{ 1 } << bit);
+                }
+            }
+            for (uint64_t raised = met & ~last[w]; raised; raised &= raised - 1) {
+                const auto rule = static_cast<uint16_t>(w * 64 + std::countr_zero(raised));
+                block.events.push_back({ tick, rule, id, static_cast<float>(distance), static_cast<float>(part.angle[i]) });
+            }
+            last[w] = met;
+            any |= met;
+            limited_met |= met & _limited[w];
+        }
+        _last[slot] = any == 0 ? MET_NOTHING : limited_met == 0 ? metMask(mask_id, id) : MET_LIMITED;
+    }
+}
@@ -0,0 +1,252 @@
+#include "association.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+// Plots are gated in this many fixed chunks, merged in order, so the edge
+// list (and with it the assignment) does not depend on the thread count.
+constexpr size_t GATE_CHUNKS = 64;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+}
+
+Associator::Associator(const AssociationConfig& config, WorkerPool& workers) :
+    _config(config),
+    _workers(workers),
+    _grid(MAX_DISTANCE, config.cell_size),
+    _chunk_edges(GATE_CHUNKS)
+{
+}
+
+const AssociationStats& Associator::stats() const {
+    return _stats;
+}
+
+void Associator::associate(const std::vector<TrackGate>& tracks, const PlotBatch& plots, std::vector<int32_t>& track_plot) {
+    _stats = AssociationStats{};
+    track_plot.assign(tracks.size(), -1);
+    if (tracks.empty() || plots.size() == 0) {
+        return;
+    }
+
+    auto t0 = Clock::now();
+    gatePlots(tracks, plots);
+    _stats.gate_ms = elapsedMs(t0);
+
+    auto t1 = Clock::now();
+    buildClusters(tracks.size(), plots.size());
+    _stats.cluster_ms = elapsedMs(t1);
+
+    auto t2 = Clock::now();
+    _prices.assign(plots.size(), 0.0);
+    _owners.assign(plots.size(), -1);
+    const size_t clusters = _cluster_start.size() - 1;
+    _workers.parallelFor(clusters, 16, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            auction(_cluster_tracks.data() + _cluster_start[c], _cluster_start[c + 1] - _cluster_start[c], track_plot);
+        }
+    });
+    _stats.assign_ms = elapsedMs(t2);
+
+    for (int32_t plot : track_plot) {
+        _stats.assigned += plot >= 0;
+    }
+}
+
+void Associator::gatePlots(const std::vector<TrackGate>& tracks, const PlotBatch& plots) {
+    const size_t n = tracks.size();
+    _track_xs.resize(n);
+    _track_ys.resize(n);
+    _inv_xx.resize(n);
+    _inv_xy.resize(n);
+    _inv_yy.resize(n);
+
+    // The grid is searched with one radius, that of the widest gate.
+    double max_eigen = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const TrackGate& g = tracks[i];
+        const double det = g.sxx * g.syy - g.sxy * g.sxy;
+        _track_xs[i] = g.x;
+        _track_ys[i] = g.y;
+        _inv_xx[i] = g.syy / det;
+        _inv_xy[i] = -g.sxy / det;
+        _inv_yy[i] = g.sxx / det;
+
+        const double half_trace = 0.5 * (g.sxx + g.syy);
+        const double half_gap = 0.5 * (g.sxx - g.syy);
+        max_eigen = std::max(max_eigen, half_trace + std::sqrt(half_gap * half_gap + g.sxy * g.sxy));
+    }
+    const double radius = std::sqrt(_config.gate * max_eigen);
+    _grid.build(_track_xs, _track_ys);
+
+    const size_t plot_count = plots.size();
+    const double gate = _config.gate;
+    _workers.parallelFor(GATE_CHUNKS, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            std::vector<Edge>& local = _chunk_edges[chunk];
+            local.clear();
+            const size_t first = chunk * plot_count / GATE_CHUNKS;
+            const size_t last = (chunk + 1) * plot_count / GATE_CHUNKS;
+
+            for (size_t p = first; p < last; ++p) {
+                const double x = plots.distances[p] * std::cos(static_cast<double>(plots.angles[p]));
+                const double y = plots.distances[p] * std::sin(static_cast<double>(plots.angles[p]));
+                _grid.forEachInRadius(x, y, radius, [&](uint32_t t, double) {
+                    const double dx = x - _track_xs[t];
+                    const double dy = y - _track_ys[t];
+                    const double d2 = dx * dx * _inv_xx[t] + 2.0 * dx * dy * _inv_xy[t] + dy * dy * _inv_yy[t];
+                    if (d2 <= gate) {
+                        local.push_back({ t, static_cast<uint32_t>(p), static_cast<float>(gate - d2) });
+                    }
+                });
+            }
+        }
+    });
+
+    _edge_start.assign(n + 1, 0);
+    for (const auto& local : _chunk_edges) {
+        for (const Edge& e : local) {
+            ++_edge_start[e.track + 1];
+        }
+    }
+    std::partial_sum(_edge_start.begin(), _edge_start.end(), _edge_start.begin());
+    _edges.resize(_edge_start[n]);
+
+    std::vector<uint32_t> cursor(_edge_start.begin(), _edge_start.end() - 1);
+    for (const auto& local : _chunk_edges) {
+        for (const Edge& e : local) {
+            _edges[cursor[e.track]++] = e;
+        }
+    }
+    _stats.edges = _edges.size();
+}
+
+uint32_t Associator::findRoot(uint32_t track) {
+    while (_parent[track] != track) {
+        _parent[track] = _parent[_parent[track]];
+        track = _parent[track];
+    }
+    return track;
+}
+
+// Union-find over tracks, joined through the plots they share.
+void Associator::buildClusters(size_t track_count, size_t plot_count) {
+    _parent.resize(track_count);
+    std::iota(_parent.begin(), _parent.end(), 0u);
+    _plot_first_track.assign(plot_count, -1);
+
+    for (const Edge& e : _edges) {
+        int32_t& first = _plot_first_track[e.plot];
+        if (first < 0) {
+            first = static_cast<int32_t>(e.track);
+            continue;
+        }
+        const uint32_t a = findRoot(e.track);
+        const uint32_t b = findRoot(static_cast<uint32_t>(first));
+        if (a != b) {
+            _parent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    // Clusters are numbered by first track and laid out largest first, so
+    // a giant cluster starts early instead of finishing last.
+    std::vector<int32_t> cluster_of(track_count, -1);
+    std::vector<uint32_t> sizes;
+    for (uint32_t t = 0; t < track_count; ++t) {
+        if (_edge_start[t] == _edge_start[t + 1]) {
+            continue;
+        }
+        const uint32_t root = findRoot(t);
+        if (cluster_of[root] < 0) {
+            cluster_of[root] = static_cast<int32_t>(sizes.size());
+            sizes.push_back(0);
+        }
+        cluster_of[t] = cluster_of[root];
+        ++sizes[cluster_of[t]];
+    }
+
+    std::vector<uint32_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return sizes[a] > sizes[b];
+    });
+    std::vector<uint32_t> slot(sizes.size());
+    _cluster_start.assign(sizes.size() + 1, 0);
+    for (size_t k = 0; k < order.size(); ++k) {
+        slot[order[k]] = static_cast<uint32_t>(k);
+        _cluster_start[k + 1] = _cluster_start[k] + sizes[order[k]];
+    }
+
+    _cluster_tracks.resize(_cluster_start.back());
+    std::vector<uint32_t> cursor(_cluster_start.begin(), _cluster_start.end() - 1);
+    for (uint32_t t = 0; t < track_count; ++t) {
+        if (cluster_of[t] >= 0) {
+            _cluster_tracks[cursor[slot[cluster_of[t]]]++] = t;
+        }
+    }
+
+    _stats.clusters = sizes.size();
+    _stats.largest_cluster = sizes.empty() ? 0 : sizes[order[0]];
+}
+
+// Gauss-Seidel auction: an unassigned track bids for its best plot, raising
+// the price by the margin over its second-best option plus epsilon, and the
+// outbid track goes back into the queue. Staying unassigned is worth 0 and
+// never priced, so a track drops out once every gated plot costs more than
+// its margin over the gate.
+void Associator::auction(const uint32_t* tracks, size_t count, std::vector<int32_t>& track_plot) {
+    if (count == 1) {
+        const uint32_t t = tracks[0];
+        float best = -1.0f;
+        for (uint32_t e = _edge_start[t]; e < _edge_start[t + 1]; ++e) {
+            if (_edges[e].benefit > best) {
+                best = _edges[e].benefit;
+                track_plot[t] = static_cast<int32_t>(_edges[e].plot);
+            }
+        }
+        return;
+    }
+
+    std::vector<uint32_t> queue(tracks, tracks + count);
+    std::reverse(queue.begin(), queue.end());
+    while (!queue.empty()) {
+        const uint32_t t = queue.back();
+        queue.pop_back();
+
+        double best = 0.0;
+        double second = 0.0;
+        int32_t best_plot = -1;
+        for (uint32_t e = _edge_start[t]; e < _edge_start[t + 1]; ++e) {
+            const double value = _edges[e].benefit - _prices[_edges[e].plot];
+            if (value > best) {
+                second = best;
+                best = value;
+                best_plot = static_cast<int32_t>(_edges[e].plot);
+            }
+            else if (value > second) {
+                second = value;
+            }
+        }
+        if (best_plot < 0) {
+            track_plot[t] = -1;
+            continue;
+        }
+
+        _prices[best_plot] += best - second + _config.auction_epsilon;
+        const int32_t previous = _owners[best_plot];
+        _owners[best_plot] = static_cast<int32_t>(t);
+        track_plot[t] = best_plot;
+        if (previous >= 0) {
+            track_plot[previous] = -1;
+            queue.push_back(static_cast<uint32_t>(previous));
+        }
+    }
+}
@@ -0,0 +1,348 @@
+#include "cfar.h"
+#include <algorithm>
+#include <stdexcept>
+#include <Eigen/Dense>
+
+namespace {
+
+// Threshold factor T on the k-th smallest of n exponential noise powers:
+// Pfa = prod_{i<k} (n - i) / (n - i + T), solved by bisection.
+double orderedScale(int n, int k, double pfa) {
+    auto falseAlarms = [&](double t) {
+        double p = 1.0;
+        for (int i = 0; i < k; ++i) {
+            p *= (n - i) / (n - i + t);
+        }
+        return p;
+    };
+    double lo = 0.0;
+    double hi = 1.0;
+    while (falseAlarms(hi) > pfa) {
+        hi *= 2.0;
+    }
+    for (int iter = 0; iter < 100; ++iter) {
+        const double mid = 0.5 * (lo + hi);
+        (falseAlarms(mid) > pfa ? lo : hi) = mid;
+    }
+    return hi;
+}
+
+uint32_t findRoot(std::vector<uint32_t>& parent, uint32_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+}
+
+CfarMethod parseCfarMethod(const std::string& name) {
+    if (name == "ca") {
+        return CfarMethod::CellAveraging;
+    }
+    if (name == "os") {
+        return CfarMethod::OrderedStatistic;
+    }
+    throw std::invalid_argument("Unknown CFAR method: " + name);
+}
+
+CfarDetector::CfarDetector(const CfarConfig& config, const VideoConfig& video, WorkerPool& workers) :
+    _config(config),
+    _video(video),
+    _workers(workers)
+{
+    if (config.training_length <= 0.0 || config.guard_length < 0.0) {
+        throw std::invalid_argument("CFAR needs a positive training length and a guard length not below zero");
+    }
+    if (config.false_alarm_rate <= 0.0 || config.false_alarm_rate >= 1.0) {
+        throw std::invalid_argument("False alarm rate must be within (0, 1)");
+    }
+    if (config.os_rank <= 0.0 || config.os_rank > 1.0) {
+        throw std::invalid_argument("Ordered statistic rank must be within (0, 1]");
+    }
+
+    const double bin_length = MAX_DISTANCE / video.range_bins;
+    _training = std::max(1, static_cast<int>(std::lround(config.training_length / bin_length)));
+    _guard = static_cast<int>(std::lround(config.guard_length / bin_length));
+    if (video.range_bins < 2 * (_training + _guard) + 1) {
+        throw std::invalid_argument("CFAR window is longer than a spoke");
+    }
+
+    // Cells near either end of a spoke only have the training cells on one
+    // side, down to half of them in all, so factors are kept per count.
+    const int most = 2 * _training;
+    _scale.assign(most + 1, 0.0f);
+    _rank.assign(most + 1, 0);
+    for (int n = _training; n <= most; ++n) {
+        if (config.method == CfarMethod::CellAveraging) {
+            // Pfa = (1 + T / n)^-n for a threshold T times the mean; applied to the sum.
+            _scale[n] = static_cast<float>(std::pow(config.false_alarm_rate, -1.0 / n) - 1.0);
+        }
+        else {
+            _rank[n] = std::clamp(static_cast<int>(std::lround(config.os_rank * n)), 1, n);
+            _scale[n] = static_cast<float>(orderedScale(n, _rank[n], config.false_alarm_rate));
+        }
+    }
+}
+
+const CfarConfig& CfarDetector::config() const {
+    return _config;
+}
+
+double CfarDetector::rangeSigma() const {
+    return std::max(_video.pulse_length / 2.0, MAX_DISTANCE / _video.range_bins);
+}
+
+double CfarDetector::bearingSigma() const {
+    return _video.beam_width / 4.0;
+}
+
+void CfarDetector::setClutterMap(ClutterMap* map) {
+    if (map && (map->azimuths() != _video.azimuths || map->rangeBins() != _video.range_bins)) {
+        throw std::invalid_argument("Clutter map layout does not match the video");
+    }
+    _clutter_map = map;
+}
+
+void CfarDetector::detect(const VideoScan& video, PlotBatch& out) {
+    if (video.azimuths != _video.azimuths || video.range_bins != _video.range_bins) {
+        throw std::invalid_argument("Video layout does not match the detector");
+    }
+    _hits.resize(video.azimuths);
+    if (_clutter_map) {
+        _clutter_map->beginScan();
+    }
+
+    const int bins = video.range_bins;
+    _workers.parallelFor(video.azimuths, 4, [&](size_t begin, size_t end) {
+        Scratch scratch;
+        scratch.power.resize(bins);
+        scratch.prefix.resize(bins + 1);
+        scratch.level.resize(bins);
+        scratch.excess.resize(bins);
+        for (size_t s = begin; s < end; ++s) {
+            detectSpoke(static_cast<int>(s), video.spoke(static_cast<int>(s)), _hits[s], scratch);
+        }
+    });
+
+    mergeHits(video.tick, out);
+}
+
+void CfarDetector::detectSpoke(int azimuth, const float* amplitude, std::vector<Hit>& hits, Scratch& scratch) const {
+    const int bins = _video.range_bins;
+    Eigen::Map<const Eigen::ArrayXf> a(amplitude, bins);
+    Eigen::Map<Eigen::ArrayXf> power(scratch.power.data(), bins);
+    power = a.square();
+
+    if (_config.method == CfarMethod::CellAveraging) {
+        cellAveraging(scratch);
+    }
+    else {
+        orderedStatistic(scratch);
+    }
+
+    if (_clutter_map) {
+        if (_clutter_map->scale() > 0.0f) {
+            Eigen::Map<const Eigen::ArrayXf> mean(_clutter_map->spoke(azimuth), bins);
+            Eigen::Map<Eigen::ArrayXf> excess(scratch.excess.data(), bins);
+            excess = excess.min(power - _clutter_map->scale() * mean);
+        }
+        _clutter_map->update(azimuth, scratch.power.data());
+    }
+
+    hits.clear();
+    const float* p = scratch.power.data();
+    const float* excess = scratch.excess.data();
+    for (int b = 0; b < bins; ++b) {
+        if (excess[b] <= 0.0f) {
+            continue;
+        }
+        if (!hits.empty() && hits.back().last + 1 == b) {
+            Hit& hit = hits.back();
+            hit.last = static_cast<uint16_t>(b);
+            hit.power += p[b];
+            hit.range_moment += p[b] * (b + 0.5f);
+        }
+        else {
+            hits.push_back({ static_cast<uint16_t>(b), static_cast<uint16_t>(b), p[b], p[b] * (b + 0.5f) });
+        }
+    }
+}
+
+// Training cells of cell b that fall inside the spoke, as [first, end)
+// before and after it.
+void CfarDetector::window(int b, int& lag_first, int& lag_end, int& lead_first, int& lead_end) const {
+    const int bins = _video.range_bins;
+    lag_first = std::max(0, b - _guard - _training);
+    lag_end = std::max(0, b - _guard);
+    lead_first = std::min(bins, b + _guard + 1);
+    lead_end = std::min(bins, b + _guard + _training + 1);
+}
+
+// Window sums as differences of a running sum, so every cell costs the same
+// whatever the window length. The running sum is kept in double: over a
+// spoke of strong clutter a float one would lose the noise-level cells.
+void CfarDetector::cellAveraging(Scratch& scratch) const {
+    const int bins = _video.range_bins;
+    const int n = _training;
+    const int g = _guard;
+
+    double* prefix = scratch.prefix.data();
+    prefix[0] = 0.0;
+    for (int b = 0; b < bins; ++b) {
+        prefix[b + 1] = prefix[b] + scratch.power[b];
+    }
+
+    // Both sides complete: one array expression over the middle of the spoke.
+    const int first = n + g;
+    const int middle = bins - 2 * (n + g);
+    Eigen::Map<const Eigen::ArrayXd> sum(prefix, bins + 1);
+    Eigen::Map<const Eigen::ArrayXf> power(scratch.power.data(), bins);
+    Eigen::Map<Eigen::ArrayXf> excess(scratch.excess.data(), bins);
+    excess.segment(first, middle) = power.segment(first, middle)
+        - ((sum.segment(first - g, middle) - sum.segment(first - g - n, middle)
+            + sum.segment(first + g + n + 1, middle) - sum.segment(first + g + 1, middle))
+            * double(_scale[2 * n])).cast<float>();
+
+    auto edge = [&](int b) {
+        int lag_first, lag_end, lead_first, lead_end;
+        window(b, lag_first, lag_end, lead_first, lead_end);
+        const int count = (lag_end - lag_first) + (lead_end - lead_first);
+        const double total = prefix[lag_end] - prefix[lag_first] + prefix[lead_end] - prefix[lead_first];
+        scratch.excess[b] = static_cast<float>(scratch.power[b] - total * _scale[count]);
+    };
+    for (int b = 0; b < first; ++b) {
+        edge(b);
+    }
+    for (int b = first + middle; b < bins; ++b) {
+        edge(b);
+    }
+}
+
+// A cell beats T times the k-th smallest training cell exactly when at
+// least k training cells are below its power over T. Counting that is a
+// compare and add per window offset over the whole spoke, which vectorises,
+// where keeping a sorted window per cell does not.
+void CfarDetector::orderedStatistic(Scratch& scratch) const {
+    const int bins = _video.range_bins;
+    const int n = _training;
+    const int g = _guard;
+    const float* power = scratch.power.data();
+    float* level = scratch.level.data();
+    float* excess = scratch.excess.data();
+
+    const int first = n + g;
+    const int end = bins - n - g;
+    const float inverse_scale = 1.0f / _scale[2 * n];
+    const float need = _rank[2 * n] - 0.5f;
+    for (int b = first; b < end; ++b) {
+        level[b] = power[b] * inverse_scale;
+        excess[b] = -need;
+    }
+    for (int d = g + 1; d <= g + n; ++d) {
+        const float* before = power - d;
+        const float* after = power + d;
+        for (int b = first; b < end; ++b) {
+            excess[b] += (before[b] < level[b] ? 1.0f : 0.0f) + (after[b] < level[b] ? 1.0f : 0.0f);
+        }
+    }
+
+    auto edge = [&](int b) {
+        int lag_first, lag_end, lead_first, lead_end;
+        window(b, lag_first, lag_end, lead_first, lead_end);
+        const int count = (lag_end - lag_first) + (lead_end - lead_first);
+        const float cell_level = power[b] / _scale[count];
+        int below = 0;
+        for (int j = lag_first; j < lag_end; ++j) {
+            below += power[j] < cell_level;
+        }
+        for (int j = lead_first; j < lead_end; ++j) {
+            below += power[j] < cell_level;
+        }
+        excess[b] = below - (_rank[count] - 0.5f);
+    };
+    for (int b = 0; b < first; ++b) {
+        edge(b);
+    }
+    for (int b = end; b < bins; ++b) {
+        edge(b);
+    }
+}
+
+// Runs that overlap in range on neighbouring spokes are one echo seen
+// through the beam; they are joined with a union-find, the last spoke
+// wrapping round to the first.
+void CfarDetector::mergeHits(uint64_t tick, PlotBatch& out) {
+    const int azimuths = _video.azimuths;
+    _hit_offsets.resize(azimuths + 1);
+    _hit_offsets[0] = 0;
+    _detected_cells = 0;
+    for (int s = 0; s < azimuths; ++s) {
+        _hit_offsets[s + 1] = _hit_offsets[s] + static_cast<uint32_t>(_hits[s].size());
+        for (const Hit& hit : _hits[s]) {
+            _detected_cells += hit.last - hit.first + 1;
+        }
+    }
+    const uint32_t total = _hit_offsets[azimuths];
+    _parent.resize(total);
+    for (uint32_t i = 0; i < total; ++i) {
+        _parent[i] = i;
+    }
+
+    for (int s = 0; s < azimuths; ++s) {
+        const int next = (s + 1) % azimuths;
+        const auto& a = _hits[s];
+        const auto& b = _hits[next];
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a.size() && j < b.size()) {
+            if (a[i].first <= b[j].last && b[j].first <= a[i].last) {
+                const uint32_t ra = findRoot(_parent, _hit_offsets[s] + static_cast<uint32_t>(i));
+                const uint32_t rb = findRoot(_parent, _hit_offsets[next] + static_cast<uint32_t>(j));
+                _parent[std::max(ra, rb)] = std::min(ra, rb);
+            }
+            if (a[i].last < b[j].last) {
+                ++i;
+            }
+            else {
+                ++j;
+            }
+        }
+    }
+
+    // Per echo: total power, and power-weighted range and bearing (as a
+    // vector sum, so an echo across north does not average to south).
+    std::vector<double>& sums = _sums;
+    sums.assign(size_t(total) * 4, 0.0);
+    const double step = 2 * EIGEN_PI / azimuths;
+    for (int s = 0; s < azimuths; ++s) {
+        const double angle = (s + 0.5) * step;
+        const double c = std::cos(angle);
+        const double sn = std::sin(angle);
+        for (size_t i = 0; i < _hits[s].size(); ++i) {
+            const Hit& hit = _hits[s][i];
+            double* sum = sums.data() + size_t(findRoot(_parent, _hit_offsets[s] + static_cast<uint32_t>(i))) * 4;
+            sum[0] += hit.power;
+            sum[1] += hit.range_moment;
+            sum[2] += hit.power * c;
+            sum[3] += hit.power * sn;
+        }
+    }
+
+    const double bin_length = MAX_DISTANCE / _video.range_bins;
+    out.tick = tick;
+    out.detections = 0;
+    out.resize(0);
+    for (uint32_t i = 0; i < total; ++i) {
+        if (_parent[i] != i) {
+            continue;
+        }
+        const double* sum = sums.data() + size_t(i) * 4;
+        double angle = std::atan2(sum[3], sum[2]);
+        angle = angle < 0.0 ? angle + 2 * EIGEN_PI : angle;
+        out.distances.push_back(static_cast<float>(sum[1] / sum[0] * bin_length));
+        out.angles.push_back(static_cast<float>(angle));
+        out.target_ids.push_back(-1);
+    }
+}
@@ -0,0 +1,103 @@
+#include "clutter-map.h"
+#include "mapped-file.h"
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <Eigen/Dense>
+
+ClutterMap::ClutterMap(const ClutterMapConfig& config, int azimuths, int range_bins) :
+    _config(config),
+    _azimuths(azimuths),
+    _range_bins(range_bins),
+    _mean(size_t(azimuths) * range_bins, 0.0f)
+{
+    if (config.time_constant < 1.0) {
+        throw std::invalid_argument("Clutter map time constant must be at least one scan");
+    }
+    if (config.false_alarm_rate <= 0.0 || config.false_alarm_rate >= 1.0) {
+        throw std::invalid_argument("False alarm rate must be within (0, 1)");
+    }
+    if (config.snapshot_interval < 1) {
+        throw std::invalid_argument("Clutter map snapshot interval must be positive");
+    }
+}
+
+bool ClutterMap::load(const std::string& path) {
+    if (!std::filesystem::exists(path)) {
+        return false;
+    }
+    MappedFile file(path);
+    ClutterMapHeader header{};
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("Clutter map file too small: " + path);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, CLUTTER_MAP_MAGIC, sizeof(CLUTTER_MAP_MAGIC)) != 0) {
+        throw std::runtime_error("Not a clutter map file: " + path);
+    }
+    if (header.version != CLUTTER_MAP_VERSION) {
+        throw std::runtime_error("Unsupported clutter map version " + std::to_string(header.version));
+    }
+    if (header.azimuths != static_cast<uint32_t>(_azimuths) || header.range_bins != static_cast<uint32_t>(_range_bins)) {
+        throw std::runtime_error("Clutter map " + path + " has " + std::to_string(header.azimuths) + " x "
+            + std::to_string(header.range_bins) + " cells, the video " + std::to_string(_azimuths) + " x "
+            + std::to_string(_range_bins));
+    }
+    const size_t bytes = _mean.size() * sizeof(float);
+    if (header.header_size < sizeof(header) || header.header_size + bytes > file.size()) {
+        throw std::runtime_error("Corrupt clutter map: " + path);
+    }
+
+    std::memcpy(_mean.data(), file.data() + header.header_size, bytes);
+    _scans = header.scans;
+    return true;
+}
+
+void ClutterMap::save(const std::string& path) const {
+    ClutterMapHeader header{};
+    std::memcpy(header.magic, CLUTTER_MAP_MAGIC, sizeof(CLUTTER_MAP_MAGIC));
+    header.version = CLUTTER_MAP_VERSION;
+    header.header_size = sizeof(ClutterMapHeader);
+    header.azimuths = static_cast<uint32_t>(_azimuths);
+    header.range_bins = static_cast<uint32_t>(_range_bins);
+    header.scans = _scans;
+
+    const std::string partial = path + ".tmp";
+    {
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Failed to create " + partial);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(_mean.data()), static_cast<std::streamsize>(_mean.size() * sizeof(float)));
+        if (!out) {
+            throw std::runtime_error("Failed to write " + partial);
+        }
+    }
+    std::filesystem::rename(partial, path);
+}
+
+// The test against the map is cell averaging over the scans folded into
+// it: a running mean of k scans is k samples, an exponential average of
+// weight a is worth (2 - a) / a of them.
+void ClutterMap::beginScan() {
+    const double alpha = 1.0 / _config.time_constant;
+    double samples = static_cast<double>(_scans);
+    if (_scans >= _config.time_constant) {
+        samples = (2.0 - alpha) / alpha;
+    }
+    _scale = _scans == 0 ? 0.0f
+        : static_cast<float>(samples * (std::pow(_config.false_alarm_rate, -1.0 / samples) - 1.0));
+    _weight = static_cast<float>(std::max(alpha, 1.0 / (_scans + 1)));
+    ++_scans;
+}
+
+void ClutterMap::update(int spoke, const float* power) {
+    Eigen::Map<Eigen::ArrayXf> mean(_mean.data() + size_t(spoke) * _range_bins, _range_bins);
+    Eigen::Map<const Eigen::ArrayXf> p(power, _range_bins);
+    mean += _weight * (p - mean);
+}
@@ -0,0 +1,475 @@
+#include "history-store.h"
+#include "mapped-file.h"
+#include "slot-map.h"
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+static constexpr uint64_t COLUMN_ALIGN = 8;
+static constexpr double SECTOR_DEG = 360.0 / HISTORY_SECTORS;
+
+static uint64_t columnBytes(size_t count, size_t elem_size) {
+    return (count * elem_size + COLUMN_ALIGN - 1) & ~(COLUMN_ALIGN - 1);
+}
+
+static uint64_t chunkFileBytes(uint64_t count) {
+    return columnBytes(1, sizeof(HistoryChunkHeader))
+        + 4 * columnBytes(count, 4)
+        + columnBytes(HISTORY_SECTORS + 1, sizeof(uint32_t))
+        + columnBytes(count, sizeof(uint32_t));
+}
+
+static int sectorOf(float angle) {
+    int s = static_cast<int>(angle * (HISTORY_SECTORS / (2 * EIGEN_PI)));
+    return std::clamp(s, 0, HISTORY_SECTORS - 1);
+}
+
+static uint64_t sectorMask(double from_deg, double to_deg) {
+    auto span = [](double a, double b) {
+        int first = std::clamp(static_cast<int>(a / SECTOR_DEG), 0, HISTORY_SECTORS - 1);
+        int last = std::clamp(static_cast<int>(b / SECTOR_DEG), 0, HISTORY_SECTORS - 1);
+        uint64_t mask = 0;
+        for (int s = first; s <= last; ++s) {
+            mask |= uint64_t{ 1 } << s;
+        }
+        return mask;
+    };
+    if (from_deg <= to_deg) {
+        return span(from_deg, to_deg);
+    }
+    return span(from_deg, 360.0) | span(0.0, to_deg);
+}
+
+static bool acceptsBearing(double deg, double from_deg, double to_deg) {
+    if (from_deg <= to_deg) {
+        return deg >= from_deg && deg <= to_deg;
+    }
+    return deg >= from_deg || deg <= to_deg;
+}
+
+static bool overlapsTicks(const HistoryChunkHeader& h, uint64_t from_tick, uint64_t to_tick) {
+    return h.count > 0 && h.first_tick <= to_tick && h.last_tick >= from_tick;
+}
+
+// Relative tick bounds of [from_tick, to_tick] inside a chunk.
+static std::pair<uint32_t, uint32_t> relativeTicks(const HistoryChunkHeader& h, uint64_t from_tick, uint64_t to_tick) {
+    uint64_t lo = from_tick > h.first_tick ? from_tick - h.first_tick : 0;
+    uint64_t hi = std::min(to_tick, h.last_tick) - h.first_tick;
+    return { static_cast<uint32_t>(lo), static_cast<uint32_t>(hi) };
+}
+
+HistoryChunkView HistoryChunk::view() const {
+    return { header, ticks.data(), ids.data(), distances.data(), angles.data(), sector_offsets.data(), track_rows.data() };
+}
+
+static HistoryChunkView mapChunk(const MappedFile& file, const std::string& path) {
+    HistoryChunkHeader header;
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("History chunk too small: " + path);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, HISTORY_CHUNK_MAGIC, sizeof(HISTORY_CHUNK_MAGIC)) != 0
+        || header.version != HISTORY_CHUNK_VERSION
+        || header.sectors != HISTORY_SECTORS
+        || file.size() != chunkFileBytes(header.count)) {
+        throw std::runtime_error("Corrupt history chunk: " + path);
+    }
+
+    const size_t n = header.count;
+    const uint8_t* p = file.data() + columnBytes(1, sizeof(HistoryChunkHeader));
+    auto next = [&p](size_t count, size_t elem_size) {
+        const uint8_t* column = p;
+        p += columnBytes(count, elem_size);
+        return column;
+    };
+
+    HistoryChunkView view;
+    view.header = header;
+    view.ticks = reinterpret_cast<const uint32_t*>(next(n, sizeof(uint32_t)));
+    view.ids = reinterpret_cast<const int32_t*>(next(n, sizeof(int32_t)));
+    view.distances = reinterpret_cast<const float*>(next(n, sizeof(float)));
+    view.angles = reinterpret_cast<const float*>(next(n, sizeof(float)));
+    view.sector_offsets = reinterpret_cast<const uint32_t*>(next(HISTORY_SECTORS + 1, sizeof(uint32_t)));
+    view.track_rows = reinterpret_cast<const uint32_t*>(next(n, sizeof(uint32_t)));
+    return view;
+}
+
+HistoryStore::HistoryStore(const HistoryConfig& config) :
+    _config(config)
+{
+    if (_config.chunk_ticks <= 0) {
+        throw std::invalid_argument("History chunk length must be positive");
+    }
+    if (!_config.directory.empty()) {
+        std::filesystem::create_directories(_config.directory);
+    }
+    _open = std::make_shared<HistoryChunk>();
+    _worker = std::thread(&HistoryStore::workLoop, this);
+}
+
+HistoryStore::~HistoryStore() {
+    close();
+}
+
+void HistoryStore::append(const TickSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    HistoryChunkHeader& h = _open->header;
+    if (_open_ticks == 0) {
+        h = {};
+        h.first_tick = snapshot.tick;
+        h.min_distance = std::numeric_limits<float>::max();
+        h.max_distance = 0.0f;
+    }
+
+    const uint32_t rel = static_cast<uint32_t>(snapshot.tick - h.first_tick);
+    const size_t n = snapshot.count;
+    const size_t base = _open->ids.size();
+    _open->ticks.resize(base + n, rel);
+    _open->ids.insert(_open->ids.end(), snapshot.ids.begin(), snapshot.ids.begin() + n);
+    _open->distances.resize(base + n);
+    _open->angles.resize(base + n);
+
+    float* distances = _open->distances.data() + base;
+    float* angles = _open->angles.data() + base;
+    float min_distance = h.min_distance;
+    float max_distance = h.max_distance;
+    uint64_t mask = h.sector_mask;
+    for (size_t i = 0; i < n; ++i) {
+        distances[i] = static_cast<float>(snapshot.distances[i]);
+        angles[i] = static_cast<float>(snapshot.angles[i]);
+        min_distance = std::min(min_distance, distances[i]);
+        max_distance = std::max(max_distance, distances[i]);
+        mask |= uint64_t{ 1 } << sectorOf(angles[i]);
+    }
+    h.min_distance = min_distance;
+    h.max_distance = max_distance;
+    h.sector_mask = mask;
+    h.last_tick = snapshot.tick;
+    h.count = _open->ids.size();
+
+    // Full chunks are indexed off the simulation thread; until then queries
+    // scan them in tick order like the open chunk.
+    if (++_open_ticks >= _config.chunk_ticks) {
+        const size_t expected = _open->ids.size();
+        _unsealed.push_back(std::move(_open));
+        _cv.notify_one();
+
+        if (_spare) {
+            _open = std::move(_spare);
+        }
+        else {
+            _open = std::make_shared<HistoryChunk>();
+        }
+        _open->ticks.reserve(expected);
+        _open->ids.reserve(expected);
+        _open->distances.reserve(expected);
+        _open->angles.reserve(expected);
+        _open_ticks = 0;
+    }
+}
+
+static std::shared_ptr<HistoryChunk> sealChunk(const HistoryChunk& raw) {
+    const size_t n = raw.ids.size();
+    auto chunk = std::make_shared<HistoryChunk>();
+    chunk->header = raw.header;
+    std::memcpy(chunk->header.magic, HISTORY_CHUNK_MAGIC, sizeof(HISTORY_CHUNK_MAGIC));
+    chunk->header.version = HISTORY_CHUNK_VERSION;
+    chunk->header.sectors = HISTORY_SECTORS;
+    chunk->ticks.resize(n);
+    chunk->ids.resize(n);
+    chunk->distances.resize(n);
+    chunk->angles.resize(n);
+    chunk->track_rows.resize(n);
+
+    // Counting sorts are stable, so rows keep tick order within a sector
+    // and within a track.
+    std::vector<uint8_t> sector(n);
+    auto& offsets = chunk->sector_offsets;
+    offsets.fill(0);
+    for (size_t i = 0; i < n; ++i) {
+        sector[i] = static_cast<uint8_t>(sectorOf(raw.angles[i]));
+        ++offsets[sector[i] + 1];
+    }
+    for (int s = 0; s < HISTORY_SECTORS; ++s) {
+        offsets[s + 1] += offsets[s];
+    }
+
+    std::array<uint32_t, HISTORY_SECTORS> fill;
+    std::copy_n(offsets.begin(), HISTORY_SECTORS, fill.begin());
+    std::vector<uint32_t> sealed_row(n);
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t r = fill[sector[i]]++;
+        sealed_row[i] = r;
+        chunk->ticks[r] = raw.ticks[i];
+        chunk->ids[r] = raw.ids[i];
+        chunk->distances[r] = raw.distances[i];
+        chunk->angles[r] = raw.angles[i];
+    }
+
+    uint32_t max_slot = 0;
+    for (size_t i = 0; i < n; ++i) {
+        max_slot = std::max(max_slot, slotIndex(raw.ids[i]));
+    }
+    std::vector<uint32_t> slot_fill(n > 0 ? max_slot + 2 : 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ++slot_fill[slotIndex(raw.ids[i]) + 1];
+    }
+    for (size_t s = 1; s < slot_fill.size(); ++s) {
+        slot_fill[s] += slot_fill[s - 1];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        chunk->track_rows[slot_fill[slotIndex(raw.ids[i])]++] = sealed_row[i];
+    }
+    return chunk;
+}
+
+void HistoryStore::close() {
+    if (!_worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closing = true;
+    }
+    _cv.notify_one();
+    _worker.join();
+}
+
+void HistoryStore::workLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cv.wait(lock, [this] {
+            return _closing || !_unsealed.empty();
+        });
+        if (_unsealed.empty()) {
+            return;
+        }
+
+        std::shared_ptr<const HistoryChunk> raw = _unsealed.front();
+        lock.unlock();
+        auto chunk = sealChunk(*raw);
+        lock.lock();
+
+        _unsealed.pop_front();
+        _memory.push_back(chunk);
+        while (_memory.size() > _config.memory_chunks) {
+            _memory.pop_front();
+        }
+
+        // Recycle the raw buffers unless a query is still scanning them.
+        if (raw.use_count() == 1 && !_spare) {
+            auto spare = std::const_pointer_cast<HistoryChunk>(raw);
+            spare->ticks.clear();
+            spare->ids.clear();
+            spare->distances.clear();
+            spare->angles.clear();
+            _spare = std::move(spare);
+        }
+        raw.reset();
+
+        if (!_config.directory.empty()) {
+            lock.unlock();
+            writeChunk(*chunk);
+            lock.lock();
+        }
+    }
+}
+
+void HistoryStore::writeChunk(const HistoryChunk& chunk) {
+    const std::string path = (std::filesystem::path(_config.directory)
+        / ("history-" + std::to_string(chunk.header.first_tick) + ".chunk")).string();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    auto writeColumn = [&out](const void* data, size_t bytes) {
+        static const char zeros[COLUMN_ALIGN] = {};
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        out.write(zeros, static_cast<std::streamsize>(columnBytes(bytes, 1) - bytes));
+    };
+
+    const size_t n = chunk.header.count;
+    writeColumn(&chunk.header, sizeof(chunk.header));
+    writeColumn(chunk.ticks.data(), n * sizeof(uint32_t));
+    writeColumn(chunk.ids.data(), n * sizeof(int32_t));
+    writeColumn(chunk.distances.data(), n * sizeof(float));
+    writeColumn(chunk.angles.data(), n * sizeof(float));
+    writeColumn(chunk.sector_offsets.data(), chunk.sector_offsets.size() * sizeof(uint32_t));
+    writeColumn(chunk.track_rows.data(), n * sizeof(uint32_t));
+    out.close();
+
+    if (!out) {
+        std::cerr << "Failed to write history chunk " << path << std::endl;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _disk.push_back({ chunk.header, path });
+    while (_disk.size() > _config.disk_chunks) {
+        std::error_code ec;
+        std::filesystem::remove(_disk.front().path, ec);
+        _disk.pop_front();
+    }
+}
+
+template<typename AcceptRow>
+static void scanRaw(const HistoryChunk& raw, uint64_t from_tick, uint64_t to_tick, AcceptRow&& accept, std::vector<HistoryRecord>& out) {
+    if (!overlapsTicks(raw.header, from_tick, to_tick)) {
+        return;
+    }
+    const auto [lo, hi] = relativeTicks(raw.header, from_tick, to_tick);
+    auto first = std::lower_bound(raw.ticks.begin(), raw.ticks.end(), lo);
+    for (size_t i = first - raw.ticks.begin(); i < raw.ticks.size() && raw.ticks[i] <= hi; ++i) {
+        if (accept(raw.ids[i], raw.distances[i], raw.angles[i])) {
+            out.push_back({ raw.header.first_tick + raw.ticks[i], raw.ids[i], raw.distances[i], raw.angles[i] });
+        }
+    }
+}
+
+// Chunks are visited oldest first: disk chunks older than anything still in
+// memory, sealed memory chunks, chunks waiting to be sealed, then the open
+// chunk. Each chunk's matches go to the sink as one batch, so the first
+// results leave before the last chunk is read.
+template<typename CollectSealed, typename AcceptRow>
+size_t HistoryStore::query(
+    uint64_t from_tick,
+    uint64_t to_tick,
+    const HistorySink& sink,
+    CollectSealed&& collect,
+    AcceptRow&& accept
+) const {
+    std::vector<DiskChunk> disk;
+    std::vector<std::shared_ptr<const HistoryChunk>> memory;
+    std::vector<std::shared_ptr<const HistoryChunk>> unsealed;
+    std::vector<HistoryRecord> open_batch;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        uint64_t memory_first = _open_ticks > 0 ? _open->header.first_tick : std::numeric_limits<uint64_t>::max();
+        if (!_unsealed.empty()) {
+            memory_first = _unsealed.front()->header.first_tick;
+        }
+        if (!_memory.empty()) {
+            memory_first = _memory.front()->header.first_tick;
+        }
+
+        for (const auto& d : _disk) {
+            if (d.header.last_tick < memory_first && overlapsTicks(d.header, from_tick, to_tick)) {
+                disk.push_back(d);
+            }
+        }
+        for (const auto& c : _memory) {
+            if (overlapsTicks(c->header, from_tick, to_tick)) {
+                memory.push_back(c);
+            }
+        }
+        for (const auto& c : _unsealed) {
+            if (overlapsTicks(c->header, from_tick, to_tick)) {
+                unsealed.push_back(c);
+            }
+        }
+        if (_open_ticks > 0) {
+            scanRaw(*_open, from_tick, to_tick, accept, open_batch);
+        }
+    }
+
+    size_t total = 0;
+    std::vector<HistoryRecord> batch;
+    auto emit = [&](std::vector<HistoryRecord>& records) {
+        if (!records.empty()) {
+            total += records.size();
+            sink(records);
+            records.clear();
+        }
+    };
+
+    for (const auto& d : disk) {
+        try {
+            MappedFile file(d.path);
+            collect(mapChunk(file, d.path), batch);
+            emit(batch);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "History query skipped chunk: " << e.what() << std::endl;
+        }
+    }
+    for (const auto& c : memory) {
+        collect(c->view(), batch);
+        emit(batch);
+    }
+    for (const auto& c : unsealed) {
+        scanRaw(*c, from_tick, to_tick, accept, batch);
+        emit(batch);
+    }
+    emit(open_batch);
+    return total;
+}
+
+size_t HistoryStore::queryRegion(const HistoryRegion& region, const HistorySink& sink) const {
+    const uint64_t mask = sectorMask(region.from_deg, region.to_deg);
+    const double deg_per_rad = 180.0 / EIGEN_PI;
+
+    auto accept = [&](int32_t, float distance, float angle) {
+        return distance >= region.min_distance && distance <= region.max_distance
+            && acceptsBearing(angle * deg_per_rad, region.from_deg, region.to_deg);
+    };
+
+    auto collect = [&](const HistoryChunkView& v, std::vector<HistoryRecord>& out) {
+        if (v.header.max_distance < region.min_distance || v.header.min_distance > region.max_distance) {
+            return;
+        }
+        const uint64_t sectors = mask & v.header.sector_mask;
+        if (sectors == 0) {
+            return;
+        }
+
+        const auto [lo, hi] = relativeTicks(v.header, region.from_tick, region.to_tick);
+        for (int s = 0; s < HISTORY_SECTORS; ++s) {
+            if (!(sectors >> s & 1)) {
+                continue;
+            }
+            const uint32_t* begin = v.ticks + v.sector_offsets[s];
+            const uint32_t* end = v.ticks + v.sector_offsets[s + 1];
+            const uint32_t* first = std::lower_bound(begin, end, lo);
+            const uint32_t* last = std::upper_bound(first, end, hi);
+            for (size_t r = first - v.ticks; r < static_cast<size_t>(last - v.ticks); ++r) {
+                if (accept(v.ids[r], v.distances[r], v.angles[r])) {
+                    out.push_back({ v.header.first_tick + v.ticks[r], v.ids[r], v.distances[r], v.angles[r] });
+                }
+            }
+        }
+    };
+
+    return query(region.from_tick, region.to_tick, sink, collect, accept);
+}
+
+size_t HistoryStore::queryTrack(int id, uint64_t from_tick, uint64_t to_tick, const HistorySink& sink) const {
+    const uint32_t slot = slotIndex(id);
+
+    auto accept = [id](int32_t row_id, float, float) {
+        return row_id == id;
+    };
+
+    auto collect = [&](const HistoryChunkView& v, std::vector<HistoryRecord>& out) {
+        const uint32_t* begin = v.track_rows;
+        const uint32_t* end = v.track_rows + v.header.count;
+        auto bySlot = [&v](uint32_t row, uint32_t key) {
+            return slotIndex(v.ids[row]) < key;
+        };
+        const uint32_t* first = std::lower_bound(begin, end, slot, bySlot);
+
+        const auto [lo, hi] = relativeTicks(v.header, from_tick, to_tick);
+        for (const uint32_t* it = first; it != end && slotIndex(v.ids[*it]) == slot; ++it) {
+            const uint32_t r = *it;
+            if (v.ids[r] == id && v.ticks[r] >= lo && v.ticks[r] <= hi) {
+                out.push_back({ v.header.first_tick + v.ticks[r], v.ids[r], v.distances[r], v.angles[r] });
+            }
+        }
+    };
+
+    return query(from_tick, to_tick, sink, collect, accept);
+}
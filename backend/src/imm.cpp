@@ -0,0 +1,438 @@
+#include "imm.h"
+#include "tracker.h"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+using Column = Eigen::Map<Eigen::ArrayXd>;
+using BlockArray = Eigen::Array<double, Eigen::Dynamic, 1, Eigen::ColMajor, KALMAN_BLOCK, 1>;
+
+constexpr int STRAIGHT = 0;
+constexpr int TURNING = 1;
+
+Column segment(std::vector<double>& column, size_t begin, Eigen::Index length) {
+    return Column(column.data() + begin, length);
+}
+
+template<typename... Columns>
+void swapOut(size_t index, size_t last, Columns&... columns) {
+    ((columns[index] = columns[last], columns.pop_back()), ...);
+}
+
+// a = sin(wt) / w and b = (1 - cos(wt)) / w with their derivatives in w;
+// near w = 0 the closed forms cancel, so a short series is used instead.
+void turnTerms(double w, double dt, double& a, double& b, double& da, double& db) {
+    const double wt = w * dt;
+    if (std::abs(wt) < 1e-4) {
+        a = dt * (1.0 - wt * wt / 6);
+        b = dt * wt / 2;
+        da = -w * dt * dt * dt / 3;
+        db = dt * dt / 2;
+        return;
+    }
+    const double s = std::sin(wt);
+    const double c = std::cos(wt);
+    a = s / w;
+    b = (1.0 - c) / w;
+    da = (dt * c - a) / w;
+    db = (dt * s - b) / w;
+}
+
+}
+
+ImmBank::ImmBank(const ImmConfig& config) :
+    _config(config)
+{
+    if (config.switch_probability <= 0.0 || config.switch_probability >= 1.0) {
+        throw std::invalid_argument("Model switch probability must be within (0, 1)");
+    }
+    if (config.cv_process_noise < 0.0 || config.ct_process_noise < 0.0 || config.turn_noise < 0.0) {
+        throw std::invalid_argument("Process noise must not be negative");
+    }
+}
+
+uint32_t ImmBank::add(int id, const Vector& state, const Matrix& covariance) {
+    const uint32_t index = static_cast<uint32_t>(_ids.size());
+    const double turn_variance = _config.initial_turn_sigma * _config.initial_turn_sigma;
+    _ids.push_back(id);
+    for (int m = 0; m < MODELS; ++m) {
+        Model& model = _models[m];
+        for (int i = 0; i < STATE; ++i) {
+            model.x[i].push_back(i < TURN ? state(i) : 0.0);
+            for (int j = i; j < STATE; ++j) {
+                double value = 0.0;
+                if (j < TURN) {
+                    value = covariance(i, j);
+                }
+                else if (i == TURN && m == TURNING) {
+                    value = turn_variance;
+                }
+                model.p[sym(i, j)].push_back(value);
+            }
+        }
+        model.probability.push_back(1.0 / MODELS);
+    }
+    _zx.push_back(0.0);
+    _zy.push_back(0.0);
+    _rxx.push_back(1.0);
+    _rxy.push_back(0.0);
+    _ryy.push_back(1.0);
+    _has_measurement.push_back(0.0);
+    return index;
+}
+
+int ImmBank::remove(uint32_t index) {
+    const size_t last = _ids.size() - 1;
+    swapOut(index, last, _ids, _zx, _zy, _rxx, _rxy, _ryy, _has_measurement);
+    for (Model& model : _models) {
+        for (auto& column : model.x) {
+            swapOut(index, last, column);
+        }
+        for (auto& column : model.p) {
+            swapOut(index, last, column);
+        }
+        swapOut(index, last, model.probability);
+    }
+    return index < _ids.size() ? _ids[index] : -1;
+}
+
+void ImmBank::clear() {
+    _ids.clear();
+    for (Model& model : _models) {
+        for (auto& column : model.x) {
+            column.clear();
+        }
+        for (auto& column : model.p) {
+            column.clear();
+        }
+        model.probability.clear();
+    }
+    _zx.clear();
+    _zy.clear();
+    _rxx.clear();
+    _rxy.clear();
+    _ryy.clear();
+    _has_measurement.clear();
+    _pending = false;
+}
+
+void ImmBank::predict(double dt) {
+    mix();
+    predictStraight(dt);
+    predictTurn(dt);
+}
+
+// Each model restarts from the mixture of all models, weighted by the
+// chance that the track was in model i and switched to model j:
+//   c_j = sum_i pi_ij mu_i,  w_ij = pi_ij mu_i / c_j,
+//   x_j = sum_i w_ij x_i,    P_j = sum_i w_ij (P_i + (x_i - x_j)(x_i - x_j)').
+// c_j becomes the predicted model probability.
+void ImmBank::mix() {
+    const double stay = 1.0 - _config.switch_probability;
+    const double leave = _config.switch_probability / (MODELS - 1);
+    const size_t n = _ids.size();
+
+    std::array<BlockArray, MODELS> predicted;
+    std::array<std::array<BlockArray, MODELS>, MODELS> weights;
+    std::array<std::array<BlockArray, STATE>, MODELS> next_x;
+    std::array<std::array<BlockArray, COVARIANCE>, MODELS> next_p;
+
+    for (size_t begin = 0; begin < n; begin += KALMAN_BLOCK) {
+        const Eigen::Index length = static_cast<Eigen::Index>(std::min(KALMAN_BLOCK, n - begin));
+        auto mu = [&](int m) {
+            return segment(_models[m].probability, begin, length);
+        };
+        auto x = [&](int m, int k) {
+            return segment(_models[m].x[k], begin, length);
+        };
+
+        for (int j = 0; j < MODELS; ++j) {
+            predicted[j].setZero(length);
+            for (int i = 0; i < MODELS; ++i) {
+                predicted[j] += (i == j ? stay : leave) * mu(i);
+            }
+            for (int i = 0; i < MODELS; ++i) {
+                weights[j][i] = (i == j ? stay : leave) * mu(i) / predicted[j];
+            }
+        }
+
+        for (int j = 0; j < MODELS; ++j) {
+            for (int k = 0; k < STATE; ++k) {
+                next_x[j][k].setZero(length);
+                for (int i = 0; i < MODELS; ++i) {
+                    next_x[j][k] += weights[j][i] * x(i, k);
+                }
+            }
+            for (int k = 0; k < STATE; ++k) {
+                for (int l = k; l < STATE; ++l) {
+                    const int u = sym(k, l);
+                    next_p[j][u].setZero(length);
+                    for (int i = 0; i < MODELS; ++i) {
+                        next_p[j][u] += weights[j][i] * (segment(_models[i].p[u], begin, length)
+                            + (x(i, k) - next_x[j][k]) * (x(i, l) - next_x[j][l]));
+                    }
+                }
+            }
+        }
+
+        for (int j = 0; j < MODELS; ++j) {
+            mu(j) = predicted[j];
+            for (int k = 0; k < STATE; ++k) {
+                x(j, k) = next_x[j][k];
+            }
+            for (int u = 0; u < COVARIANCE; ++u) {
+                segment(_models[j].p[u], begin, length) = next_p[j][u];
+            }
+        }
+    }
+}
+
+// Constant velocity with the turn rate pinned to zero; linear, so it runs
+// the same expanded F P F' as KalmanBank::predict.
+void ImmBank::predictStraight(double dt) {
+    FullMatrix f = FullMatrix::Zero();
+    f.topLeftCorner<4, 4>() = KalmanBank::transition(dt);
+    FullMatrix q = FullMatrix::Zero();
+    q.topLeftCorner<4, 4>() = KalmanBank::processNoise(dt, _config.cv_process_noise);
+
+    std::array<std::array<double, COVARIANCE>, COVARIANCE> weights{};
+    for (int i = 0; i < STATE; ++i) {
+        for (int j = i; j < STATE; ++j) {
+            for (int k = 0; k < STATE; ++k) {
+                for (int l = 0; l < STATE; ++l) {
+                    weights[sym(i, j)][sym(k, l)] += f(i, k) * f(j, l);
+                }
+            }
+        }
+    }
+
+    Model& model = _models[STRAIGHT];
+    const size_t n = _ids.size();
+    std::array<BlockArray, STATE> next_x;
+    std::array<BlockArray, COVARIANCE> next_p;
+
+    for (size_t begin = 0; begin < n; begin += KALMAN_BLOCK) {
+        const Eigen::Index length = static_cast<Eigen::Index>(std::min(KALMAN_BLOCK, n - begin));
+
+        for (int i = 0; i < STATE; ++i) {
+            next_x[i].setZero(length);
+            for (int k = 0; k < STATE; ++k) {
+                if (f(i, k) != 0.0) {
+                    next_x[i] += f(i, k) * segment(model.x[k], begin, length);
+                }
+            }
+        }
+        for (int i = 0; i < STATE; ++i) {
+            for (int j = i; j < STATE; ++j) {
+                const int u = sym(i, j);
+                next_p[u].setConstant(length, q(i, j));
+                for (int source = 0; source < COVARIANCE; ++source) {
+                    if (weights[u][source] != 0.0) {
+                        next_p[u] += weights[u][source] * segment(model.p[source], begin, length);
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < STATE; ++i) {
+            segment(model.x[i], begin, length) = next_x[i];
+        }
+        for (int u = 0; u < COVARIANCE; ++u) {
+            segment(model.p[u], begin, length) = next_p[u];
+        }
+    }
+}
+
+// Coordinated turn, extended Kalman prediction. The Jacobian depends on each
+// track's own velocity and turn rate, so this one goes track by track.
+void ImmBank::predictTurn(double dt) {
+    FullMatrix q = FullMatrix::Zero();
+    q.topLeftCorner<4, 4>() = KalmanBank::processNoise(dt, _config.ct_process_noise);
+    q(TURN, TURN) = _config.turn_noise * dt;
+
+    Model& model = _models[TURNING];
+    const uint32_t n = static_cast<uint32_t>(_ids.size());
+    for (uint32_t index = 0; index < n; ++index) {
+        const FullVector x = modelState(TURNING, index);
+        const FullMatrix p = modelCovariance(TURNING, index);
+        const double vx = x(2);
+        const double vy = x(3);
+        const double w = x(TURN);
+        const double s = std::sin(w * dt);
+        const double c = std::cos(w * dt);
+        double a, b, da, db;
+        turnTerms(w, dt, a, b, da, db);
+
+        FullMatrix f = FullMatrix::Identity();
+        f(0, 2) = a;
+        f(0, 3) = -b;
+        f(0, TURN) = da * vx - db * vy;
+        f(1, 2) = b;
+        f(1, 3) = a;
+        f(1, TURN) = db * vx + da * vy;
+        f(2, 2) = c;
+        f(2, 3) = -s;
+        f(2, TURN) = -dt * (s * vx + c * vy);
+        f(3, 2) = s;
+        f(3, 3) = c;
+        f(3, TURN) = dt * (c * vx - s * vy);
+
+        model.x[0][index] = x(0) + a * vx - b * vy;
+        model.x[1][index] = x(1) + b * vx + a * vy;
+        model.x[2][index] = c * vx - s * vy;
+        model.x[3][index] = s * vx + c * vy;
+
+        const FullMatrix next = f * p * f.transpose() + q;
+        for (int i = 0; i < STATE; ++i) {
+            for (int j = i; j < STATE; ++j) {
+                model.p[sym(i, j)][index] = next(i, j);
+            }
+        }
+    }
+}
+
+void ImmBank::setMeasurement(uint32_t index, double x, double y, double rxx, double rxy, double ryy) {
+    _zx[index] = x;
+    _zy[index] = y;
+    _rxx[index] = rxx;
+    _rxy[index] = rxy;
+    _ryy[index] = ryy;
+    _has_measurement[index] = 1.0;
+    _pending = true;
+}
+
+// Per model the same masked update as KalmanBank::update, then the model
+// probabilities are reweighted by each model's measurement likelihood.
+// Likelihoods are taken relative to the best model, so a plot far from
+// every prediction cannot underflow them all to zero.
+void ImmBank::update() {
+    if (!_pending) {
+        return;
+    }
+
+    const size_t n = _ids.size();
+    std::array<BlockArray, STATE> gain0;
+    std::array<BlockArray, STATE> gain1;
+    std::array<BlockArray, STATE> row0;
+    std::array<BlockArray, STATE> row1;
+    std::array<BlockArray, MODELS> distance;
+    std::array<BlockArray, MODELS> determinant;
+
+    for (size_t begin = 0; begin < n; begin += KALMAN_BLOCK) {
+        const Eigen::Index length = static_cast<Eigen::Index>(std::min(KALMAN_BLOCK, n - begin));
+        const Column has = segment(_has_measurement, begin, length);
+
+        for (int m = 0; m < MODELS; ++m) {
+            Model& model = _models[m];
+            auto p = [&](int i, int j) {
+                return segment(model.p[sym(i, j)], begin, length);
+            };
+
+            const BlockArray s00 = p(0, 0) + segment(_rxx, begin, length);
+            const BlockArray s01 = p(0, 1) + segment(_rxy, begin, length);
+            const BlockArray s11 = p(1, 1) + segment(_ryy, begin, length);
+            determinant[m] = s00 * s11 - s01 * s01;
+            const BlockArray i00 = s11 / determinant[m];
+            const BlockArray i01 = -s01 / determinant[m];
+            const BlockArray i11 = s00 / determinant[m];
+
+            const BlockArray y0 = segment(_zx, begin, length) - segment(model.x[0], begin, length);
+            const BlockArray y1 = segment(_zy, begin, length) - segment(model.x[1], begin, length);
+            distance[m] = y0 * y0 * i00 + 2.0 * y0 * y1 * i01 + y1 * y1 * i11;
+
+            for (int k = 0; k < STATE; ++k) {
+                row0[k] = p(0, k);
+                row1[k] = p(1, k);
+                gain0[k] = has * (row0[k] * i00 + row1[k] * i01);
+                gain1[k] = has * (row0[k] * i01 + row1[k] * i11);
+            }
+            for (int k = 0; k < STATE; ++k) {
+                segment(model.x[k], begin, length) += gain0[k] * y0 + gain1[k] * y1;
+            }
+            for (int k = 0; k < STATE; ++k) {
+                for (int l = k; l < STATE; ++l) {
+                    p(k, l) -= gain0[k] * row0[l] + gain1[k] * row1[l];
+                }
+            }
+        }
+
+        BlockArray nearest = distance[0];
+        for (int m = 1; m < MODELS; ++m) {
+            nearest = nearest.min(distance[m]);
+        }
+        BlockArray total = BlockArray::Zero(length);
+        for (int m = 0; m < MODELS; ++m) {
+            const BlockArray likelihood = (-0.5 * (distance[m] - nearest)).exp() / determinant[m].sqrt();
+            Column mu = segment(_models[m].probability, begin, length);
+            mu *= has * likelihood + (1.0 - has);
+            total += mu;
+        }
+        for (int m = 0; m < MODELS; ++m) {
+            segment(_models[m].probability, begin, length) /= total;
+        }
+    }
+
+    std::fill(_has_measurement.begin(), _has_measurement.end(), 0.0);
+    std::fill(_rxx.begin(), _rxx.end(), 1.0);
+    std::fill(_rxy.begin(), _rxy.end(), 0.0);
+    std::fill(_ryy.begin(), _ryy.end(), 1.0);
+    _pending = false;
+}
+
+ImmBank::FullVector ImmBank::modelState(int model, uint32_t index) const {
+    FullVector x;
+    for (int i = 0; i < STATE; ++i) {
+        x(i) = _models[model].x[i][index];
+    }
+    return x;
+}
+
+ImmBank::FullMatrix ImmBank::modelCovariance(int model, uint32_t index) const {
+    FullMatrix p;
+    for (int i = 0; i < STATE; ++i) {
+        for (int j = 0; j < STATE; ++j) {
+            p(i, j) = _models[model].p[sym(i, j)][index];
+        }
+    }
+    return p;
+}
+
+void ImmBank::combine(uint32_t index, FullVector& x, FullMatrix& p) const {
+    x.setZero();
+    for (int m = 0; m < MODELS; ++m) {
+        x += _models[m].probability[index] * modelState(m, index);
+    }
+    p.setZero();
+    for (int m = 0; m < MODELS; ++m) {
+        const FullVector spread = modelState(m, index) - x;
+        p += _models[m].probability[index] * (modelCovariance(m, index) + spread * spread.transpose());
+    }
+}
+
+ImmBank::Vector ImmBank::state(uint32_t index) const {
+    FullVector x;
+    FullMatrix p;
+    combine(index, x, p);
+    return x.head<4>();
+}
+
+ImmBank::Matrix ImmBank::covariance(uint32_t index) const {
+    FullVector x;
+    FullMatrix p;
+    combine(index, x, p);
+    return p.topLeftCorner<4, 4>();
+}
+
+double ImmBank::turnRate(uint32_t index) const {
+    double w = 0.0;
+    for (int m = 0; m < MODELS; ++m) {
+        w += _models[m].probability[index] * _models[m].x[TURN][index];
+    }
+    return w;
+}
+
+double ImmBank::modelProbability(uint32_t index, int model) const {
+    return _models[model].probability[index];
+}
@@ -1,12 +1,367 @@
 #include "network-server.h"
+#include "scenario.h"
+#include "tick-log.h"
+#include "history-store.h"
+#include "tracker.h"
+#include "sensor.h"
+#include "video.h"
+#include "cfar.h"
+#include "clutter-map.h"
+#include "occlusion.h"
+#include "alarms.h"
 #include <iostream>
 #include <thread>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <random>
+#include <memory>
+#include <algorithm>
+#include <chrono>
 
-int main() {
+constexpr int DEFAULT_VIDEO_SWEEP_SECTORS = 36;
+
+struct ServerOptions {
+    LifecycleConfig lifecycle;
+    size_t initial_targets = 0;
+    uint64_t seed = 0;
+    bool has_seed = false;
+    bool has_max_targets = false;
+    std::string scenario_path;
+    std::string record_path;
+    std::string replay_path;
+    double replay_speed = 1.0;
+    uint64_t replay_from = 0;
+    HistoryConfig history;
+    bool history_enabled = false;
+    MotionConfig motion;
+    TrackerConfig tracker;
+    AssociationConfig association;
+    bool tracking = false;
+    SensorConfig sensor;
+    bool sensing = false;
+    VideoConfig video;
+    bool video_enabled = false;
+    std::string obstacles_path;
+    std::string alarms_path;
+    CfarConfig cfar;
+    bool detecting = false;
+    ClutterMapConfig clutter_map;
+    bool clutter_mapping = false;
+    int sweep_sectors = 0;
+    unsigned threads = 0;
+};
+
+static std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        if (end > begin) {
+            items.push_back(list.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+    return items;
+}
+
+static double degrees(const std::string& value) {
+    return std::stod(value) * EIGEN_PI / 180.0;
+}
+
+static ServerOptions parseArgs(int argc, char** argv) {
+    ServerOptions opts;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--spawn-every") {
+            opts.lifecycle.spawn_interval_ticks = std::stoi(value());
+        }
+        else if (arg == "--max-targets") {
+            opts.lifecycle.max_targets = std::stoul(value());
+            opts.has_max_targets = true;
+        }
+        else if (arg == "--max-age") {
+            opts.lifecycle.max_age_ticks = std::stoi(value());
+        }
+        else if (arg == "--keep-outside") {
+            opts.lifecycle.despawn_outside_coverage = false;
+        }
+        else if (arg == "--seed") {
+            opts.seed = std::stoull(value());
+            opts.has_seed = true;
+        }
+        else if (arg == "--scenario") {
+            opts.scenario_path = value();
+        }
+        else if (arg == "--spawn") {
+            opts.initial_targets = std::stoul(value());
+        }
+        else if (arg == "--record") {
+            opts.record_path = value();
+        }
+        else if (arg == "--replay") {
+            opts.replay_path = value();
+        }
+        else if (arg == "--replay-speed") {
+            opts.replay_speed = std::stod(value());
+        }
+        else if (arg == "--replay-from") {
+            opts.replay_from = std::stoull(value());
+        }
+        else if (arg == "--history-chunk-ticks") {
+            opts.history.chunk_ticks = std::stoi(value());
+        }
+        else if (arg == "--history-chunks") {
+            opts.history.memory_chunks = std::stoul(value());
+        }
+        else if (arg == "--history-dir") {
+            opts.history.directory = value();
+        }
+        else if (arg == "--history-disk-chunks") {
+            opts.history.disk_chunks = std::stoul(value());
+        }
+        else if (arg == "--history") {
+            opts.history_enabled = true;
+        }
+        else if (arg == "--motion") {
+            opts.motion.models.clear();
+            for (const auto& name : splitList(value())) {
+                opts.motion.models.push_back(parseMotionModel(name));
+            }
+        }
+        else if (arg == "--speed") {
+            auto range = splitList(value());
+            if (range.empty() || range.size() > 2) {
+                throw std::runtime_error("--speed expects min[,max]");
+            }
+            opts.motion.min_speed = std::stod(range.front());
+            opts.motion.max_speed = std::stod(range.back());
+        }
+        else if (arg == "--turn-rate") {
+            opts.motion.max_turn_rate = degrees(value());
+        }
+        else if (arg == "--acceleration") {
+            opts.motion.max_acceleration = std::stod(value());
+        }
+        else if (arg == "--track") {
+            opts.tracking = true;
+        }
+        else if (arg == "--track-model") {
+            opts.tracker.model = parseTrackModel(value());
+        }
+        else if (arg == "--track-sigma") {
+            opts.tracker.measurement_sigma = std::stod(value());
+        }
+        else if (arg == "--track-noise") {
+            opts.tracker.process_noise = std::stod(value());
+        }
+        else if (arg == "--gate") {
+            opts.association.gate = std::stod(value());
+        }
+        else if (arg == "--sensor") {
+            opts.sensing = true;
+        }
+        else if (arg == "--range-sigma") {
+            opts.sensor.range_sigma = std::stod(value());
+        }
+        else if (arg == "--bearing-sigma") {
+            opts.sensor.bearing_sigma = degrees(value());
+        }
+        else if (arg == "--pd") {
+            opts.sensor.detection_probability = std::stod(value());
+        }
+        else if (arg == "--clutter") {
+            opts.sensor.clutter_rate = std::stod(value());
+        }
+        else if (arg == "--obstacles") {
+            opts.obstacles_path = value();
+        }
+        else if (arg == "--alarms") {
+            opts.alarms_path = value();
+        }
+        else if (arg == "--video") {
+            opts.video_enabled = true;
+        }
+        else if (arg == "--azimuths") {
+            opts.video.azimuths = std::stoi(value());
+        }
+        else if (arg == "--range-bins") {
+            opts.video.range_bins = std::stoi(value());
+        }
+        else if (arg == "--target-snr") {
+            opts.video.target_snr = std::stod(value());
+        }
+        else if (arg == "--clutter-cnr") {
+            opts.video.clutter_cnr = std::stod(value());
+        }
+        else if (arg == "--cfar") {
+            opts.cfar.method = parseCfarMethod(value());
+            opts.detecting = true;
+            opts.video_enabled = true;
+        }
+        else if (arg == "--pfa") {
+            opts.cfar.false_alarm_rate = std::stod(value());
+        }
+        else if (arg == "--clutter-map") {
+            opts.clutter_mapping = true;
+        }
+        else if (arg == "--clutter-map-file") {
+            opts.clutter_map.path = value();
+            opts.clutter_mapping = true;
+        }
+        else if (arg == "--map-scans") {
+            opts.clutter_map.time_constant = std::stod(value());
+        }
+        else if (arg == "--sweep") {
+            opts.sweep_sectors = std::stoi(value());
+        }
+        else if (arg == "--threads") {
+            opts.threads = static_cast<unsigned>(std::stoul(value()));
+        }
+        else if (arg == "--max-turn") {
+            opts.motion.random_walk_turn = degrees(value());
+        }
+        else {
+            throw std::runtime_error("Unknown argument: " + arg);
+        }
+    }
+
+    return opts;
+}
+
+static uint64_t randomSeed() {
+    std::random_device rd;
+    return (uint64_t{ rd() } << 32) | rd();
+}
+
+int main(int argc, char** argv) {
     try {
+        ServerOptions opts = parseArgs(argc, argv);
+        if (opts.detecting && opts.sensing) {
+            throw std::runtime_error("--cfar replaces --sensor as the source of plots");
+        }
+        if (opts.clutter_mapping && !opts.detecting) {
+            throw std::runtime_error("--clutter-map needs --cfar");
+        }
+        if (!opts.obstacles_path.empty() && !opts.sensing && !opts.video_enabled) {
+            throw std::runtime_error("--obstacles needs --sensor, --video or --cfar");
+        }
+
+        std::unique_ptr<TickLog> replay_log;
+        if (!opts.replay_path.empty()) {
+            if (!opts.scenario_path.empty() || opts.initial_targets > 0 || !opts.record_path.empty() || opts.tracking
+                || opts.sensing || opts.video_enabled || opts.sweep_sectors > 0) {
+                throw std::runtime_error(
+                    "--replay cannot be combined with --scenario, --spawn, --record, --sensor, --video, --track or --sweep");
+            }
+            replay_log = std::make_unique<TickLog>(opts.replay_path);
+            if (!opts.has_seed) {
+                opts.seed = replay_log->seed();
+                opts.has_seed = true;
+            }
+        }
+
+        // Video is streamed spoke by spoke as the beam sweeps, so it always
+        // runs with a sweep.
+        if (opts.video_enabled && opts.sweep_sectors == 0) {
+            opts.sweep_sectors = DEFAULT_VIDEO_SWEEP_SECTORS;
+            std::cout << "Video sweeps the beam in " << opts.sweep_sectors << " sectors" << std::endl;
+        }
+
+        std::unique_ptr<Scenario> scenario;
+        if (!opts.scenario_path.empty()) {
+            scenario = std::make_unique<Scenario>(opts.scenario_path);
+            if (!opts.has_max_targets) {
+                opts.lifecycle.max_targets = std::max(opts.lifecycle.max_targets, scenario->count());
+            }
+            if (!opts.has_seed) {
+                opts.seed = scenario->seed();
+                opts.has_seed = true;
+            }
+        }
+        if (!opts.has_seed) {
+            opts.seed = randomSeed();
+        }
+        if (opts.lifecycle.max_targets > SLOT_CAPACITY) {
+            std::cerr << "Limiting max targets to " << SLOT_CAPACITY << std::endl;
+            opts.lifecycle.max_targets = SLOT_CAPACITY;
+        }
+
         asio::io_context io_ctx;
-        SimulationEngine engine;
+        SimulationEngine engine(opts.lifecycle, opts.seed);
         NetworkServer server(io_ctx, 5555, engine);
+        engine.setMotion(opts.motion);
+        engine.setWorkerThreads(opts.threads);
+
+        if (scenario) {
+            auto t0 = std::chrono::steady_clock::now();
+            size_t loaded = engine.loadScenario(*scenario);
+            auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << "Loaded " << loaded << " targets from " << opts.scenario_path
+                << " in " << ms << " ms" << std::endl;
+            scenario.reset();
+        }
+
+        if (!opts.obstacles_path.empty()) {
+            const auto obstacles = loadObstacles(opts.obstacles_path);
+            engine.enableOcclusion(obstacles);
+            std::cout << "Loaded " << obstacles.size() << " obstacles from " << opts.obstacles_path << std::endl;
+        }
+        if (opts.sensing) {
+            engine.enableSensor(opts.sensor);
+        }
+        if (opts.video_enabled) {
+            engine.enableVideo(opts.video);
+        }
+        if (opts.detecting) {
+            engine.enableDetector(opts.cfar);
+        }
+        if (opts.clutter_mapping) {
+            opts.clutter_map.false_alarm_rate = opts.cfar.false_alarm_rate;
+            engine.enableClutterMap(opts.clutter_map);
+        }
+        if (opts.sweep_sectors > 0) {
+            engine.enableSweep(opts.sweep_sectors);
+        }
+        if (!opts.alarms_path.empty()) {
+            const AlarmConfig alarms = loadAlarmConfig(opts.alarms_path);
+            engine.enableAlarms(alarms);
+            std::cout << "Loaded " << alarms.zones.size() << " zones and " << alarms.rules.size()
+                << " alarm rules from " << opts.alarms_path << std::endl;
+        }
+        if (opts.tracking) {
+            engine.enableTracking(opts.tracker, opts.association);
+        }
+
+        if (opts.history_enabled) {
+            engine.enableHistory(opts.history);
+        }
+
+        if (replay_log) {
+            std::cout << "Replaying " << replay_log->tickCount() << " ticks from " << opts.replay_path
+                << " at " << opts.replay_speed << "x" << std::endl;
+            engine.replay(std::move(replay_log), opts.replay_speed, opts.replay_from);
+        }
+
+        if (!opts.record_path.empty()) {
+            engine.record(opts.record_path);
+            std::cout << "Recording ticks to " << opts.record_path << std::endl;
+        }
+
+        if (opts.initial_targets > 0) {
+            std::cout << "Spawned " << engine.spawn(opts.initial_targets) << " initial targets" << std::endl;
+        }
 
         asio::signal_set signals(io_ctx, SIGINT, SIGTERM);
         signals.async_wait([&](auto, auto) {
@@ -29,4 +384,4 @@ int main() {
         std::cerr << "\n!!! CRITICAL ERROR !!!\n" << e.what() << std::endl;
         return 1;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,279 @@
+#include "motion-model.h"
+#include <algorithm>
+#include <stdexcept>
+
+MotionModel parseMotionModel(const std::string& name) {
+    if (name == "cv") {
+        return MotionModel::ConstantVelocity;
+    }
+    if (name == "ct") {
+        return MotionModel::CoordinatedTurn;
+    }
+    if (name == "ca") {
+        return MotionModel::ConstantAcceleration;
+    }
+    if (name == "rw") {
+        return MotionModel::RandomWalk;
+    }
+    throw std::invalid_argument("Unknown motion model: " + name);
+}
+
+const char* motionModelName(MotionModel model) {
+    switch (model) {
+    case MotionModel::ConstantVelocity:
+        return "cv";
+    case MotionModel::CoordinatedTurn:
+        return "ct";
+    case MotionModel::ConstantAcceleration:
+        return "ca";
+    case MotionModel::RandomWalk:
+        return "rw";
+    }
+    return "?";
+}
+
+void ConstantVelocityGroup::advance(const CounterRng&, uint64_t) {
+    const size_t n = _ids.size();
+    double* x = _x.data();
+    double* y = _y.data();
+    const double* vx = _vx.data();
+    const double* vy = _vy.data();
+    for (size_t i = 0; i < n; ++i) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+    }
+}
+
+void CoordinatedTurnGroup::addModel(double, const MotionParams& params) {
+    _turn.push_back(params.turn_rate);
+    _turn_cos.push_back(std::cos(params.turn_rate));
+    _turn_sin.push_back(std::sin(params.turn_rate));
+}
+
+void CoordinatedTurnGroup::removeModel(size_t index, size_t last) {
+    swapOut(index, last, _turn, _turn_cos, _turn_sin);
+}
+
+void CoordinatedTurnGroup::advance(const CounterRng&, uint64_t) {
+    const size_t n = _ids.size();
+    double* x = _x.data();
+    double* y = _y.data();
+    double* vx = _vx.data();
+    double* vy = _vy.data();
+    double* heading = _heading.data();
+    const double* turn = _turn.data();
+    const double* c = _turn_cos.data();
+    const double* s = _turn_sin.data();
+    for (size_t i = 0; i < n; ++i) {
+        const double nvx = c[i] * vx[i] - s[i] * vy[i];
+        const double nvy = s[i] * vx[i] + c[i] * vy[i];
+        vx[i] = nvx;
+        vy[i] = nvy;
+        x[i] += nvx;
+        y[i] += nvy;
+        heading[i] = wrapAngle(heading[i] + turn[i]);
+    }
+}
+
+void ConstantAccelerationGroup::setSpeedRange(double min_speed, double max_speed) {
+    _min_speed = min_speed;
+    _max_speed = max_speed;
+}
+
+void ConstantAccelerationGroup::addModel(double heading, const MotionParams& params) {
+    _speed.push_back(params.speed);
+    _acceleration.push_back(params.acceleration);
+    _ux.push_back(std::cos(heading));
+    _uy.push_back(std::sin(heading));
+}
+
+void ConstantAccelerationGroup::removeModel(size_t index, size_t last) {
+    swapOut(index, last, _speed, _acceleration, _ux, _uy);
+}
+
+void ConstantAccelerationGroup::reverse(size_t i) {
+    _ux[i] = -_ux[i];
+    _uy[i] = -_uy[i];
+}
+
+void ConstantAccelerationGroup::advance(const CounterRng&, uint64_t) {
+    const size_t n = _ids.size();
+    double* x = _x.data();
+    double* y = _y.data();
+    double* vx = _vx.data();
+    double* vy = _vy.data();
+    double* speed = _speed.data();
+    const double* acceleration = _acceleration.data();
+    const double* ux = _ux.data();
+    const double* uy = _uy.data();
+    const double lo = _min_speed;
+    const double hi = _max_speed;
+    for (size_t i = 0; i < n; ++i) {
+        const double v = std::min(std::max(speed[i] + acceleration[i], lo), hi);
+        speed[i] = v;
+        vx[i] = v * ux[i];
+        vy[i] = v * uy[i];
+        x[i] += vx[i];
+        y[i] += vy[i];
+    }
+}
+
+void RandomWalkGroup::setMaxTurn(double max_turn) {
+    _max_turn = max_turn;
+}
+
+void RandomWalkGroup::addModel(double, const MotionParams& params) {
+    _speed.push_back(params.speed);
+}
+
+void RandomWalkGroup::removeModel(size_t index, size_t last) {
+    swapOut(index, last, _speed);
+}
+
+void RandomWalkGroup::advance(const CounterRng& rng, uint64_t tick) {
+    const size_t n = _ids.size();
+    for (size_t i = 0; i < n; ++i) {
+        const double sample = rng.uniform(RNG_STREAM_MOTION, static_cast<uint32_t>(_ids[i]), tick);
+        const double h = wrapAngle(_heading[i] + (2.0 * sample - 1.0) * _max_turn);
+        _heading[i] = h;
+        _vx[i] = _speed[i] * std::cos(h);
+        _vy[i] = _speed[i] * std::sin(h);
+        _x[i] += _vx[i];
+        _y[i] += _vy[i];
+    }
+}
+
+template<typename Visitor>
+auto MotionSystem::visit(MotionModel model, Visitor&& visitor) {
+    switch (model) {
+    case MotionModel::ConstantVelocity:
+        return visitor(_cv);
+    case MotionModel::CoordinatedTurn:
+        return visitor(_ct);
+    case MotionModel::ConstantAcceleration:
+        return visitor(_ca);
+    case MotionModel::RandomWalk:
+    default:
+        return visitor(_rw);
+    }
+}
+
+template<typename Visitor>
+auto MotionSystem::visit(MotionModel model, Visitor&& visitor) const {
+    return const_cast<MotionSystem*>(this)->visit(model, [&visitor](const auto& group) {
+        return visitor(group);
+    });
+}
+
+void MotionSystem::configure(const MotionConfig& config) {
+    if (config.models.empty()) {
+        throw std::invalid_argument("At least one motion model is required");
+    }
+    if (config.min_speed < 0.0 || config.max_speed < config.min_speed) {
+        throw std::invalid_argument("Invalid speed range");
+    }
+    _config = config;
+    _ca.setSpeedRange(config.min_speed, config.max_speed);
+    _rw.setMaxTurn(config.random_walk_turn);
+}
+
+MotionParams MotionSystem::draw(const CounterRng& rng, uint32_t seq, uint64_t tick) const {
+    const auto bits = rng.block(RNG_STREAM_KINEMATICS, seq, tick);
+    const size_t pick = std::min(
+        static_cast<size_t>(CounterRng::toUnit(bits[0]) * _config.models.size()),
+        _config.models.size() - 1);
+
+    MotionParams params;
+    params.model = _config.models[pick];
+    params.speed = _config.min_speed + CounterRng::toUnit(bits[1]) * (_config.max_speed - _config.min_speed);
+    params.turn_rate = (2.0 * CounterRng::toUnit(bits[2]) - 1.0) * _config.max_turn_rate;
+    params.acceleration = (2.0 * CounterRng::toUnit(bits[3]) - 1.0) * _config.max_acceleration;
+    return params;
+}
+
+void MotionSystem::add(const Target& target, const MotionParams& params) {
+    const Eigen::Vector2d p = target.position();
+    const uint32_t index = visit(params.model, [&](auto& group) {
+        return group.add(target.id, p.x(), p.y(), target.direction, params);
+    });
+    _locations.set(target.id, { params.model, index });
+}
+
+void MotionSystem::remove(int id) {
+    const Location* location = _locations.find(id);
+    if (!location) {
+        return;
+    }
+    const Location removed = *location;
+    _locations.erase(id);
+
+    const int moved = visit(removed.model, [&](auto& group) {
+        return group.remove(removed.index);
+    });
+    if (moved >= 0) {
+        _locations.set(moved, removed);
+    }
+}
+
+void MotionSystem::clear() {
+    _cv.clear();
+    _ct.clear();
+    _ca.clear();
+    _rw.clear();
+    _locations.clear();
+}
+
+void MotionSystem::step(const CounterRng& rng, uint64_t tick) {
+    _cv.step(rng, tick);
+    _ct.step(rng, tick);
+    _ca.step(rng, tick);
+    _rw.step(rng, tick);
+}
+
+void MotionSystem::setReflect(bool reflect) {
+    _cv.setReflect(reflect);
+    _ct.setReflect(reflect);
+    _ca.setReflect(reflect);
+    _rw.setReflect(reflect);
+}
+
+void MotionSystem::apply(Target& target) const {
+    const Location* location = _locations.find(target.id);
+    if (!location) {
+        return;
+    }
+    const uint32_t i = location->index;
+    visit(location->model, [&](const auto& group) {
+        target.moveTo(group.distance(i), group.angle(i), group.heading(i));
+    });
+}
+
+double MotionSystem::nextAngle(const Target& target) const {
+    const Location* location = _locations.find(target.id);
+    if (!location) {
+        return target.angle;
+    }
+    const uint32_t i = location->index;
+    return visit(location->model, [&](const auto& group) {
+        return group.angle(i);
+    });
+}
+
+void MotionSystem::updatePolar() {
+    _cv.updatePolar();
+    _ct.updatePolar();
+    _ca.updatePolar();
+    _rw.updatePolar();
+}
+
+size_t MotionSystem::size() const {
+    return _cv.size() + _ct.size() + _ca.size() + _rw.size();
+}
+
+std::array<MotionColumns, 4> MotionSystem::columns() {
+    return { _cv.columns(), _ct.columns(), _ca.columns(), _rw.columns() };
+}
+
+std::array<MotionPositions, 4> MotionSystem::positions() const {
+    return { _cv.positions(), _ct.positions(), _ca.positions(), _rw.positions() };
+}
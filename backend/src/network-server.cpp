@@ -2,6 +2,9 @@
 #include <iostream>
 #include <thread>
 #include <csignal>
+#include <cstring>
+#include <sstream>
+#include <limits>
 
 NetworkServer::NetworkServer(
     asio::io_context& io,
@@ -34,7 +37,7 @@ void NetworkServer::start() {
 }
 
 void NetworkServer::startBroadcast() {
-    _broadcast_timer->expires_after(std::chrono::milliseconds(500));
+    _broadcast_timer->expires_after(_sim_eng.publishInterval());
     _broadcast_timer->async_wait(
         [this](const asio::error_code& ec) {
             if (ec) {
@@ -98,7 +101,7 @@ void NetworkServer::readCommands(asio::ip::tcp::socket& socket) {
         [this, buffer, &socket](asio::error_code ec, size_t length) {
             if (!ec) {
                 std::string command(buffer->begin(), buffer->begin() + length);
-                handleCommand(command);
+                handleCommand(socket, command);
 
                 readCommands(socket);
             }
@@ -117,7 +120,7 @@ void NetworkServer::readCommands(asio::ip::tcp::socket& socket) {
         });
 }
 
-void NetworkServer::handleCommand(const std::string& command) {
+void NetworkServer::handleCommand(asio::ip::tcp::socket& socket, const std::string& command) {
     if (command == "PAUSE") {
         if (!_sim_eng.isPaused()) {
             _sim_eng.togglePause();
@@ -128,6 +131,23 @@ void NetworkServer::handleCommand(const std::string& command) {
             _sim_eng.togglePause();
         }
     }
+    else if (command.rfind("SPAWN", 0) == 0) {
+        size_t count = 1;
+        try {
+            if (command.size() > 5) {
+                count = std::stoul(command.substr(5));
+            }
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid SPAWN command: " << command << std::endl;
+            return;
+        }
+        size_t spawned = _sim_eng.spawn(count);
+        std::cout << "Spawned " << spawned << " of " << count << " requested targets" << '\n';
+    }
+    else if (command.rfind("HISTORY", 0) == 0) {
+        handleHistoryQuery(socket, command.substr(7));
+    }
     else if (command == "EXIT") {
         std::cout << "Exit command received from client" << '\n';
 
@@ -138,48 +158,332 @@ void NetworkServer::handleCommand(const std::string& command) {
     }
 }
 
-void NetworkServer::broadcastData() {
-    if (_clients.empty()) {
+// HISTORY REGION <min_m> <max_m> <from_deg> <to_deg> <from_tick> <to_tick>
+// HISTORY TRACK <id> [<from_tick> <to_tick>]
+// Each chunk's matches are written to the client as soon as they are found.
+void NetworkServer::handleHistoryQuery(asio::ip::tcp::socket& socket, const std::string& query) {
+    const HistoryStore* history = _sim_eng.history();
+    if (!history) {
+        std::cerr << "History query ignored, start the server with --history to keep history" << std::endl;
         return;
     }
 
-    auto targets = _sim_eng.getTargets();
+    std::istringstream in(query);
+    std::string kind;
+    in >> kind;
 
+    const uint32_t query_id = _next_query_id++;
     std::vector<uint8_t> buffer;
+    auto stream = [&](const std::vector<HistoryRecord>& records) {
+        buffer.clear();
+        appendHistoryResult(buffer, query_id, false, records);
+        sendTo(socket, buffer);
+    };
 
-    uint32_t magic = 0xABCDEF01;
-    NetworkServer::appendToBuffer(buffer, magic);
+    size_t found = 0;
+    if (kind == "REGION") {
+        HistoryRegion region;
+        if (!(in >> region.min_distance >> region.max_distance >> region.from_deg >> region.to_deg
+            >> region.from_tick >> region.to_tick)) {
+            std::cerr << "Invalid HISTORY REGION command: " << query << std::endl;
+            return;
+        }
+        found = history->queryRegion(region, stream);
+    }
+    else if (kind == "TRACK") {
+        int id = -1;
+        uint64_t from_tick = 0;
+        uint64_t to_tick = std::numeric_limits<uint64_t>::max();
+        if (!(in >> id)) {
+            std::cerr << "Invalid HISTORY TRACK command: " << query << std::endl;
+            return;
+        }
+        uint64_t from = 0;
+        uint64_t to = 0;
+        if (in >> from >> to) {
+            from_tick = from;
+            to_tick = to;
+        }
+        found = history->queryTrack(id, from_tick, to_tick, stream);
+    }
+    else {
+        std::cerr << "Unknown HISTORY query: " << query << std::endl;
+        return;
+    }
 
-    uint16_t count = targets.size();
-    NetworkServer::appendToBuffer(buffer, count);
+    buffer.clear();
+    appendHistoryResult(buffer, query_id, true, {});
+    sendTo(socket, buffer);
+    std::cout << "History query " << query_id << " returned " << found << " states" << '\n';
+}
 
-    for (const auto& t : targets) {
-        NetworkServer::appendToBuffer(buffer, t.id);
-        NetworkServer::appendToBuffer(buffer, t.distance);
-        NetworkServer::appendToBuffer(buffer, t.angle);
-        NetworkServer::appendToBuffer(buffer, t.direction);
+void NetworkServer::broadcastData() {
+    auto events = _sim_eng.drainEvents();
+    auto sectors = _sim_eng.drainSweep();
+    auto alarms = _sim_eng.drainAlarms();
 
-        NetworkServer::appendToBuffer(buffer, t.color.x());
-        NetworkServer::appendToBuffer(buffer, t.color.y());
-        NetworkServer::appendToBuffer(buffer, t.color.z());
+    if (_clients.empty()) {
+        return;
+    }
 
-        uint8_t trail_size = static_cast<uint8_t>(t.trail.size());
-        NetworkServer::appendToBuffer(buffer, trail_size);
+    std::vector<uint8_t> buffer;
+    if (!events.empty()) {
+        appendEvents(buffer, events);
+    }
+    if (!alarms.empty()) {
+        appendAlarms(buffer, alarms, _sim_eng.alarmRuleNames());
+    }
+    if (_sim_eng.isSweeping()) {
+        broadcastSweep(buffer, sectors);
+        return;
+    }
 
-        for (const auto& point : t.trail) {
-            NetworkServer::appendToBuffer(buffer, point.x());
-            NetworkServer::appendToBuffer(buffer, point.y());
+    appendFrame(buffer, _sim_eng.getTargets());
+    if (_sim_eng.isSensing()) {
+        appendPlots(buffer, _sim_eng.getPlots());
+    }
+    if (_sim_eng.isTracking()) {
+        appendTracks(buffer, _sim_eng.getTracks());
+        appendTrackerStats(buffer, _sim_eng.getTrackerStats());
+    }
+
+    sendToClients(buffer);
+}
+
+// Each sector swept since the last broadcast goes out with the spokes of the
+// latest video that fall in it; per-scan data follows the last sector. Video
+// is only ever streamed this way, so the server sweeps whenever it has video.
+void NetworkServer::broadcastSweep(std::vector<uint8_t>& buffer, const std::vector<SweepSector>& sectors) {
+    if (sectors.empty() && buffer.empty()) {
+        return;
+    }
+    const VideoScan video = _sim_eng.hasVideo() && !sectors.empty() ? _sim_eng.getVideo() : VideoScan{};
+
+    for (const auto& sector : sectors) {
+        appendSector(buffer, sector);
+        if (video.azimuths > 0) {
+            const int first = sector.sector * video.azimuths / sector.sectors;
+            const int end = (sector.sector + 1) * video.azimuths / sector.sectors;
+            appendVideo(buffer, video, first, end - first);
+        }
+        if (sector.sector + 1 < sector.sectors) {
+            continue;
+        }
+        if (_sim_eng.isSensing()) {
+            appendPlots(buffer, _sim_eng.getPlots());
+        }
+        if (_sim_eng.isTracking()) {
+            appendTracks(buffer, _sim_eng.getTracks());
+            appendTrackerStats(buffer, _sim_eng.getTrackerStats());
         }
     }
 
+    sendToClients(buffer);
+}
+
+void NetworkServer::sendToClients(const std::vector<uint8_t>& buffer) {
     std::lock_guard<std::mutex> lock(_clients_mutex);
     for (auto& socket : _clients) {
         if (socket.is_open()) {
             asio::error_code ec;
-            socket.write_some(asio::buffer(buffer), ec);
+            asio::write(socket, asio::buffer(buffer), ec);
             if (ec) {
                 socket.close();
             }
         }
     }
-}
\ No newline at end of file
+}
+
+void NetworkServer::sendTo(asio::ip::tcp::socket& socket, const std::vector<uint8_t>& buffer) {
+    std::lock_guard<std::mutex> lock(_clients_mutex);
+    if (socket.is_open()) {
+        asio::error_code ec;
+        asio::write(socket, asio::buffer(buffer), ec);
+        if (ec) {
+            socket.close();
+        }
+    }
+}
+
+void NetworkServer::appendFrame(std::vector<uint8_t>& buffer, const std::vector<Target>& targets) {
+    NetworkServer::appendToBuffer(buffer, FRAME_MAGIC);
+
+    uint32_t count = static_cast<uint32_t>(targets.size());
+    NetworkServer::appendToBuffer(buffer, count);
+
+    for (const auto& t : targets) {
+        appendTarget(buffer, t);
+    }
+}
+
+void NetworkServer::appendSector(std::vector<uint8_t>& buffer, const SweepSector& sector) {
+    size_t header_pos = beginMessage(buffer, MessageType::Sector);
+
+    NetworkServer::appendToBuffer(buffer, sector.tick);
+    NetworkServer::appendToBuffer(buffer, static_cast<uint16_t>(sector.sector));
+    NetworkServer::appendToBuffer(buffer, static_cast<uint16_t>(sector.sectors));
+    NetworkServer::appendToBuffer(buffer, static_cast<uint32_t>(sector.targets.size()));
+    for (const auto& t : sector.targets) {
+        appendTarget(buffer, t);
+    }
+
+    endMessage(buffer, header_pos);
+}
+
+void NetworkServer::appendTarget(std::vector<uint8_t>& buffer, const Target& t) {
+    NetworkServer::appendToBuffer(buffer, t.id);
+    NetworkServer::appendToBuffer(buffer, t.distance);
+    NetworkServer::appendToBuffer(buffer, t.angle);
+    NetworkServer::appendToBuffer(buffer, t.direction);
+
+    NetworkServer::appendToBuffer(buffer, t.color.x());
+    NetworkServer::appendToBuffer(buffer, t.color.y());
+    NetworkServer::appendToBuffer(buffer, t.color.z());
+
+    uint8_t trail_size = static_cast<uint8_t>(t.trail.size());
+    NetworkServer::appendToBuffer(buffer, trail_size);
+
+    for (const auto& point : t.trail) {
+        NetworkServer::appendToBuffer(buffer, point.x());
+        NetworkServer::appendToBuffer(buffer, point.y());
+    }
+}
+
+void NetworkServer::appendEvents(std::vector<uint8_t>& buffer, const std::vector<TargetEvent>& events) {
+    size_t header_pos = beginMessage(buffer, MessageType::TargetEvents);
+
+    uint32_t count = static_cast<uint32_t>(events.size());
+    NetworkServer::appendToBuffer(buffer, count);
+
+    for (const auto& e : events) {
+        NetworkServer::appendToBuffer(buffer, static_cast<uint8_t>(e.type));
+        NetworkServer::appendToBuffer(buffer, e.id);
+    }
+
+    endMessage(buffer, header_pos);
+}
+
+void NetworkServer::appendAlarms(std::vector<uint8_t>& buffer, const std::vector<AlarmEvent>& alarms,
+    const std::vector<std::string>& names) {
+    size_t header_pos = beginMessage(buffer, MessageType::Alarms);
+
+    uint32_t count = static_cast<uint32_t>(alarms.size());
+    NetworkServer::appendToBuffer(buffer, count);
+
+    for (const auto& a : alarms) {
+        const std::string& name = names[a.rule];
+        const auto length = static_cast<uint8_t>(std::min<size_t>(name.size(), 255));
+        NetworkServer::appendToBuffer(buffer, a.tick);
+        NetworkServer::appendToBuffer(buffer, static_cast<int32_t>(a.id));
+        NetworkServer::appendToBuffer(buffer, a.distance);
+        NetworkServer::appendToBuffer(buffer, a.angle);
+        NetworkServer::appendToBuffer(buffer, length);
+        buffer.insert(buffer.end(), name.begin(), name.begin() + length);
+    }
+
+    endMessage(buffer, header_pos);
+}
+
+void NetworkServer::appendPlots(std::vector<uint8_t>& buffer, const PlotBatch& plots) {
+    size_t header_pos = beginMessage(buffer, MessageType::Plots);
+
+    NetworkServer::appendToBuffer(buffer, plots.tick);
+    uint32_t count = static_cast<uint32_t>(plots.size());
+    NetworkServer::appendToBuffer(buffer, count);
+
+    // Written in place: a stress-test scan can carry millions of plots.
+    const size_t base = buffer.size();
+    buffer.resize(base + plots.size() * PLOT_RECORD_SIZE);
+    uint8_t* out = buffer.data() + base;
+    for (size_t i = 0; i < plots.size(); ++i) {
+        std::memcpy(out, &plots.distances[i], sizeof(float));
+        std::memcpy(out + sizeof(float), &plots.angles[i], sizeof(float));
+        out += PLOT_RECORD_SIZE;
+    }
+
+    endMessage(buffer, header_pos);
+}
+
+void NetworkServer::appendVideo(std::vector<uint8_t>& buffer, const VideoScan& video, int first, int count) {
+    const auto azimuths = static_cast<uint16_t>(video.azimuths);
+    const auto bins = static_cast<uint16_t>(video.range_bins);
+    buffer.reserve(buffer.size() + size_t(count) * (MESSAGE_HEADER_SIZE + VIDEO_SPOKE_HEADER_SIZE + bins));
+
+    for (uint16_t azimuth = static_cast<uint16_t>(first); azimuth < first + count; ++azimuth) {
+        size_t header_pos = beginMessage(buffer, MessageType::VideoSpoke);
+
+        NetworkServer::appendToBuffer(buffer, video.tick);
+        NetworkServer::appendToBuffer(buffer, azimuth);
+        NetworkServer::appendToBuffer(buffer, azimuths);
+        NetworkServer::appendToBuffer(buffer, bins);
+        const uint8_t* line = video.spokeIntensity(azimuth);
+        buffer.insert(buffer.end(), line, line + bins);
+
+        endMessage(buffer, header_pos);
+    }
+}
+
+void NetworkServer::appendTracks(std::vector<uint8_t>& buffer, const std::vector<TrackReport>& tracks) {
+    size_t header_pos = beginMessage(buffer, MessageType::Tracks);
+
+    uint32_t count = static_cast<uint32_t>(tracks.size());
+    NetworkServer::appendToBuffer(buffer, count);
+
+    for (const auto& t : tracks) {
+        NetworkServer::appendToBuffer(buffer, t.id);
+        NetworkServer::appendToBuffer(buffer, t.distance);
+        NetworkServer::appendToBuffer(buffer, t.angle);
+        NetworkServer::appendToBuffer(buffer, t.heading);
+        NetworkServer::appendToBuffer(buffer, t.speed);
+        NetworkServer::appendToBuffer(buffer, t.sigma);
+    }
+
+    endMessage(buffer, header_pos);
+}
+
+void NetworkServer::appendTrackerStats(std::vector<uint8_t>& buffer, const TrackerStats& stats) {
+    size_t header_pos = beginMessage(buffer, MessageType::TrackerStats);
+
+    NetworkServer::appendToBuffer(buffer, stats.tick);
+    NetworkServer::appendToBuffer(buffer, stats.confirmed);
+    NetworkServer::appendToBuffer(buffer, stats.tentative);
+    NetworkServer::appendToBuffer(buffer, stats.coasting);
+    NetworkServer::appendToBuffer(buffer, stats.tick_ms);
+
+    endMessage(buffer, header_pos);
+}
+
+void NetworkServer::appendHistoryResult(
+    std::vector<uint8_t>& buffer,
+    uint32_t query_id,
+    bool final,
+    const std::vector<HistoryRecord>& records
+) {
+    size_t header_pos = beginMessage(buffer, MessageType::HistoryResult);
+
+    NetworkServer::appendToBuffer(buffer, query_id);
+    NetworkServer::appendToBuffer(buffer, static_cast<uint8_t>(final ? 1 : 0));
+    NetworkServer::appendToBuffer(buffer, static_cast<uint32_t>(records.size()));
+
+    for (const auto& r : records) {
+        NetworkServer::appendToBuffer(buffer, r.tick);
+        NetworkServer::appendToBuffer(buffer, r.id);
+        NetworkServer::appendToBuffer(buffer, r.distance);
+        NetworkServer::appendToBuffer(buffer, r.angle);
+    }
+
+    endMessage(buffer, header_pos);
+}
+
+size_t NetworkServer::beginMessage(std::vector<uint8_t>& buffer, MessageType type) {
+    size_t header_pos = buffer.size();
+    NetworkServer::appendToBuffer(buffer, MESSAGE_MAGIC);
+    NetworkServer::appendToBuffer(buffer, static_cast<uint16_t>(type));
+    NetworkServer::appendToBuffer(buffer, uint32_t{ 0 });
+    return header_pos;
+}
+
+void NetworkServer::endMessage(std::vector<uint8_t>& buffer, size_t header_pos) {
+    uint32_t payload_size = static_cast<uint32_t>(buffer.size() - header_pos - MESSAGE_HEADER_SIZE);
+    std::memcpy(buffer.data() + header_pos + 4 + 2, &payload_size, sizeof(payload_size));
+}
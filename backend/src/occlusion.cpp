@@ -0,0 +1,114 @@
+#include "occlusion.h"
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+
+double cross(const Eigen::Vector2d& a, const Eigen::Vector2d& b) {
+    return a.x() * b.y() - a.y() * b.x();
+}
+
+// Even-odd rule for a ray from the radar along +x.
+bool containsRadar(const Obstacle& obstacle) {
+    const auto& v = obstacle.vertices;
+    bool inside = false;
+    for (size_t i = 0, j = v.size() - 1; i < v.size(); j = i++) {
+        if ((v[i].y() > 0.0) != (v[j].y() > 0.0)) {
+            const double x = v[j].x() - v[j].y() * (v[i].x() - v[j].x()) / (v[i].y() - v[j].y());
+            inside ^= x > 0.0;
+        }
+    }
+    return inside;
+}
+
+}
+
+std::vector<Obstacle> loadObstacles(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open obstacle file: " + path);
+    }
+
+    std::vector<Obstacle> obstacles;
+    std::string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        Obstacle obstacle;
+        std::string vertex;
+        while (fields >> vertex) {
+            const size_t comma = vertex.find(',');
+            try {
+                if (comma == std::string::npos) {
+                    throw std::invalid_argument(vertex);
+                }
+                obstacle.vertices.emplace_back(std::stod(vertex.substr(0, comma)), std::stod(vertex.substr(comma + 1)));
+            }
+            catch (const std::logic_error&) {
+                throw std::runtime_error(path + ":" + std::to_string(number) + ": expected x,y but got " + vertex);
+            }
+        }
+        if (obstacle.vertices.empty()) {
+            continue;
+        }
+        if (obstacle.vertices.size() < 3) {
+            throw std::runtime_error(path + ":" + std::to_string(number) + ": an obstacle needs at least 3 vertices");
+        }
+        obstacles.push_back(std::move(obstacle));
+    }
+    return obstacles;
+}
+
+OcclusionMap::OcclusionMap(const std::vector<Obstacle>& obstacles) :
+    _bins_per_radian(OCCLUSION_AZIMUTHS / (2 * EIGEN_PI)),
+    _obstacles(obstacles.size()),
+    _blocked(OCCLUSION_AZIMUTHS, std::numeric_limits<float>::infinity())
+{
+    for (const auto& obstacle : obstacles) {
+        if (obstacle.vertices.size() < 3) {
+            throw std::invalid_argument("An obstacle needs at least 3 vertices");
+        }
+        if (containsRadar(obstacle)) {
+            throw std::invalid_argument("The radar is inside an obstacle");
+        }
+        const auto& v = obstacle.vertices;
+        for (size_t i = 0, j = v.size() - 1; i < v.size(); j = i++) {
+            rasteriseEdge(v[j], v[i]);
+        }
+    }
+}
+
+// Intersects the edge with the ray through the centre of every bin it
+// spans. Bins holding a vertex also take the vertex range, so an obstacle
+// narrower than a bin still blocks it.
+void OcclusionMap::rasteriseEdge(const Eigen::Vector2d& p, const Eigen::Vector2d& q) {
+    const Eigen::Vector2d d = q - p;
+    const double pq = cross(p, q);
+    if (std::abs(pq) < 1e-9 * d.norm() * p.norm() && p.dot(q) <= 0.0) {
+        throw std::invalid_argument("The radar is on an obstacle edge");
+    }
+
+    const double from = std::atan2(p.y(), p.x());
+    const double span = std::remainder(std::atan2(q.y(), q.x()) - from, 2 * EIGEN_PI);
+    const double start = span >= 0.0 ? from : from + span;
+
+    const auto first = static_cast<int64_t>(std::ceil(start * _bins_per_radian - 0.5));
+    const auto last = static_cast<int64_t>(std::floor((start + std::abs(span)) * _bins_per_radian - 0.5));
+    for (int64_t bin = first; bin <= last; ++bin) {
+        const double theta = (bin + 0.5) / _bins_per_radian;
+        const Eigen::Vector2d u(std::cos(theta), std::sin(theta));
+        const double denominator = cross(u, d);
+        if (denominator != 0.0) {
+            block(bin, cross(p, d) / denominator);
+        }
+    }
+    block(static_cast<int64_t>(std::floor(from * _bins_per_radian)), p.norm());
+}
+
+void OcclusionMap::block(int64_t bin, double range) {
+    float& blocked = _blocked[bin & (OCCLUSION_AZIMUTHS - 1)];
+    blocked = std::min(blocked, static_cast<float>(std::max(0.0, range)));
+}
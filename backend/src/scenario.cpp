@@ -0,0 +1,230 @@
+#include "scenario.h"
+#include "target.h"
+#include "philox.h"
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+static constexpr uint64_t COLUMN_ALIGN = 64;
+
+static uint64_t alignUp(uint64_t value) {
+    return (value + COLUMN_ALIGN - 1) & ~(COLUMN_ALIGN - 1);
+}
+
+Scenario::Scenario(const std::string& path) :
+    _file(path)
+{
+    if (_file.size() < sizeof(ScenarioHeader)) {
+        throw std::runtime_error("Scenario file too small: " + path);
+    }
+    std::memcpy(&_header, _file.data(), sizeof(_header));
+
+    if (std::memcmp(_header.magic, SCENARIO_MAGIC, sizeof(SCENARIO_MAGIC)) != 0) {
+        throw std::runtime_error("Not a scenario file: " + path);
+    }
+    if (_header.version != SCENARIO_VERSION) {
+        throw std::runtime_error("Unsupported scenario version " + std::to_string(_header.version));
+    }
+
+    const uint64_t n = _header.target_count;
+    // Divides rather than multiplies, so a corrupt count cannot overflow past the check.
+    auto checkColumn = [&](uint64_t offset, uint64_t element) {
+        if (offset % COLUMN_ALIGN != 0 || offset < _header.header_size || offset > _file.size()
+            || n > (_file.size() - offset) / element) {
+            throw std::runtime_error("Corrupt scenario column layout: " + path);
+        }
+    };
+    checkColumn(_header.distance_offset, sizeof(double));
+    checkColumn(_header.angle_offset, sizeof(double));
+    checkColumn(_header.direction_offset, sizeof(double));
+    checkColumn(_header.color_offset, 3 * sizeof(float));
+}
+
+size_t Scenario::count() const {
+    return static_cast<size_t>(_header.target_count);
+}
+
+uint64_t Scenario::seed() const {
+    return _header.seed;
+}
+
+uint64_t Scenario::startTick() const {
+    return _header.start_tick;
+}
+
+const double* Scenario::distances() const {
+    return column<double>(_header.distance_offset);
+}
+
+const double* Scenario::angles() const {
+    return column<double>(_header.angle_offset);
+}
+
+const double* Scenario::directions() const {
+    return column<double>(_header.direction_offset);
+}
+
+const float* Scenario::reds() const {
+    return column<float>(_header.color_offset);
+}
+
+const float* Scenario::greens() const {
+    return reds() + count();
+}
+
+const float* Scenario::blues() const {
+    return greens() + count();
+}
+
+void Scenario::write(const std::string& path, const ScenarioColumns& columns) {
+    const uint64_t n = columns.distance.size();
+    if (columns.angle.size() != n || columns.direction.size() != n
+        || columns.red.size() != n || columns.green.size() != n || columns.blue.size() != n) {
+        throw std::invalid_argument("Scenario columns differ in length");
+    }
+
+    ScenarioHeader header{};
+    std::memcpy(header.magic, SCENARIO_MAGIC, sizeof(SCENARIO_MAGIC));
+    header.version = SCENARIO_VERSION;
+    header.header_size = sizeof(ScenarioHeader);
+    header.target_count = n;
+    header.seed = columns.seed;
+    header.start_tick = columns.start_tick;
+    header.distance_offset = alignUp(sizeof(ScenarioHeader));
+    header.angle_offset = alignUp(header.distance_offset + n * sizeof(double));
+    header.direction_offset = alignUp(header.angle_offset + n * sizeof(double));
+    header.color_offset = alignUp(header.direction_offset + n * sizeof(double));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create " + path);
+    }
+
+    auto writeAt = [&out](uint64_t offset, const void* data, size_t bytes) {
+        static const char zeros[COLUMN_ALIGN] = {};
+        uint64_t pos = static_cast<uint64_t>(out.tellp());
+        out.write(zeros, static_cast<std::streamsize>(offset - pos));
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    };
+
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.distance_offset, columns.distance.data(), n * sizeof(double));
+    writeAt(header.angle_offset, columns.angle.data(), n * sizeof(double));
+    writeAt(header.direction_offset, columns.direction.data(), n * sizeof(double));
+    writeAt(header.color_offset, columns.red.data(), n * sizeof(float));
+    out.write(reinterpret_cast<const char*>(columns.green.data()), static_cast<std::streamsize>(n * sizeof(float)));
+    out.write(reinterpret_cast<const char*>(columns.blue.data()), static_cast<std::streamsize>(n * sizeof(float)));
+
+    if (!out) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+}
+
+ScenarioDistribution parseScenarioDistribution(const std::string& name) {
+    if (name == "uniform") {
+        return ScenarioDistribution::Uniform;
+    }
+    if (name == "gaussian") {
+        return ScenarioDistribution::Gaussian;
+    }
+    if (name == "clusters") {
+        return ScenarioDistribution::Clusters;
+    }
+    if (name == "ring") {
+        return ScenarioDistribution::Ring;
+    }
+    throw std::invalid_argument("Unknown distribution: " + name);
+}
+
+ScenarioColumns generateScenario(const ScenarioSpec& spec) {
+    const CounterRng rng(spec.seed);
+    const size_t n = spec.count;
+
+    ScenarioColumns columns;
+    columns.seed = spec.seed;
+    columns.distance.resize(n);
+    columns.angle.resize(n);
+    columns.direction.resize(n);
+    columns.red.resize(n);
+    columns.green.resize(n);
+    columns.blue.resize(n);
+
+    auto gaussianPair = [](const CounterRng::Block& bits, double& g0, double& g1) {
+        double r = std::sqrt(-2.0 * std::log(CounterRng::toUnit(bits[0])));
+        double phi = 2 * EIGEN_PI * CounterRng::toUnit(bits[1]);
+        g0 = r * std::cos(phi);
+        g1 = r * std::sin(phi);
+    };
+
+    const int clusters = std::max(1, spec.clusters);
+    std::vector<double> cluster_x(clusters), cluster_y(clusters);
+    for (int c = 0; c < clusters; ++c) {
+        auto bits = rng.block(RNG_STREAM_SPAWN, static_cast<uint32_t>(c), ~uint64_t{ 0 });
+        double r = 0.8 * MAX_DISTANCE * std::sqrt(CounterRng::toUnit(bits[0]));
+        double a = 2 * EIGEN_PI * CounterRng::toUnit(bits[1]);
+        cluster_x[c] = r * std::cos(a);
+        cluster_y[c] = r * std::sin(a);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t id = static_cast<uint32_t>(i);
+        double x = 0.0, y = 0.0;
+
+        // Redraw with the next counter value until the point lands inside coverage.
+        for (uint64_t attempt = 0; ; ++attempt) {
+            auto bits = rng.block(RNG_STREAM_SPAWN, id, attempt);
+            double g0, g1;
+
+            switch (spec.distribution) {
+            case ScenarioDistribution::Uniform: {
+                double r = MAX_DISTANCE * std::sqrt(CounterRng::toUnit(bits[0]));
+                double a = 2 * EIGEN_PI * CounterRng::toUnit(bits[1]);
+                x = r * std::cos(a);
+                y = r * std::sin(a);
+                break;
+            }
+            case ScenarioDistribution::Gaussian:
+                gaussianPair(bits, g0, g1);
+                x = g0 * MAX_DISTANCE / 3.0;
+                y = g1 * MAX_DISTANCE / 3.0;
+                break;
+            case ScenarioDistribution::Clusters: {
+                gaussianPair(bits, g0, g1);
+                int c = static_cast<int>(bits[2] % static_cast<uint32_t>(clusters));
+                x = cluster_x[c] + g0 * MAX_DISTANCE / 20.0;
+                y = cluster_y[c] + g1 * MAX_DISTANCE / 20.0;
+                break;
+            }
+            case ScenarioDistribution::Ring: {
+                gaussianPair(bits, g0, g1);
+                double r = MAX_DISTANCE * (0.7 + 0.05 * g0);
+                double a = 2 * EIGEN_PI * CounterRng::toUnit(bits[2]);
+                x = r * std::cos(a);
+                y = r * std::sin(a);
+                break;
+            }
+            }
+
+            if (std::hypot(x, y) <= MAX_DISTANCE) {
+                break;
+            }
+        }
+
+        double a = std::atan2(y, x);
+        if (a < 0) {
+            a += 2 * EIGEN_PI;
+        }
+        columns.distance[i] = std::hypot(x, y);
+        columns.angle[i] = a;
+        columns.direction[i] = 2 * EIGEN_PI * CounterRng::toUnit(rng.block(RNG_STREAM_SPAWN, id, 0)[3]);
+
+        Eigen::Vector3d color = generateRandomColor(rng.block(RNG_STREAM_COLOR, id, 0));
+        columns.red[i] = static_cast<float>(color.x());
+        columns.green[i] = static_cast<float>(color.y());
+        columns.blue[i] = static_cast<float>(color.z());
+    }
+
+    return columns;
+}
@@ -0,0 +1,150 @@
+#include "sensor.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t CLUTTER_COUNT_ID = 0x80000000u;
+constexpr int CLUTTER_BLOCK_BITS = 24;
+
+void gaussianPair(uint32_t a, uint32_t b, double& z0, double& z1) {
+    const double radius = std::sqrt(-2.0 * std::log(CounterRng::toUnit(a)));
+    const double theta = 2 * EIGEN_PI * CounterRng::toUnit(b);
+    z0 = radius * std::cos(theta);
+    z1 = radius * std::sin(theta);
+}
+
+// Inversion for small means; above that a normal approximation, which is
+// plenty for generating load.
+size_t poisson(double mean, const CounterRng::Block& bits) {
+    if (mean <= 0.0) {
+        return 0;
+    }
+    if (mean < 64.0) {
+        const double u = CounterRng::toUnit(bits[0]);
+        double p = std::exp(-mean);
+        double cdf = p;
+        size_t k = 0;
+        while (u > cdf && p > 0.0) {
+            ++k;
+            p *= mean / k;
+            cdf += p;
+        }
+        return k;
+    }
+    double z0, z1;
+    gaussianPair(bits[0], bits[1], z0, z1);
+    return static_cast<size_t>(std::max(0.0, std::round(mean + std::sqrt(mean) * z0)));
+}
+
+}
+
+void PlotBatch::resize(size_t n) {
+    distances.resize(n);
+    angles.resize(n);
+    target_ids.resize(n);
+}
+
+Sensor::Sensor(const SensorConfig& config, WorkerPool& workers) :
+    _config(config),
+    _workers(workers),
+    _sector_offsets(SENSOR_SECTORS + 1)
+{
+    if (config.detection_probability < 0.0 || config.detection_probability > 1.0) {
+        throw std::invalid_argument("Detection probability must be within [0, 1]");
+    }
+    if (config.range_sigma < 0.0 || config.bearing_sigma < 0.0 || config.clutter_rate < 0.0) {
+        throw std::invalid_argument("Sensor noise and clutter rate must not be negative");
+    }
+    if (config.clutter_rate / SENSOR_SECTORS > double(1u << CLUTTER_BLOCK_BITS)) {
+        throw std::invalid_argument("Clutter rate is too high");
+    }
+}
+
+void Sensor::setOcclusion(const OcclusionMap* occlusion) {
+    _occlusion = occlusion;
+}
+
+const SensorConfig& Sensor::config() const {
+    return _config;
+}
+
+void Sensor::scan(const CounterRng& rng, uint64_t tick, const Target* targets, size_t count, PlotBatch& out) {
+    _detect_distance.resize(count);
+    _detect_angle.resize(count);
+    _detected.resize(count);
+
+    const double pd = _config.detection_probability;
+    const double range_sigma = _config.range_sigma;
+    const double bearing_sigma = _config.bearing_sigma;
+    const OcclusionMap* occlusion = _occlusion;
+    _workers.parallelFor(count, 1024, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Target& t = targets[i];
+            const auto bits = rng.block(RNG_STREAM_SENSOR, static_cast<uint32_t>(t.id), tick);
+            double z0, z1;
+            gaussianPair(bits[1], bits[2], z0, z1);
+
+            double angle = std::fmod(t.angle + bearing_sigma * z1, 2 * EIGEN_PI);
+            angle = angle < 0.0 ? angle + 2 * EIGEN_PI : angle;
+            _detected[i] = CounterRng::toUnit(bits[0]) < pd && (!occlusion || occlusion->visible(t.distance, t.angle));
+            _detect_distance[i] = static_cast<float>(std::abs(t.distance + range_sigma * z0));
+            _detect_angle[i] = static_cast<float>(angle);
+        }
+    });
+
+    size_t detections = 0;
+    for (size_t i = 0; i < count; ++i) {
+        detections += _detected[i];
+    }
+    const size_t clutter = drawClutterCounts(rng, tick);
+
+    out.tick = tick;
+    out.detections = detections;
+    out.resize(detections + clutter);
+
+    size_t k = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (_detected[i]) {
+            out.distances[k] = _detect_distance[i];
+            out.angles[k] = _detect_angle[i];
+            out.target_ids[k] = targets[i].id;
+            ++k;
+        }
+    }
+
+    // Uniform over the disc: r = R sqrt(u) gives constant density per area.
+    // Each Philox block yields two plots.
+    constexpr double SECTOR_WIDTH = 2 * EIGEN_PI / SENSOR_SECTORS;
+    _workers.parallelFor(SENSOR_SECTORS, 1, [&](size_t begin, size_t end) {
+        for (size_t sector = begin; sector < end; ++sector) {
+            const size_t first = detections + _sector_offsets[sector];
+            const size_t n = _sector_offsets[sector + 1] - _sector_offsets[sector];
+            float* distances = out.distances.data() + first;
+            float* angles = out.angles.data() + first;
+            const double sector_start = static_cast<double>(sector);
+            const uint32_t id_base = static_cast<uint32_t>(sector) << CLUTTER_BLOCK_BITS;
+
+            for (size_t j = 0; j < n; j += 2) {
+                const auto bits = rng.block(RNG_STREAM_CLUTTER, id_base | static_cast<uint32_t>(j / 2), tick);
+                distances[j] = static_cast<float>(MAX_DISTANCE * std::sqrt(CounterRng::toUnit(bits[0])));
+                angles[j] = static_cast<float>((sector_start + CounterRng::toUnit(bits[1])) * SECTOR_WIDTH);
+                if (j + 1 < n) {
+                    distances[j + 1] = static_cast<float>(MAX_DISTANCE * std::sqrt(CounterRng::toUnit(bits[2])));
+                    angles[j + 1] = static_cast<float>((sector_start + CounterRng::toUnit(bits[3])) * SECTOR_WIDTH);
+                }
+            }
+            std::fill_n(out.target_ids.data() + first, n, -1);
+        }
+    });
+}
+
+size_t Sensor::drawClutterCounts(const CounterRng& rng, uint64_t tick) {
+    const double mean = _config.clutter_rate / SENSOR_SECTORS;
+    _sector_offsets[0] = 0;
+    for (int sector = 0; sector < SENSOR_SECTORS; ++sector) {
+        const auto bits = rng.block(RNG_STREAM_SENSOR, CLUTTER_COUNT_ID | static_cast<uint32_t>(sector), tick);
+        _sector_offsets[sector + 1] = _sector_offsets[sector] + poisson(mean, bits);
+    }
+    return _sector_offsets[SENSOR_SECTORS];
+}
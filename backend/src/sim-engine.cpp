@@ -1,11 +1,29 @@
 #include "sim-engine.h"
-#include <random>
+#include "scenario.h"
+#include "tick-log.h"
+#include "history-store.h"
+#include "tracker.h"
+#include "sensor.h"
+#include "video.h"
+#include "cfar.h"
+#include "clutter-map.h"
+#include "occlusion.h"
+#include "alarms.h"
+#include "association.h"
 #include <thread>
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
-SimulationEngine::SimulationEngine()
+SimulationEngine::SimulationEngine(const LifecycleConfig& config, uint64_t seed) :
+    _config(config),
+    _rng(seed)
 {
-    std::cout << "SimulationEngine created" << std::endl;
+    _config.max_targets = std::min(_config.max_targets, SLOT_CAPACITY);
+    _targets.reserve(_config.max_targets);
+    _motion.setReflect(!_config.despawn_outside_coverage);
+    std::cout << "SimulationEngine created (max targets: " << _config.max_targets
+        << ", seed: " << seed << ")" << std::endl;
 }
 
 SimulationEngine::~SimulationEngine() {
@@ -34,6 +52,18 @@ void SimulationEngine::stop() {
     if (_sim_thread && _sim_thread->joinable()) {
         _sim_thread->join();
     }
+    if (_recorder) {
+        std::lock_guard<std::mutex> lock(_data_mutex);
+        _recorder->close();
+        std::cout << "Recorded " << _recorder->writtenTicks() << " ticks ("
+            << _recorder->droppedTicks() << " dropped)" << std::endl;
+    }
+    if (_history) {
+        _history->close();
+    }
+    if (_clutter_map) {
+        saveClutterMap();
+    }
     std::cout << "Simulation engine stopped." << std::endl;
 }
 
@@ -43,14 +73,15 @@ void SimulationEngine::togglePause() {
 
 void SimulationEngine::runLoop() {
     try {
-        constexpr std::chrono::milliseconds UPDATE_INTERVAL(500);
+        const auto interval = publishInterval();
+        const auto poll = std::min<std::chrono::microseconds>(interval, std::chrono::milliseconds(50));
         _last_update_time = std::chrono::steady_clock::now();
 
         while (_running) {
             auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _last_update_time);
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - _last_update_time);
 
-            if (elapsed >= UPDATE_INTERVAL) {
+            if (elapsed >= interval) {
                 if (!_paused) {
                     update();
                 }
@@ -58,7 +89,7 @@ void SimulationEngine::runLoop() {
             }
 
             std::unique_lock<std::mutex> lock(_cv_mutex);
-            _cv.wait_for(lock, std::chrono::milliseconds(50), [this] {
+            _cv.wait_for(lock, poll, [this] {
                 return !_running;
             });
         }
@@ -76,44 +107,604 @@ void SimulationEngine::runLoop() {
 
 void SimulationEngine::update() {
     std::lock_guard<std::mutex> lock(_data_mutex);
+    settleRecording();
+
+    if (_replayer) {
+        replayStep();
+        return;
+    }
+    if (_sweep_sectors > 0) {
+        sweepSector();
+        return;
+    }
 
-    static int counter = 0;
-    if (counter % 20 == 0) {
+    if (_config.spawn_interval_ticks > 0 && _tick % _config.spawn_interval_ticks == 0) {
         addTarget();
-        counter = 0;
     }
-    counter++;
 
+    // History snapshots are filled in the motion loop, while each target is
+    // still in cache.
+    TickSnapshot* snapshot = beginSnapshot();
+    size_t recorded = 0;
+
+    _motion.step(_rng, _tick);
+    if (_alarms) {
+        _motion.updatePolar();              // read again whole by the alarms
+    }
     for (auto& target : _targets) {
-        target.move();
+        _motion.apply(target);
+        if (snapshot && !isExpired(target)) {
+            snapshot->set(recorded++, target);
+        }
+    }
+    ++_tick;
+    finishTick(snapshot, recorded);
+}
+
+// A sweep spreads a tick over one revolution of the beam. Motion is stepped
+// for everyone as the revolution starts, but each target only takes its new
+// state, and is published, when the beam reaches its new bearing. The scan
+// stages run once the last sector has been swept.
+void SimulationEngine::sweepSector() {
+    if (_sweep_sector == 0) {
+        if (_config.spawn_interval_ticks > 0 && _tick % _config.spawn_interval_ticks == 0) {
+            addTarget();
+        }
+        _motion.step(_rng, _tick);
+        _motion.updatePolar();              // every bearing is needed to sort
+        sortBySector();
+    }
+
+    SweepSector swept;
+    swept.tick = _tick + 1;
+    swept.sector = _sweep_sector;
+    swept.sectors = _sweep_sectors;
+    swept.targets.reserve(_sector_offsets[_sweep_sector + 1] - _sector_offsets[_sweep_sector]);
+    for (uint32_t k = _sector_offsets[_sweep_sector]; k < _sector_offsets[_sweep_sector + 1]; ++k) {
+        if (Target* target = _targets.find(_sector_ids[k])) {
+            _motion.apply(*target);
+            swept.targets.push_back(*target);
+        }
+    }
+    if (_swept.size() >= static_cast<size_t>(_sweep_sectors)) {
+        _swept.erase(_swept.begin());
+    }
+    _swept.push_back(std::move(swept));
+
+    if (++_sweep_sector < _sweep_sectors) {
+        return;
+    }
+    _sweep_sector = 0;
+
+    TickSnapshot* snapshot = beginSnapshot();
+    size_t recorded = 0;
+    if (snapshot) {
+        for (const auto& target : _targets) {
+            if (!isExpired(target)) {
+                snapshot->set(recorded++, target);
+            }
+        }
+    }
+    ++_tick;
+    finishTick(snapshot, recorded);
+}
+
+// Counting sort of target ids by the sector of the bearing they are about
+// to take.
+void SimulationEngine::sortBySector() {
+    const double width = 2 * EIGEN_PI / _sweep_sectors;
+    _target_sector.resize(_targets.size());
+    std::fill(_sector_offsets.begin(), _sector_offsets.end(), 0u);
+    for (size_t i = 0; i < _targets.size(); ++i) {
+        const int sector = std::min(static_cast<int>(_motion.nextAngle(_targets[i]) / width), _sweep_sectors - 1);
+        _target_sector[i] = static_cast<uint16_t>(sector);
+        ++_sector_offsets[sector + 1];
+    }
+    for (int s = 0; s < _sweep_sectors; ++s) {
+        _sector_offsets[s + 1] += _sector_offsets[s];
+    }
+
+    _sector_ids.resize(_targets.size());
+    std::vector<uint32_t> fill(_sector_offsets.begin(), _sector_offsets.end() - 1);
+    for (size_t i = 0; i < _targets.size(); ++i) {
+        _sector_ids[fill[_target_sector[i]]++] = _targets[i].id;
+    }
+}
+
+void SimulationEngine::finishTick(TickSnapshot* snapshot, size_t recorded) {
+    despawnExpired();
+    if (_alarms) {
+        evaluateAlarms();
+    }
+    if (_sensor) {
+        _sensor->scan(_rng, _tick, _targets.empty() ? nullptr : &_targets[0], _targets.size(), *_plots);
+    }
+    if (_video) {
+        _video->scan(_rng, _tick, _targets.empty() ? nullptr : &_targets[0], _targets.size(), *_video_scan);
+        if (_detector) {
+            _detector->detect(*_video_scan, *_plots);
+        }
+        if (_clutter_map && _clutter_map->scans() % _clutter_map->config().snapshot_interval == 0) {
+            saveClutterMap();
+        }
+    }
+    if (_tracker) {
+        trackTargets();
+    }
+
+    if (snapshot) {
+        snapshot->count = recorded;
+        _history->append(*snapshot);
+    }
+    if (_recorder) {
+        recordTick();
+    }
+}
+
+TickSnapshot* SimulationEngine::beginSnapshot() {
+    if (!_history) {
+        return nullptr;
+    }
+    TickSnapshot* snapshot = _history_snapshot.get();
+    snapshot->tick = _tick + 1;
+    snapshot->count = 0;
+    if (snapshot->ids.size() < _targets.size()) {
+        snapshot->resize(_targets.size());
+    }
+    return snapshot;
+}
+
+// Once the expired targets are gone the motion columns hold exactly the
+// tick's targets. They are offered to the recorder in place and copied on
+// its thread while the simulation is idle; settleRecording() runs before
+// anything changes them. Colours go along once per target.
+void SimulationEngine::recordTick() {
+    _spawned_colors.clear();
+    for (int id : _unrecorded) {
+        if (const Target* target = _targets.find(id)) {
+            _spawned_colors.push_back({ id, { static_cast<float>(target->color.x()),
+                static_cast<float>(target->color.y()), static_cast<float>(target->color.z()) } });
+        }
+    }
+    if (_recorder->offerTick(_tick, _motion.positions(), _spawned_colors)) {
+        _unrecorded.clear();
+    }
+}
+
+void SimulationEngine::settleRecording() {
+    if (_recorder) {
+        _recorder->settle();
+    }
+}
+
+void SimulationEngine::replayStep() {
+    if (!_replayer->step(_events)) {
+        if (!_paused) {
+            std::cout << "Replay finished at tick " << _replayer->currentTick() << std::endl;
+            _paused = true;
+        }
+        return;
+    }
+    _tick = _replayer->currentTick();
+    if (_alarms) {
+        evaluateAlarms();
+    }
+
+    if (_history) {
+        const auto& frame = _replayer->targets();
+        TickSnapshot& snapshot = *_history_snapshot;
+        snapshot.tick = _tick;
+        snapshot.count = frame.size();
+        if (snapshot.ids.size() < frame.size()) {
+            snapshot.resize(frame.size());
+        }
+        for (size_t i = 0; i < frame.size(); ++i) {
+            snapshot.set(i, frame[i]);
+        }
+        _history->append(snapshot);
+    }
+}
+
+// With a sensor or a video detector, tracks are started, fed and deleted
+// from the plots alone, clutter included. Without either each target has a
+// filter fed its true position.
+void SimulationEngine::trackTargets() {
+    const auto start = std::chrono::steady_clock::now();
+    if (_sensor) {
+        const SensorConfig& sensor = _sensor->config();
+        _tracker->scan(*_plots, sensor.range_sigma, sensor.bearing_sigma, *_associator);
+    }
+    else if (_detector) {
+        _tracker->scan(*_plots, _detector->rangeSigma(), _detector->bearingSigma(), *_associator);
+    }
+    else {
+        _tracker->predict();
+        for (const auto& target : _targets) {
+            const Eigen::Vector2d p = target.position();
+            _tracker->observe(target.id, p.x(), p.y());
+        }
+        _tracker->update();
+    }
+    _track_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Nobody may be draining while no client is connected, so a backlog of
+// alarms is dropped oldest first rather than kept without bound. A live
+// simulation is read straight from the motion columns, which hold the same
+// targets once the expired ones are gone.
+void SimulationEngine::evaluateAlarms() {
+    constexpr size_t MAX_PENDING_ALARMS = 1 << 20;
+    if (_replayer) {
+        const auto& frame = _replayer->targets();
+        _alarms->evaluate(_tick, frame.data(), frame.size(), _alarm_events);
+    }
+    else {
+        const auto parts = _motion.columns();
+        _alarms->evaluate(_tick, parts.data(), parts.size(), _alarm_events);
+    }
+    if (_alarm_events.size() > MAX_PENDING_ALARMS) {
+        _alarm_events.erase(_alarm_events.begin(), _alarm_events.end() - MAX_PENDING_ALARMS);
+    }
+}
+
+// A failed snapshot costs a warm restart, not the simulation.
+void SimulationEngine::saveClutterMap() {
+    const std::string& path = _clutter_map->config().path;
+    if (path.empty()) {
+        return;
+    }
+    try {
+        _clutter_map->save(path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Clutter map snapshot failed: " << e.what() << std::endl;
+    }
+}
+
+WorkerPool& SimulationEngine::workers() {
+    if (!_workers) {
+        _workers = std::make_unique<WorkerPool>(_worker_threads);
+    }
+    return *_workers;
+}
+
+size_t SimulationEngine::spawn(size_t count) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    settleRecording();
+
+    if (_replayer) {
+        return 0;
+    }
+
+    size_t spawned = 0;
+    while (spawned < count && addTarget()) {
+        ++spawned;
+    }
+    return spawned;
+}
+
+size_t SimulationEngine::loadScenario(const Scenario& scenario) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    settleRecording();
+
+    const size_t room = _config.max_targets > _targets.size() ? _config.max_targets - _targets.size() : 0;
+    const size_t n = std::min(scenario.count(), room);
+    _targets.reserve(_targets.size() + n);
+    _events.reserve(_events.size() + n);
+
+    const double* dist = scenario.distances();
+    const double* ang = scenario.angles();
+    const double* dir = scenario.directions();
+    const float* red = scenario.reds();
+    const float* green = scenario.greens();
+    const float* blue = scenario.blues();
+
+    for (size_t i = 0; i < n; ++i) {
+        Target target(
+            _targets.nextHandle(),
+            dist[i],
+            ang[i],
+            dir[i],
+            Eigen::Vector3d(red[i], green[i], blue[i])
+        );
+        _motion.add(target, _motion.draw(_rng, static_cast<uint32_t>(_spawned_total + i), scenario.startTick()));
+        int id = _targets.insert(std::move(target));
+        _events.push_back({ TargetEvent::Type::Spawned, id });
+        if (_recorder) {
+            _unrecorded.push_back(id);
+        }
+    }
+
+    _tick = scenario.startTick();
+    _spawned_total += n;
+    return n;
+}
+
+void SimulationEngine::record(const std::string& path) {
+    auto recorder = std::make_unique<TickLogWriter>(path, _rng.seed(), TICK_INTERVAL);
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _recorder = std::move(recorder);
+    _unrecorded.clear();
+    for (const auto& target : _targets) {
+        _unrecorded.push_back(target.id);
+    }
+}
+
+void SimulationEngine::replay(std::unique_ptr<TickLog> log, double speed, uint64_t from_tick) {
+    if (speed <= 0.0) {
+        throw std::invalid_argument("Replay speed must be positive");
+    }
+    if (_running) {
+        throw std::logic_error("Replay must be set up before the engine starts");
+    }
+    if (_sweep_sectors > 0) {
+        throw std::logic_error("A replay cannot be swept");
     }
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    settleRecording();
+    _replayer = std::make_unique<TickReplayer>(std::move(log), from_tick);
+    _replay_speed = speed;
+    _targets.clear();
+    _motion.clear();
+    _events.clear();
+}
+
+void SimulationEngine::setMotion(const MotionConfig& config) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    settleRecording();
+    _motion.configure(config);
+}
+
+void SimulationEngine::enableHistory(const HistoryConfig& config) {
+    auto history = std::make_unique<HistoryStore>(config);
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _history = std::move(history);
+    _history_snapshot = std::make_unique<TickSnapshot>();
+}
+
+const HistoryStore* SimulationEngine::history() const {
+    return _history.get();
+}
+
+void SimulationEngine::setWorkerThreads(unsigned threads) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    if (_workers && _workers->threadCount() != threads) {
+        throw std::logic_error("Worker threads must be set before a stage uses them");
+    }
+    _worker_threads = threads;
+}
+
+void SimulationEngine::enableSensor(const SensorConfig& config) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _sensor = std::make_unique<Sensor>(config, workers());
+    _sensor->setOcclusion(_occlusion.get());
+    _plots = std::make_unique<PlotBatch>();
+}
+
+void SimulationEngine::enableVideo(const VideoConfig& config) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _video = std::make_unique<VideoGenerator>(config, _rng, workers());
+    _video->setOcclusion(_occlusion.get());
+    _video_scan = std::make_unique<VideoScan>();
+}
+
+void SimulationEngine::enableOcclusion(const std::vector<Obstacle>& obstacles) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _occlusion = std::make_unique<OcclusionMap>(obstacles);
+    if (_sensor) {
+        _sensor->setOcclusion(_occlusion.get());
+    }
+    if (_video) {
+        _video->setOcclusion(_occlusion.get());
+    }
+}
+
+void SimulationEngine::enableDetector(const CfarConfig& config) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    if (!_video) {
+        throw std::logic_error("Detection needs video");
+    }
+    if (_sensor) {
+        throw std::logic_error("Detection and the sensor model both produce plots");
+    }
+    _detector = std::make_unique<CfarDetector>(config, _video->config(), workers());
+    _plots = std::make_unique<PlotBatch>();
+}
+
+void SimulationEngine::enableClutterMap(const ClutterMapConfig& config) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    if (!_detector) {
+        throw std::logic_error("The clutter map needs detection");
+    }
+    const VideoConfig& video = _video->config();
+    auto map = std::make_unique<ClutterMap>(config, video.azimuths, video.range_bins);
+    if (!config.path.empty() && map->load(config.path)) {
+        std::cout << "Loaded clutter map from " << config.path << " (" << map->scans() << " scans)" << std::endl;
+    }
+    _detector->setClutterMap(map.get());
+    _clutter_map = std::move(map);
 }
 
-void SimulationEngine::addTarget() {
+void SimulationEngine::enableAlarms(const AlarmConfig& config) {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _alarms = std::make_unique<AlarmEngine>(config, workers());
+}
+
+void SimulationEngine::enableSweep(int sectors) {
+    if (sectors < 2 || sectors > 360) {
+        throw std::invalid_argument("A sweep needs 2 to 360 sectors");
+    }
+    if (_running) {
+        throw std::logic_error("Sweep must be set up before the engine starts");
+    }
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    if (_replayer) {
+        throw std::logic_error("A replay cannot be swept");
+    }
+    _sweep_sectors = sectors;
+    _sweep_sector = 0;
+    _sector_offsets.assign(sectors + 1, 0);
+}
+
+void SimulationEngine::enableTracking(const TrackerConfig& config, const AssociationConfig& association) {
+    auto tracker = std::make_unique<Tracker>(config);
+
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    _tracker = std::move(tracker);
+    _associator = std::make_unique<Associator>(association, workers());
+}
+
+bool SimulationEngine::addTarget() {
+    if (_targets.size() >= _config.max_targets) {
+        return false;
+    }
+
     try {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<> dis_dist(0, 200);
-        std::uniform_real_distribution<> dis_angle(0, 2 * EIGEN_PI);
+        const uint32_t seq = static_cast<uint32_t>(_spawned_total++);
+        const auto bits = _rng.block(RNG_STREAM_SPAWN, seq, _tick);
 
         Target new_target(
-            static_cast<int>(_targets.size() + 1),
-            dis_dist(gen),
-            dis_angle(gen),
-            dis_angle(gen),
-            generateRandomColor()
+            _targets.nextHandle(),
+            CounterRng::toUnit(bits[0]) * 200.0,
+            CounterRng::toUnit(bits[1]) * 2 * EIGEN_PI,
+            CounterRng::toUnit(bits[2]) * 2 * EIGEN_PI,
+            generateRandomColor(_rng.block(RNG_STREAM_COLOR, seq, _tick))
         );
 
-        _targets.push_back(new_target);
+        _motion.add(new_target, _motion.draw(_rng, seq, _tick));
+        int id = _targets.insert(std::move(new_target));
+        _events.push_back({ TargetEvent::Type::Spawned, id });
+        if (_recorder) {
+            _unrecorded.push_back(id);
+        }
+        return true;
     }
     catch (const std::exception& e) {
         std::cerr << "Error adding target: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void SimulationEngine::removeTarget(int id) {
+    if (_targets.erase(id)) {
+        _motion.remove(id);
+        // Tracks built from plots have ids of their own and die by themselves.
+        if (_tracker && !_plots) {
+            _tracker->drop(id);
+        }
+        _events.push_back({ TargetEvent::Type::Despawned, id });
     }
 }
 
+bool SimulationEngine::isExpired(const Target& t) const {
+    bool expired = _config.max_age_ticks > 0 && t.age >= _config.max_age_ticks;
+    bool outside = _config.despawn_outside_coverage && t.distance > MAX_DISTANCE;
+    return expired || outside;
+}
+
+void SimulationEngine::despawnExpired() {
+    for (size_t i = _targets.size(); i-- > 0; ) {
+        const Target& t = _targets[i];
+        if (isExpired(t)) {
+            removeTarget(t.id);
+        }
+    }
+}
+
+std::vector<TargetEvent> SimulationEngine::drainEvents() {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    std::vector<TargetEvent> events;
+    events.swap(_events);
+    return events;
+}
+
+std::vector<AlarmEvent> SimulationEngine::drainAlarms() {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    std::vector<AlarmEvent> alarms;
+    alarms.swap(_alarm_events);
+    return alarms;
+}
+
+std::vector<std::string> SimulationEngine::alarmRuleNames() const {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    std::vector<std::string> names;
+    if (_alarms) {
+        for (const auto& rule : _alarms->rules()) {
+            names.push_back(rule.name);
+        }
+    }
+    return names;
+}
+
+std::vector<SweepSector> SimulationEngine::drainSweep() {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    std::vector<SweepSector> swept;
+    swept.swap(_swept);
+    return swept;
+}
+
+uint64_t SimulationEngine::seed() const {
+    return _rng.seed();
+}
+
+size_t SimulationEngine::targetCount() const {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    return _replayer ? _replayer->targets().size() : _targets.size();
+}
+
 std::vector<Target> SimulationEngine::getTargets() const {
     std::lock_guard<std::mutex> lock(_data_mutex);
-    return _targets;
+    if (_replayer) {
+        return _replayer->targets();
+    }
+    return std::vector<Target>(_targets.begin(), _targets.end());
+}
+
+std::vector<TrackReport> SimulationEngine::getTracks() const {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    std::vector<TrackReport> tracks;
+    if (_tracker) {
+        _tracker->report(tracks);
+    }
+    return tracks;
+}
+
+TrackerStats SimulationEngine::getTrackerStats() const {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    TrackerStats stats{ _tick };
+    if (_tracker) {
+        stats.confirmed = static_cast<uint32_t>(_tracker->size());
+        stats.tentative = static_cast<uint32_t>(_tracker->tentativeCount());
+        stats.coasting = static_cast<uint32_t>(_tracker->coastingCount());
+        stats.tick_ms = _track_ms;
+    }
+    return stats;
+}
+
+bool SimulationEngine::isTracking() const {
+    return _tracker != nullptr;
+}
+
+PlotBatch SimulationEngine::getPlots() const {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    return _plots ? *_plots : PlotBatch{};
+}
+
+bool SimulationEngine::isSensing() const {
+    return _plots != nullptr;
+}
+
+VideoScan SimulationEngine::getVideo() const {
+    std::lock_guard<std::mutex> lock(_data_mutex);
+    return _video_scan ? *_video_scan : VideoScan{};
+}
+
+bool SimulationEngine::hasVideo() const {
+    return _video != nullptr;
 }
 
 bool SimulationEngine::isRunning() const {
@@ -122,4 +713,28 @@ bool SimulationEngine::isRunning() const {
 
 bool SimulationEngine::isPaused() const {
     return _paused;
-}
\ No newline at end of file
+}
+
+bool SimulationEngine::isReplaying() const {
+    return _replayer != nullptr;
+}
+
+bool SimulationEngine::isSweeping() const {
+    return _sweep_sectors > 0;
+}
+
+std::chrono::microseconds SimulationEngine::tickInterval() const {
+    if (!_replayer) {
+        return TICK_INTERVAL;
+    }
+    auto recorded = _replayer->log().tickInterval();
+    if (recorded.count() <= 0) {
+        recorded = TICK_INTERVAL;
+    }
+    return std::chrono::microseconds(std::max<int64_t>(1, static_cast<int64_t>(recorded.count() / _replay_speed)));
+}
+
+std::chrono::microseconds SimulationEngine::publishInterval() const {
+    const auto interval = tickInterval();
+    return _sweep_sectors > 0 ? interval / _sweep_sectors : interval;
+}
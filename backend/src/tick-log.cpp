@@ -0,0 +1,650 @@
+#include "tick-log.h"
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+static constexpr uint64_t COLUMN_ALIGN = 8;
+static constexpr std::chrono::milliseconds DRAIN_INTERVAL(100);
+
+static uint64_t columnBytes(size_t count, size_t elem_size) {
+    return (count * elem_size + COLUMN_ALIGN - 1) & ~(COLUMN_ALIGN - 1);
+}
+
+static uint64_t blockBytes(size_t count) {
+    return sizeof(TickBlockHeader)
+        + columnBytes(count, sizeof(int32_t))
+        + 3 * columnBytes(count, sizeof(double))
+        + 3 * columnBytes(count, sizeof(float));
+}
+
+TickLogWriter::TickLogWriter(
+    const std::string& path,
+    uint64_t seed,
+    std::chrono::microseconds tick_interval,
+    size_t max_pending
+) :
+    _out(path, std::ios::binary | std::ios::trunc),
+    _max_pending(max_pending)
+{
+    if (!_out) {
+        throw std::runtime_error("Failed to create " + path);
+    }
+
+    TickLogHeader header{};
+    std::memcpy(header.magic, TICK_LOG_MAGIC, sizeof(TICK_LOG_MAGIC));
+    header.version = TICK_LOG_VERSION;
+    header.header_size = sizeof(TickLogHeader);
+    header.seed = seed;
+    header.tick_interval_us = static_cast<uint64_t>(tick_interval.count());
+    _out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _offset = sizeof(header);
+
+    _thread = std::thread(&TickLogWriter::writeLoop, this);
+}
+
+TickLogWriter::~TickLogWriter() {
+    close();
+}
+
+void TickSnapshot::resize(size_t n) {
+    ids.resize(n);
+    distances.resize(n);
+    angles.resize(n);
+    directions.resize(n);
+    reds.resize(n);
+    greens.resize(n);
+    blues.resize(n);
+}
+
+TickView TickSnapshot::view() const {
+    return { tick, count, ids.data(), distances.data(), angles.data(), directions.data(),
+        reds.data(), greens.data(), blues.data() };
+}
+
+void TickColumns::clear() {
+    ids.clear();
+    xs.clear();
+    ys.clear();
+    headings.clear();
+    spawned.clear();
+}
+
+void TickColumns::append(const MotionPositions& part) {
+    ids.insert(ids.end(), part.ids, part.ids + part.count);
+    xs.insert(xs.end(), part.x, part.x + part.count);
+    ys.insert(ys.end(), part.y, part.y + part.count);
+    headings.insert(headings.end(), part.heading, part.heading + part.count);
+}
+
+enum TickDeltaColumn {
+    DELTA_ID,
+    DELTA_DISTANCE,
+    DELTA_ANGLE,
+    DELTA_DIRECTION,
+    DELTA_RED,
+    DELTA_GREEN,
+    DELTA_BLUE,
+    DELTA_COLUMNS
+};
+
+static uint32_t floatBits(float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+void TickDeltaCodec::advance(size_t count) {
+    _rows.swap(_previous);
+    std::swap(_row_index, _previous_index);
+    _rows.resize(count);
+    _row_index.clear();
+}
+
+const TickDeltaCodec::Row* TickDeltaCodec::previousRow(int32_t id) const {
+    const int* row = _previous_index.find(id);
+    return row ? &_previous[*row] : nullptr;
+}
+
+void TickDeltaCodec::reset(const TickView& keyframe) {
+    _previous.clear();
+    _previous_index.clear();
+    _rows.resize(keyframe.count);
+    _row_index.clear();
+    _tick = keyframe.tick;
+
+    for (size_t i = 0; i < keyframe.count; ++i) {
+        Row& row = _rows[i];
+        row.id = keyframe.ids[i];
+        row.distance = toFixed(keyframe.distances[i], 1.0 / TICK_DISTANCE_QUANTUM);
+        row.angle = toFixed(keyframe.angles[i], 1.0 / TICK_ANGLE_QUANTUM);
+        row.direction = toFixed(keyframe.directions[i], 1.0 / TICK_ANGLE_QUANTUM);
+        row.distance_step = 0;
+        row.angle_step = 0;
+        row.color[0] = floatBits(keyframe.reds[i]);
+        row.color[1] = floatBits(keyframe.greens[i]);
+        row.color[2] = floatBits(keyframe.blues[i]);
+        _row_index.set(row.id, static_cast<int>(i));
+    }
+}
+
+void TickDeltaCodec::encode(const TickSnapshot& snapshot, std::vector<uint8_t>& out) {
+    const size_t n = snapshot.count;
+    advance(n);
+    _tick = snapshot.tick;
+    uint64_t col[DELTA_COLUMNS][PACK_GROUP_SIZE];
+
+    for (size_t first = 0; first < n; first += PACK_GROUP_SIZE) {
+        const size_t last = std::min(n, first + PACK_GROUP_SIZE);
+        for (size_t i = first; i < last; ++i) {
+            Row& row = _rows[i];
+            row.id = snapshot.ids[i];
+            row.distance = toFixed(snapshot.distances[i], 1.0 / TICK_DISTANCE_QUANTUM);
+            row.angle = toFixed(snapshot.angles[i], 1.0 / TICK_ANGLE_QUANTUM);
+            row.direction = toFixed(snapshot.directions[i], 1.0 / TICK_ANGLE_QUANTUM);
+            row.color[0] = floatBits(snapshot.reds[i]);
+            row.color[1] = floatBits(snapshot.greens[i]);
+            row.color[2] = floatBits(snapshot.blues[i]);
+
+            const int32_t same_row_id = i < _previous.size() ? _previous[i].id : 0;
+            col[DELTA_ID][i - first] = zigzagEncode(int64_t{ row.id } - same_row_id);
+
+            if (const Row* prev = previousRow(row.id)) {
+                col[DELTA_DISTANCE][i - first] = zigzagEncode(row.distance - prev->distance - prev->distance_step);
+                col[DELTA_ANGLE][i - first] = zigzagEncode(row.angle - prev->angle - prev->angle_step);
+                col[DELTA_DIRECTION][i - first] = zigzagEncode(row.direction - prev->direction);
+                for (int c = 0; c < 3; ++c) {
+                    col[DELTA_RED + c][i - first] = row.color[c] ^ prev->color[c];
+                }
+                row.distance_step = row.distance - prev->distance;
+                row.angle_step = row.angle - prev->angle;
+            }
+            else {
+                col[DELTA_DISTANCE][i - first] = zigzagEncode(row.distance);
+                col[DELTA_ANGLE][i - first] = zigzagEncode(row.angle);
+                col[DELTA_DIRECTION][i - first] = zigzagEncode(row.direction);
+                for (int c = 0; c < 3; ++c) {
+                    col[DELTA_RED + c][i - first] = row.color[c];
+                }
+                row.distance_step = 0;
+                row.angle_step = 0;
+            }
+            _row_index.set(row.id, static_cast<int>(i));
+        }
+        for (int c = 0; c < DELTA_COLUMNS; ++c) {
+            packBits(col[c], last - first, out);
+        }
+    }
+}
+
+void TickDeltaCodec::decode(const uint8_t* in, uint64_t tick, size_t count) {
+    const size_t n = count;
+    advance(n);
+    _tick = tick;
+    _ids.resize(n);
+    _distances.resize(n);
+    _angles.resize(n);
+    _directions.resize(n);
+    _reds.resize(n);
+    _greens.resize(n);
+    _blues.resize(n);
+
+    uint64_t col[DELTA_COLUMNS][PACK_GROUP_SIZE];
+    for (size_t first = 0; first < n; first += PACK_GROUP_SIZE) {
+        const size_t last = std::min(n, first + PACK_GROUP_SIZE);
+        for (int c = 0; c < DELTA_COLUMNS; ++c) {
+            in = unpackBits(in, last - first, col[c]);
+        }
+        for (size_t i = first; i < last; ++i) {
+            Row& row = _rows[i];
+            const int32_t same_row_id = i < _previous.size() ? _previous[i].id : 0;
+            row.id = static_cast<int32_t>(same_row_id + zigzagDecode(col[DELTA_ID][i - first]));
+
+            const int64_t distance = zigzagDecode(col[DELTA_DISTANCE][i - first]);
+            const int64_t angle = zigzagDecode(col[DELTA_ANGLE][i - first]);
+            const int64_t direction = zigzagDecode(col[DELTA_DIRECTION][i - first]);
+            if (const Row* prev = previousRow(row.id)) {
+                row.distance = prev->distance + prev->distance_step + distance;
+                row.angle = prev->angle + prev->angle_step + angle;
+                row.direction = prev->direction + direction;
+                for (int c = 0; c < 3; ++c) {
+                    row.color[c] = prev->color[c] ^ static_cast<uint32_t>(col[DELTA_RED + c][i - first]);
+                }
+                row.distance_step = row.distance - prev->distance;
+                row.angle_step = row.angle - prev->angle;
+            }
+            else {
+                row.distance = distance;
+                row.angle = angle;
+                row.direction = direction;
+                for (int c = 0; c < 3; ++c) {
+                    row.color[c] = static_cast<uint32_t>(col[DELTA_RED + c][i - first]);
+                }
+                row.distance_step = 0;
+                row.angle_step = 0;
+            }
+            _row_index.set(row.id, static_cast<int>(i));
+
+            _ids[i] = row.id;
+            _distances[i] = row.distance * TICK_DISTANCE_QUANTUM;
+            _angles[i] = row.angle * TICK_ANGLE_QUANTUM;
+            _directions[i] = row.direction * TICK_ANGLE_QUANTUM;
+            _reds[i] = bitsFloat(row.color[0]);
+            _greens[i] = bitsFloat(row.color[1]);
+            _blues[i] = bitsFloat(row.color[2]);
+        }
+    }
+}
+
+TickView TickDeltaCodec::view() const {
+    return { _tick, _rows.size(), _ids.data(), _distances.data(), _angles.data(), _directions.data(),
+        _reds.data(), _greens.data(), _blues.data() };
+}
+
+bool TickLogWriter::offerTick(uint64_t tick, const std::array<MotionPositions, 4>& parts, const std::vector<TickColor>& spawned) {
+    settle();
+
+    std::unique_ptr<TickColumns> columns;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_closing || _failed || _pending.size() >= _max_pending) {
+            ++_dropped;
+            return false;
+        }
+        if (!_free.empty()) {
+            columns = std::move(_free.back());
+            _free.pop_back();
+        }
+    }
+    if (!columns) {
+        columns = std::make_unique<TickColumns>();
+    }
+    columns->clear();
+    columns->tick = tick;
+    columns->spawned = spawned;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _offered = std::move(columns);
+        _offered_parts = parts;
+    }
+    _cv.notify_one();
+    return true;
+}
+
+void TickLogWriter::settle() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_offered) {
+        takeOffer(lock);
+    }
+    _copied.wait(lock, [this] {
+        return !_copying;
+    });
+}
+
+// Copies the offered columns with the lock released. The offer cannot
+// change meanwhile: the next one waits in settle() until this is done.
+void TickLogWriter::takeOffer(std::unique_lock<std::mutex>& lock) {
+    auto columns = std::move(_offered);
+    _copying = true;
+    lock.unlock();
+    for (const auto& part : _offered_parts) {
+        columns->append(part);
+    }
+    lock.lock();
+    _pending.push_back(std::move(columns));
+    _copying = false;
+    _copied.notify_all();
+}
+
+// An offered tick is copied as soon as the writer wakes for it, but blocks
+// are written on a timer rather than every tick, so on a loaded (or
+// single-core) host encoding does not preempt the simulation thread in the
+// middle of update(). They are written early only when the queue backs up.
+void TickLogWriter::writeLoop() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto drain_at = std::chrono::steady_clock::now() + DRAIN_INTERVAL;
+    while (true) {
+        _cv.wait_until(lock, drain_at, [this] {
+            return _closing || _offered || _pending.size() >= _max_pending / 2;
+        });
+        if (_offered) {
+            takeOffer(lock);
+        }
+        if (!_closing && _pending.size() < _max_pending / 2 && std::chrono::steady_clock::now() < drain_at) {
+            continue;
+        }
+        drain_at = std::chrono::steady_clock::now() + DRAIN_INTERVAL;
+
+        // Drain everything queued, or each tick past the threshold would wake
+        // the writer again for a single block.
+        while (!_pending.empty()) {
+            auto columns = std::move(_pending.front());
+            _pending.pop_front();
+
+            lock.unlock();
+            if (_failed) {
+                ++_dropped;
+            }
+            else {
+                writeSnapshot(rows(*columns));
+            }
+            lock.lock();
+
+            _free.push_back(std::move(columns));
+        }
+        if (_closing) {
+            return;
+        }
+    }
+}
+
+// Polar rows as the motion model derives them; a colour arrives once, with
+// the first tick that carries its target.
+const TickSnapshot& TickLogWriter::rows(const TickColumns& columns) {
+    for (const auto& c : columns.spawned) {
+        _colors.set(c.id, { c.rgb[0], c.rgb[1], c.rgb[2] });
+    }
+
+    const size_t n = columns.ids.size();
+    _rows.tick = columns.tick;
+    _rows.count = n;
+    if (_rows.ids.size() < n) {
+        _rows.resize(n);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const double x = columns.xs[i];
+        const double y = columns.ys[i];
+        const double a = std::atan2(y, x);
+        _rows.ids[i] = columns.ids[i];
+        _rows.distances[i] = std::sqrt(x * x + y * y);
+        _rows.angles[i] = a < 0.0 ? a + 2 * EIGEN_PI : a;
+        _rows.directions[i] = columns.headings[i];
+
+        const std::array<float, 3>* color = _colors.find(columns.ids[i]);
+        _rows.reds[i] = color ? (*color)[0] : 0.0f;
+        _rows.greens[i] = color ? (*color)[1] : 0.0f;
+        _rows.blues[i] = color ? (*color)[2] : 0.0f;
+    }
+    return _rows;
+}
+
+void TickLogWriter::writeSnapshot(const TickSnapshot& snapshot) {
+    const size_t n = snapshot.count;
+
+    if (_index.size() % TICK_KEYFRAME_INTERVAL != 0) {
+        _delta.clear();
+        _codec.encode(snapshot, _delta);
+
+        TickBlockHeader header{};
+        header.magic = TICK_DELTA_MAGIC;
+        header.count = static_cast<uint32_t>(n);
+        header.tick = snapshot.tick;
+        header.size = sizeof(header) + columnBytes(_delta.size(), 1);
+
+        _out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeColumn(_delta.data(), _delta.size());
+        finishBlock(header);
+        return;
+    }
+    _codec.reset(snapshot.view());
+
+    TickBlockHeader header{};
+    header.magic = TICK_BLOCK_MAGIC;
+    header.count = static_cast<uint32_t>(n);
+    header.tick = snapshot.tick;
+    header.size = blockBytes(n);
+
+    _out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeColumn(snapshot.ids.data(), n * sizeof(int32_t));
+    writeColumn(snapshot.distances.data(), n * sizeof(double));
+    writeColumn(snapshot.angles.data(), n * sizeof(double));
+    writeColumn(snapshot.directions.data(), n * sizeof(double));
+    writeColumn(snapshot.reds.data(), n * sizeof(float));
+    writeColumn(snapshot.greens.data(), n * sizeof(float));
+    writeColumn(snapshot.blues.data(), n * sizeof(float));
+    finishBlock(header);
+}
+
+// A block that failed to write leaves the stream failed and the codec ahead
+// of what is on disk, so recording stops there; the blocks already written
+// stay readable without the index.
+void TickLogWriter::finishBlock(const TickBlockHeader& header) {
+    if (!_out) {
+        std::cerr << "Tick log write failed at tick " << header.tick << ", recording stopped" << std::endl;
+        _failed = true;
+        ++_dropped;
+        return;
+    }
+
+    _index.push_back({ header.tick, _offset });
+    _offset += header.size;
+    ++_written;
+}
+
+void TickLogWriter::writeColumn(const void* data, size_t bytes) {
+    static const char zeros[COLUMN_ALIGN] = {};
+    _out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    _out.write(zeros, static_cast<std::streamsize>(columnBytes(bytes, 1) - bytes));
+}
+
+void TickLogWriter::close() {
+    if (!_thread.joinable()) {
+        return;
+    }
+
+    settle();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closing = true;
+    }
+    _cv.notify_one();
+    _thread.join();
+    if (_failed) {
+        return;
+    }
+
+    TickLogFooter footer{};
+    footer.index_offset = _offset;
+    footer.tick_count = _index.size();
+    footer.magic = TICK_INDEX_MAGIC;
+
+    _out.write(reinterpret_cast<const char*>(_index.data()), static_cast<std::streamsize>(_index.size() * sizeof(TickIndexEntry)));
+    _out.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+    _out.close();
+}
+
+uint64_t TickLogWriter::writtenTicks() const {
+    return _written;
+}
+
+uint64_t TickLogWriter::droppedTicks() const {
+    return _dropped;
+}
+
+TickLog::TickLog(const std::string& path) :
+    _file(path)
+{
+    if (_file.size() < sizeof(TickLogHeader)) {
+        throw std::runtime_error("Tick log too small: " + path);
+    }
+    std::memcpy(&_header, _file.data(), sizeof(_header));
+
+    if (std::memcmp(_header.magic, TICK_LOG_MAGIC, sizeof(TICK_LOG_MAGIC)) != 0) {
+        throw std::runtime_error("Not a tick log: " + path);
+    }
+    if (_header.version != 1 && _header.version != TICK_LOG_VERSION) {
+        throw std::runtime_error("Unsupported tick log version " + std::to_string(_header.version));
+    }
+
+    TickLogFooter footer{};
+    if (_file.size() >= _header.header_size + sizeof(footer)) {
+        std::memcpy(&footer, _file.data() + _file.size() - sizeof(footer), sizeof(footer));
+    }
+
+    const uint64_t index_bytes = footer.tick_count * sizeof(TickIndexEntry);
+    if (footer.magic == TICK_INDEX_MAGIC && footer.index_offset + index_bytes + sizeof(footer) == _file.size()) {
+        _index.resize(footer.tick_count);
+        std::memcpy(_index.data(), _file.data() + footer.index_offset, index_bytes);
+        return;
+    }
+
+    uint64_t offset = _header.header_size;
+    while (offset + sizeof(TickBlockHeader) <= _file.size()) {
+        TickBlockHeader block;
+        std::memcpy(&block, _file.data() + offset, sizeof(block));
+        const bool valid = block.magic == TICK_BLOCK_MAGIC
+            ? block.size == blockBytes(block.count)
+            : block.magic == TICK_DELTA_MAGIC && block.size >= sizeof(block);
+        if (!valid || offset + block.size > _file.size()) {
+            break;
+        }
+        _index.push_back({ block.tick, offset });
+        offset += block.size;
+    }
+    std::cerr << "Tick log " << path << " has no index, recovered " << _index.size() << " ticks" << std::endl;
+}
+
+size_t TickLog::tickCount() const {
+    return _index.size();
+}
+
+uint64_t TickLog::seed() const {
+    return _header.seed;
+}
+
+std::chrono::microseconds TickLog::tickInterval() const {
+    return std::chrono::microseconds(_header.tick_interval_us);
+}
+
+TickBlockHeader TickLog::blockHeader(size_t i) const {
+    TickBlockHeader header;
+    std::memcpy(&header, _file.data() + _index[i].offset, sizeof(header));
+    return header;
+}
+
+TickView TickLog::tick(size_t i) {
+    const TickBlockHeader header = blockHeader(i);
+    if (header.magic == TICK_BLOCK_MAGIC) {
+        const TickView view = rawView(i);
+        _codec.reset(view);
+        _decoded = i;
+        return view;
+    }
+
+    if (_decoded == SIZE_MAX || _decoded + 1 != i) {
+        size_t key = i;
+        while (key > 0 && blockHeader(key).magic != TICK_BLOCK_MAGIC) {
+            --key;
+        }
+        _codec.reset(rawView(key));
+        for (size_t j = key + 1; j < i; ++j) {
+            const TickBlockHeader skipped = blockHeader(j);
+            _codec.decode(_file.data() + _index[j].offset + sizeof(skipped), skipped.tick, skipped.count);
+        }
+    }
+
+    _codec.decode(_file.data() + _index[i].offset + sizeof(header), header.tick, header.count);
+    _decoded = i;
+    return _codec.view();
+}
+
+TickView TickLog::rawView(size_t i) const {
+    const uint8_t* base = _file.data() + _index[i].offset;
+    const TickBlockHeader header = blockHeader(i);
+
+    const size_t n = header.count;
+    const uint8_t* p = base + sizeof(header);
+    auto next = [&p, n](size_t elem_size) {
+        const uint8_t* column = p;
+        p += columnBytes(n, elem_size);
+        return column;
+    };
+
+    TickView view;
+    view.tick = header.tick;
+    view.count = n;
+    view.ids = reinterpret_cast<const int32_t*>(next(sizeof(int32_t)));
+    view.distances = reinterpret_cast<const double*>(next(sizeof(double)));
+    view.angles = reinterpret_cast<const double*>(next(sizeof(double)));
+    view.directions = reinterpret_cast<const double*>(next(sizeof(double)));
+    view.reds = reinterpret_cast<const float*>(next(sizeof(float)));
+    view.greens = reinterpret_cast<const float*>(next(sizeof(float)));
+    view.blues = reinterpret_cast<const float*>(next(sizeof(float)));
+    return view;
+}
+
+size_t TickLog::findTick(uint64_t tick) const {
+    auto it = std::lower_bound(_index.begin(), _index.end(), tick, [](const TickIndexEntry& e, uint64_t t) {
+        return e.tick < t;
+    });
+    return static_cast<size_t>(it - _index.begin());
+}
+
+TickReplayer::TickReplayer(std::unique_ptr<TickLog> log, uint64_t from_tick) :
+    _log(std::move(log))
+{
+    _next = _log->findTick(from_tick);
+}
+
+bool TickReplayer::step(std::vector<TargetEvent>& events) {
+    if (_next >= _log->tickCount()) {
+        return false;
+    }
+
+    const TickView view = _log->tick(_next++);
+    _current_tick = view.tick;
+
+    _frame.swap(_previous);
+    std::swap(_frame_index, _previous_index);
+    _frame.clear();
+    _frame_index.clear();
+    _frame.reserve(view.count);
+
+    for (size_t i = 0; i < view.count; ++i) {
+        const int id = view.ids[i];
+        const int* prev = _previous_index.find(id);
+        if (prev) {
+            Target t = _previous[*prev];
+            t.moveTo(view.distances[i], view.angles[i], view.directions[i]);
+            _frame.push_back(t);
+        }
+        else {
+            _frame.emplace_back(
+                id,
+                view.distances[i],
+                view.angles[i],
+                view.directions[i],
+                Eigen::Vector3d(view.reds[i], view.greens[i], view.blues[i])
+            );
+            events.push_back({ TargetEvent::Type::Spawned, id });
+        }
+        _frame_index.set(id, static_cast<int>(i));
+    }
+
+    for (const Target& t : _previous) {
+        if (!_frame_index.find(t.id)) {
+            events.push_back({ TargetEvent::Type::Despawned, t.id });
+        }
+    }
+    return true;
+}
+
+const std::vector<Target>& TickReplayer::targets() const {
+    return _frame;
+}
+
+const TickLog& TickReplayer::log() const {
+    return *_log;
+}
+
+uint64_t TickReplayer::currentTick() const {
+    return _current_tick;
+}
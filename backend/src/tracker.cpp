@@ -0,0 +1,600 @@
+#include "tracker.h"
+#include "sensor.h"
+#include <cmath>
+#include <bit>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+template<typename... Columns>
+void swapOut(size_t index, size_t last, Columns&... columns) {
+    ((columns[index] = columns[last], columns.pop_back()), ...);
+}
+
+double wrapAngle(double a) {
+    return a < 0.0 ? a + 2 * EIGEN_PI : a;
+}
+
+struct PlotPoint {
+    double x;
+    double y;
+    double rxx;
+    double rxy;
+    double ryy;
+};
+
+PlotPoint plotPoint(const PlotBatch& plots, size_t index, double range_sigma, double bearing_sigma) {
+    const double distance = plots.distances[index];
+    const double angle = plots.angles[index];
+    PlotPoint point{};
+    point.x = distance * std::cos(angle);
+    point.y = distance * std::sin(angle);
+    plotCovariance(distance, angle, range_sigma, bearing_sigma, point.rxx, point.rxy, point.ryy);
+    return point;
+}
+
+// Predicted position and innovation covariance of a plot taken there.
+template<typename Bank>
+void fillGates(const Bank& bank, double range_sigma, double bearing_sigma, std::vector<TrackGate>& out) {
+    out.resize(bank.size());
+    for (uint32_t i = 0; i < bank.size(); ++i) {
+        const KalmanBank::Vector s = bank.state(i);
+        const KalmanBank::Matrix p = bank.covariance(i);
+        double rxx, rxy, ryy;
+        plotCovariance(std::hypot(s(0), s(1)), std::atan2(s(1), s(0)), range_sigma, bearing_sigma, rxx, rxy, ryy);
+        out[i] = { s(0), s(1), p(0, 0) + rxx, p(0, 1) + rxy, p(1, 1) + ryy };
+    }
+}
+
+}
+
+KalmanBank::KalmanBank(const TrackerConfig& config) :
+    _config(config)
+{
+}
+
+KalmanBank::Matrix KalmanBank::transition(double dt) {
+    Matrix f = Matrix::Identity();
+    f(0, 2) = dt;
+    f(1, 3) = dt;
+    return f;
+}
+
+// Discretised white-noise acceleration, independent per axis.
+KalmanBank::Matrix KalmanBank::processNoise(double dt, double q) {
+    const double dt2 = dt * dt;
+    Matrix noise = Matrix::Zero();
+    for (int axis = 0; axis < 2; ++axis) {
+        noise(axis, axis) = q * dt2 * dt2 / 4;
+        noise(axis, axis + 2) = q * dt2 * dt / 2;
+        noise(axis + 2, axis) = q * dt2 * dt / 2;
+        noise(axis + 2, axis + 2) = q * dt2;
+    }
+    return noise;
+}
+
+uint32_t KalmanBank::add(int id, const Vector& state, const Matrix& covariance) {
+    const uint32_t index = static_cast<uint32_t>(_ids.size());
+    _ids.push_back(id);
+    if (index % LANES == 0) {
+        _blocks.resize(_blocks.size() + FIELDS * LANES, 0.0);
+    }
+    for (int i = 0; i < STATE; ++i) {
+        at(FIELD_X + i, index) = state(i);
+        for (int j = i; j < STATE; ++j) {
+            at(FIELD_P + sym(i, j), index) = covariance(i, j);
+        }
+    }
+    clearMeasurement(index);
+    return index;
+}
+
+int KalmanBank::remove(uint32_t index) {
+    const size_t last = _ids.size() - 1;
+    _ids[index] = _ids[last];
+    _ids.pop_back();
+    for (int field = 0; field < FIELDS; ++field) {
+        at(field, index) = at(field, last);
+    }
+    if (last % LANES == 0) {
+        _blocks.resize(_blocks.size() - FIELDS * LANES);
+    }
+    return index < _ids.size() ? _ids[index] : -1;
+}
+
+void KalmanBank::clear() {
+    _ids.clear();
+    _blocks.clear();
+    _pending = false;
+}
+
+// Unmeasured tracks carry a unit measurement covariance so the gain
+// computation stays finite; their zero flag makes the gain zero.
+void KalmanBank::clearMeasurement(size_t index) {
+    at(FIELD_ZX, index) = 0.0;
+    at(FIELD_ZY, index) = 0.0;
+    at(FIELD_RXX, index) = 1.0;
+    at(FIELD_RXY, index) = 0.0;
+    at(FIELD_RYY, index) = 1.0;
+    at(FIELD_HAS_MEASUREMENT, index) = 0.0;
+}
+
+// x' = F x and P' = F P F' + Q with F the constant-velocity transition,
+// written out per unique entry of P'. Entries are overwritten only after
+// every entry that reads them. The lane loop has a fixed trip count over
+// one block, so it vectorises.
+void KalmanBank::predict(double dt) {
+    const Matrix q = processNoise(dt, _config.process_noise);
+    const double dt2 = dt * dt;
+
+    const size_t blocks = _blocks.size() / (FIELDS * LANES);
+    for (size_t b = 0; b < blocks; ++b) {
+        double* d = &_blocks[b * FIELDS * LANES];
+        auto x = [d](int i) {
+            return Eigen::Map<Lanes>(d + slot(FIELD_X + i, 0));
+        };
+        auto p = [d](int i, int j) {
+            return Eigen::Map<Lanes>(d + slot(FIELD_P + sym(i, j), 0));
+        };
+        x(0) += dt * x(2);
+        x(1) += dt * x(3);
+
+        p(0, 0) += 2 * dt * p(0, 2) + dt2 * p(2, 2) + q(0, 0);
+        p(0, 1) += dt * (p(0, 3) + p(1, 2)) + dt2 * p(2, 3) + q(0, 1);
+        p(0, 2) += dt * p(2, 2) + q(0, 2);
+        p(0, 3) += dt * p(2, 3) + q(0, 3);
+        p(1, 1) += 2 * dt * p(1, 3) + dt2 * p(3, 3) + q(1, 1);
+        p(1, 2) += dt * p(2, 3) + q(1, 2);
+        p(1, 3) += dt * p(3, 3) + q(1, 3);
+        p(2, 2) += q(2, 2);
+        p(2, 3) += q(2, 3);
+        p(3, 3) += q(3, 3);
+    }
+}
+
+void KalmanBank::setMeasurement(uint32_t index, double x, double y, double rxx, double rxy, double ryy) {
+    at(FIELD_ZX, index) = x;
+    at(FIELD_ZY, index) = y;
+    at(FIELD_RXX, index) = rxx;
+    at(FIELD_RXY, index) = rxy;
+    at(FIELD_RYY, index) = ryy;
+    at(FIELD_HAS_MEASUREMENT, index) = 1.0;
+    _pending = true;
+}
+
+// Position measurement, H = [I 0]. The measurement flag is folded into the
+// inverse innovation covariance, so unmeasured tracks get a zero gain and
+// the loop runs without branches; the same pass clears what was staged.
+void KalmanBank::update() {
+    if (!_pending) {
+        return;
+    }
+
+    const size_t blocks = _blocks.size() / (FIELDS * LANES);
+    for (size_t b = 0; b < blocks; ++b) {
+        double* d = &_blocks[b * FIELDS * LANES];
+        auto lanes = [d](int field) {
+            return Eigen::Map<Lanes>(d + slot(field, 0));
+        };
+
+        Lanes row0[STATE], row1[STATE];
+        for (int k = 0; k < STATE; ++k) {
+            row0[k] = lanes(FIELD_P + sym(0, k));
+            row1[k] = lanes(FIELD_P + sym(1, k));
+        }
+
+        const Lanes s00 = row0[0] + lanes(FIELD_RXX);
+        const Lanes s01 = row0[1] + lanes(FIELD_RXY);
+        const Lanes s11 = row1[1] + lanes(FIELD_RYY);
+        const Lanes scale = lanes(FIELD_HAS_MEASUREMENT) / (s00 * s11 - s01 * s01);
+        const Lanes i00 = s11 * scale;
+        const Lanes i01 = -s01 * scale;
+        const Lanes i11 = s00 * scale;
+        const Lanes y0 = lanes(FIELD_ZX) - lanes(FIELD_X);
+        const Lanes y1 = lanes(FIELD_ZY) - lanes(FIELD_X + 1);
+
+        for (int k = 0; k < STATE; ++k) {
+            const Lanes gain0 = row0[k] * i00 + row1[k] * i01;
+            const Lanes gain1 = row0[k] * i01 + row1[k] * i11;
+            lanes(FIELD_X + k) += gain0 * y0 + gain1 * y1;
+            for (int j = k; j < STATE; ++j) {
+                lanes(FIELD_P + sym(k, j)) -= gain0 * row0[j] + gain1 * row1[j];
+            }
+        }
+
+        lanes(FIELD_RXX).setOnes();
+        lanes(FIELD_RXY).setZero();
+        lanes(FIELD_RYY).setOnes();
+        lanes(FIELD_HAS_MEASUREMENT).setZero();
+    }
+    _pending = false;
+}
+
+KalmanBank::Vector KalmanBank::state(uint32_t index) const {
+    return { at(FIELD_X, index), at(FIELD_X + 1, index), at(FIELD_X + 2, index), at(FIELD_X + 3, index) };
+}
+
+KalmanBank::Matrix KalmanBank::covariance(uint32_t index) const {
+    Matrix covariance;
+    for (int i = 0; i < STATE; ++i) {
+        for (int j = 0; j < STATE; ++j) {
+            covariance(i, j) = at(FIELD_P + sym(i, j), index);
+        }
+    }
+    return covariance;
+}
+
+TrackModel parseTrackModel(const std::string& name) {
+    if (name == "cv") {
+        return TrackModel::ConstantVelocity;
+    }
+    if (name == "imm") {
+        return TrackModel::Interacting;
+    }
+    throw std::invalid_argument("Unknown track model: " + name);
+}
+
+TrackingError trackingError(const std::vector<TrackReport>& tracks, const std::vector<Target>& truth) {
+    HandleTable<uint32_t> index;
+    for (uint32_t i = 0; i < truth.size(); ++i) {
+        index.set(truth[i].id, i);
+    }
+
+    TrackingError error;
+    size_t moving = 0;
+    double position = 0.0;
+    double velocity = 0.0;
+    for (const TrackReport& track : tracks) {
+        const uint32_t* found = index.find(track.id);
+        if (!found) {
+            continue;
+        }
+        const Target& target = truth[*found];
+        const Eigen::Vector2d estimate = track.distance * Eigen::Vector2d(std::cos(track.angle), std::sin(track.angle));
+        position += (estimate - target.position()).squaredNorm();
+        ++error.matched;
+
+        if (target.age > 0) {
+            const auto& last = target.trail[TRAIL_SIZE];
+            const auto& before = target.trail[TRAIL_SIZE - 1];
+            const Eigen::Vector2d displacement = last.x() * Eigen::Vector2d(std::cos(last.y()), std::sin(last.y()))
+                - before.x() * Eigen::Vector2d(std::cos(before.y()), std::sin(before.y()));
+            const Eigen::Vector2d estimated = track.speed * Eigen::Vector2d(std::cos(track.heading), std::sin(track.heading));
+            velocity += (estimated - displacement).squaredNorm();
+            ++moving;
+        }
+    }
+    if (error.matched > 0) {
+        error.position_rmse = std::sqrt(position / error.matched);
+    }
+    if (moving > 0) {
+        error.velocity_rmse = std::sqrt(velocity / moving);
+    }
+    return error;
+}
+
+Tracker::Tracker(const TrackerConfig& config) :
+    _config(config),
+    _bank(std::in_place_type<KalmanBank>, config),
+    _tentative(config),
+    _initiator_grid(MAX_DISTANCE, std::max(config.max_initiation_speed, 1.0))
+{
+    if (config.confirm_hits < 1 || config.confirm_window < config.confirm_hits || config.confirm_window > 16) {
+        throw std::invalid_argument("Track confirmation needs 1 <= M <= N <= 16");
+    }
+    if (config.delete_score >= config.confirm_score) {
+        throw std::invalid_argument("Track confirmation needs delete_score < confirm_score");
+    }
+    if (config.max_initiation_speed <= 0.0 || config.detection_probability <= 0.0 || config.detection_probability >= 1.0) {
+        throw std::invalid_argument("Track initiation needs a positive speed and a detection probability within (0, 1)");
+    }
+    if (config.quality_decay < 0.0 || config.quality_decay >= 1.0) {
+        throw std::invalid_argument("Track quality decay must be within [0, 1)");
+    }
+    if (config.model == TrackModel::Interacting) {
+        _bank.emplace<ImmBank>(config.imm);
+    }
+}
+
+void Tracker::predict(double dt) {
+    std::visit([dt](auto& bank) { bank.predict(dt); }, _bank);
+    _tentative.predict(dt);
+}
+
+void Tracker::observe(int id, double x, double y) {
+    const double r = _config.measurement_sigma * _config.measurement_sigma;
+    observe(id, x, y, r, 0.0, r);
+}
+
+void Tracker::observe(int id, double x, double y, double rxx, double rxy, double ryy) {
+    if (const uint32_t* index = _index.find(id)) {
+        observeAt(*index, x, y, rxx, rxy, ryy);
+        return;
+    }
+    addConfirmed(id, KalmanBank::Vector(x, y, 0.0, 0.0), initialCovariance(rxx, rxy, ryy));
+}
+
+void Tracker::observeAt(uint32_t index, double x, double y, double rxx, double rxy, double ryy) {
+    std::visit([&](auto& bank) { bank.setMeasurement(index, x, y, rxx, rxy, ryy); }, _bank);
+}
+
+void Tracker::update() {
+    std::visit([](auto& bank) { bank.update(); }, _bank);
+    _tentative.update();
+}
+
+void Tracker::drop(int id) {
+    if (const uint32_t* index = _index.find(id)) {
+        removeConfirmed(*index);
+    }
+}
+
+void Tracker::clear() {
+    std::visit([](auto& bank) { bank.clear(); }, _bank);
+    _index.clear();
+    _quality.clear();
+    _misses.clear();
+    _tentative.clear();
+    _tentative_hits.clear();
+    _tentative_age.clear();
+    _tentative_score.clear();
+    _initiator_xs.clear();
+    _initiator_ys.clear();
+    _initiator_r.clear();
+}
+
+KalmanBank::Matrix Tracker::initialCovariance(double rxx, double rxy, double ryy) const {
+    const double v = _config.initial_speed_sigma * _config.initial_speed_sigma;
+    KalmanBank::Matrix covariance = KalmanBank::Matrix::Zero();
+    covariance.diagonal() << rxx, ryy, v, v;
+    covariance(0, 1) = rxy;
+    covariance(1, 0) = rxy;
+    return covariance;
+}
+
+uint32_t Tracker::addConfirmed(int id, const KalmanBank::Vector& state, const KalmanBank::Matrix& covariance) {
+    const uint32_t index = std::visit([&](auto& bank) { return bank.add(id, state, covariance); }, _bank);
+    _index.set(id, index);
+    _quality.push_back(1.0);
+    _misses.push_back(0);
+    return index;
+}
+
+void Tracker::removeConfirmed(uint32_t index) {
+    _index.erase(std::visit([index](const auto& bank) { return bank.id(index); }, _bank));
+    const int moved = std::visit([index](auto& bank) { return bank.remove(index); }, _bank);
+    swapOut(index, _quality.size() - 1, _quality, _misses);
+    if (moved >= 0) {
+        _index.set(moved, index);
+    }
+}
+
+void Tracker::removeTentative(uint32_t index) {
+    _tentative.remove(index);
+    swapOut(index, _tentative_hits.size() - 1, _tentative_hits, _tentative_age, _tentative_score);
+}
+
+// Track ids only need to be unique among live tracks: a track would have to
+// outlive millions of later confirmations before two ids shared an index slot.
+int Tracker::nextTrackId() {
+    const int id = _next_id;
+    _next_id = _next_id == std::numeric_limits<int>::max() ? 0 : _next_id + 1;
+    return id;
+}
+
+void Tracker::scan(const PlotBatch& plots, double range_sigma, double bearing_sigma, Associator& associator, double dt) {
+    predict(dt);
+
+    gates(range_sigma, bearing_sigma, _gates);
+    associator.associate(_gates, plots, _track_plot);
+    _plot_used.assign(plots.size(), 0);
+    updateConfirmed(plots, range_sigma, bearing_sigma);
+
+    _leftover.tick = plots.tick;
+    _leftover.detections = 0;
+    _leftover.resize(plots.size());
+    _leftover_plot.resize(plots.size());
+    size_t left = 0;
+    for (size_t p = 0; p < plots.size(); ++p) {
+        if (!_plot_used[p]) {
+            _leftover.distances[left] = plots.distances[p];
+            _leftover.angles[left] = plots.angles[p];
+            _leftover.target_ids[left] = plots.target_ids[p];
+            _leftover_plot[left] = static_cast<uint32_t>(p);
+            ++left;
+        }
+    }
+    _leftover.resize(left);
+    _leftover_plot.resize(left);
+
+    // Plots no confirmed track explains are taken as clutter spread evenly
+    // over the coverage; at least one, so a clean scan still has a density.
+    const double density = std::max<double>(left, 1.0) / (EIGEN_PI * MAX_DISTANCE * MAX_DISTANCE);
+
+    fillGates(_tentative, range_sigma, bearing_sigma, _gates);
+    associator.associate(_gates, _leftover, _track_plot);
+    updateTentative(range_sigma, bearing_sigma, density);
+
+    update();
+    promoteAndDelete();
+    startTracks(range_sigma, bearing_sigma, density, dt);
+}
+
+void Tracker::updateConfirmed(const PlotBatch& plots, double range_sigma, double bearing_sigma) {
+    const double decay = _config.quality_decay;
+    for (uint32_t i = 0; i < _track_plot.size(); ++i) {
+        const int32_t plot = _track_plot[i];
+        if (plot < 0) {
+            _quality[i] *= decay;
+            _misses[i] = static_cast<uint16_t>(std::min<int>(_misses[i] + 1, UINT16_MAX));
+            continue;
+        }
+        _quality[i] = decay * _quality[i] + (1.0 - decay);
+        _misses[i] = 0;
+        _plot_used[plot] = 1;
+        const PlotPoint z = plotPoint(plots, plot, range_sigma, bearing_sigma);
+        observeAt(i, z.x, z.y, z.rxx, z.rxy, z.ryy);
+    }
+}
+
+// Score of a hit: the gated innovation density against the clutter density,
+// so the same hit is worth less the more clutter could have produced it.
+void Tracker::updateTentative(double range_sigma, double bearing_sigma, double density) {
+    const uint32_t window = (1u << _config.confirm_window) - 1;
+    const double pd = _config.detection_probability;
+    const double miss_score = std::log(1.0 - pd);
+    for (uint32_t i = 0; i < _track_plot.size(); ++i) {
+        const int32_t plot = _track_plot[i];
+        _tentative_hits[i] = ((_tentative_hits[i] << 1) | (plot >= 0 ? 1u : 0u)) & window;
+        _tentative_age[i] = static_cast<uint8_t>(std::min<int>(_tentative_age[i] + 1, UINT8_MAX));
+        if (plot < 0) {
+            _tentative_score[i] += miss_score;
+            continue;
+        }
+        _plot_used[_leftover_plot[plot]] = 1;
+        const PlotPoint z = plotPoint(_leftover, plot, range_sigma, bearing_sigma);
+        _tentative.setMeasurement(i, z.x, z.y, z.rxx, z.rxy, z.ryy);
+
+        const TrackGate& g = _gates[i];
+        const double det = g.sxx * g.syy - g.sxy * g.sxy;
+        const double dx = z.x - g.x;
+        const double dy = z.y - g.y;
+        const double d2 = (g.syy * dx * dx - 2.0 * g.sxy * dx * dy + g.sxx * dy * dy) / det;
+        _tentative_score[i] += std::log(pd / (density * 2.0 * EIGEN_PI * std::sqrt(det))) - 0.5 * d2;
+    }
+}
+
+// M of N: a tentative track is confirmed on its M-th hit if its score has
+// also cleared confirm_score, and dropped as soon as the scans left in its
+// window can no longer bring it there or its score falls below delete_score.
+void Tracker::promoteAndDelete() {
+    const int m = _config.confirm_hits;
+    const int n = _config.confirm_window;
+    for (uint32_t i = 0; i < _tentative.size();) {
+        const int hits = std::popcount(_tentative_hits[i]);
+        if (hits >= m && _tentative_score[i] >= _config.confirm_score) {
+            addConfirmed(nextTrackId(), _tentative.state(i), _tentative.covariance(i));
+            removeTentative(i);
+        }
+        else if (hits + std::max(0, n - _tentative_age[i]) < m || _tentative_score[i] < _config.delete_score) {
+            removeTentative(i);
+        }
+        else {
+            ++i;
+        }
+    }
+
+    for (uint32_t i = 0; i < _quality.size();) {
+        if (_quality[i] < _config.delete_quality) {
+            removeConfirmed(i);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+// Two-point initiation. A plot no track took is paired with the nearest
+// free plot of the previous scan within max_initiation_speed, and the pair
+// starts a tentative track at the velocity between them. A pair is scored
+// like a plot against the clutter expected within that reach; when one
+// would start below delete_score the scan is too cluttered to start
+// anything, and nothing is indexed or kept for the next one either.
+void Tracker::startTracks(double range_sigma, double bearing_sigma, double density, double dt) {
+    const double reach = _config.max_initiation_speed * dt;
+    const double start_score = -std::log(density * EIGEN_PI * reach * reach);
+    // So much clutter lies within reach of each plot that any pair would be
+    // dropped straight away; start nothing rather than pair every plot.
+    if (start_score < _config.delete_score) {
+        _initiator_xs.clear();
+        _initiator_ys.clear();
+        _initiator_r.clear();
+        return;
+    }
+
+    _initiator_grid.build(_initiator_xs, _initiator_ys);
+    _initiator_used.assign(_initiator_r.size(), 0);
+    _unpaired_xs.clear();
+    _unpaired_ys.clear();
+    _unpaired_r.clear();
+
+    for (uint32_t k = 0; k < _leftover.size(); ++k) {
+        if (_plot_used[_leftover_plot[k]]) {
+            continue;
+        }
+        const PlotPoint z = plotPoint(_leftover, k, range_sigma, bearing_sigma);
+        int from = -1;
+        double from_d2 = std::numeric_limits<double>::max();
+        _initiator_grid.forEachInRadius(z.x, z.y, reach, [&](uint32_t i, double d2) {
+            if (!_initiator_used[i] && d2 < from_d2) {
+                from = static_cast<int>(i);
+                from_d2 = d2;
+            }
+        });
+        if (from < 0) {
+            _unpaired_xs.push_back(z.x);
+            _unpaired_ys.push_back(z.y);
+            _unpaired_r.push_back({ z.rxx, z.rxy, z.ryy });
+            continue;
+        }
+        _initiator_used[from] = 1;
+
+        // x = z, v = (z - z0) / dt, with z and z0 independent.
+        const auto& r0 = _initiator_r[from];
+        const Eigen::Vector2d z0(_initiator_xs[from], _initiator_ys[from]);
+        Eigen::Matrix2d r;
+        r << z.rxx, z.rxy, z.rxy, z.ryy;
+        Eigen::Matrix2d r_from;
+        r_from << r0[0], r0[1], r0[1], r0[2];
+        KalmanBank::Matrix covariance;
+        covariance << r, r / dt, r / dt, (r + r_from) / (dt * dt);
+        const Eigen::Vector2d velocity = (Eigen::Vector2d(z.x, z.y) - z0) / dt;
+        _tentative.add(-1, KalmanBank::Vector(z.x, z.y, velocity.x(), velocity.y()), covariance);
+        // Both plots of the pair are hits.
+        _tentative_hits.push_back(0b11);
+        _tentative_age.push_back(2);
+        _tentative_score.push_back(start_score);
+    }
+    std::swap(_initiator_xs, _unpaired_xs);
+    std::swap(_initiator_ys, _unpaired_ys);
+    std::swap(_initiator_r, _unpaired_r);
+}
+
+void Tracker::gates(double range_sigma, double bearing_sigma, std::vector<TrackGate>& out) const {
+    std::visit([&](const auto& bank) { fillGates(bank, range_sigma, bearing_sigma, out); }, _bank);
+}
+
+void Tracker::report(std::vector<TrackReport>& out) const {
+    std::visit([&](const auto& bank) {
+        out.clear();
+        out.reserve(bank.size());
+        for (uint32_t i = 0; i < bank.size(); ++i) {
+            const KalmanBank::Vector s = bank.state(i);
+            const KalmanBank::Matrix p = bank.covariance(i);
+            out.push_back({
+                bank.id(i),
+                std::hypot(s(0), s(1)),
+                wrapAngle(std::atan2(s(1), s(0))),
+                wrapAngle(std::atan2(s(3), s(2))),
+                std::hypot(s(2), s(3)),
+                std::sqrt(0.5 * (p(0, 0) + p(1, 1)))
+            });
+        }
+    }, _bank);
+}
+
+size_t Tracker::size() const {
+    return std::visit([](const auto& bank) { return bank.size(); }, _bank);
+}
+
+size_t Tracker::tentativeCount() const {
+    return _tentative.size();
+}
+
+size_t Tracker::coastingCount() const {
+    return static_cast<size_t>(std::count_if(_misses.begin(), _misses.end(), [](uint16_t misses) {
+        return misses > 0;
+    }));
+}
@@ -0,0 +1,234 @@
+#include "video.h"
+#include <algorithm>
+#include <stdexcept>
+#include <Eigen/Dense>
+
+namespace {
+
+constexpr int CLUTTER_PATCH_SPOKES = 2;
+constexpr double CLUTTER_PATCH_LENGTH = 32.0;   // metres
+constexpr float LN2 = 0.69314718f;
+constexpr float DB_PER_NEPER = 8.68588964f;     // 20 / ln 10
+
+// Noise is kept as a real amplitude. Only an echo's phase relative to the
+// noise matters for their sum, and that is uniform per cell, so each echo
+// gets a random phase per scan advanced by an irrational step per bin.
+constexpr float PHASE_STEP = 2.39996323f;
+
+double dbToPower(double db) {
+    return std::pow(10.0, db / 10.0);
+}
+
+}
+
+VideoGenerator::VideoGenerator(const VideoConfig& config, const CounterRng& rng, WorkerPool& workers) :
+    _config(config),
+    _workers(workers),
+    _spoke_offsets(config.azimuths + 1)
+{
+    if (config.azimuths < 8 || config.azimuths > 65535 || config.range_bins < 16 || config.range_bins > 65535) {
+        throw std::invalid_argument("Video needs 8 to 65535 spokes and 16 to 65535 range bins");
+    }
+    if (config.beam_width <= 0.0 || config.pulse_length <= 0.0 || config.clutter_range <= 0.0
+        || config.display_range <= 0.0) {
+        throw std::invalid_argument("Beam width, pulse length, clutter range and display range must be positive");
+    }
+
+    _azimuth_step = 2 * EIGEN_PI / config.azimuths;
+    _bin_length = MAX_DISTANCE / config.range_bins;
+    _beam_spokes = std::min(static_cast<int>(std::ceil(config.beam_width / _azimuth_step)), (config.azimuths - 1) / 2);
+    buildClutterMap(rng);
+}
+
+void VideoGenerator::setOcclusion(const OcclusionMap* occlusion) {
+    _occlusion = occlusion;
+}
+
+const VideoConfig& VideoGenerator::config() const {
+    return _config;
+}
+
+// Land clutter does not move, so its mean power per cell is drawn once:
+// log-normal patches over a range law, flat out to clutter_range. Patch
+// levels are interpolated in range, so the clutter has slopes rather than
+// a step at every patch edge.
+void VideoGenerator::buildClutterMap(const CounterRng& rng) {
+    const int azimuths = _config.azimuths;
+    const int bins = _config.range_bins;
+    const int patch_rows = (azimuths + CLUTTER_PATCH_SPOKES - 1) / CLUTTER_PATCH_SPOKES;
+    const int patch_cols = static_cast<int>(std::ceil(MAX_DISTANCE / CLUTTER_PATCH_LENGTH)) + 1;
+
+    std::vector<double> patch_db(size_t(patch_rows) * patch_cols);
+    for (size_t i = 0; i < patch_db.size(); ++i) {
+        const auto bits = rng.block(RNG_STREAM_VIDEO_CLUTTER, static_cast<uint32_t>(i), 0);
+        const double z = std::sqrt(-2.0 * std::log(CounterRng::toUnit(bits[0])))
+            * std::cos(2 * EIGEN_PI * CounterRng::toUnit(bits[1]));
+        patch_db[i] = _config.clutter_spread * z;
+    }
+
+    _noise_sigma.resize(size_t(azimuths) * bins);
+    for (int s = 0; s < azimuths; ++s) {
+        const double* levels = patch_db.data() + size_t(s / CLUTTER_PATCH_SPOKES) * patch_cols;
+        float* sigma = _noise_sigma.data() + size_t(s) * bins;
+        for (int b = 0; b < bins; ++b) {
+            const double r = (b + 0.5) * _bin_length;
+            const double falloff = std::min(1.0, std::pow(_config.clutter_range / r, 3.0));
+            const double x = r / CLUTTER_PATCH_LENGTH;
+            const int col = std::min(static_cast<int>(x), patch_cols - 2);
+            const double db = levels[col] + (x - col) * (levels[col + 1] - levels[col]);
+            sigma[b] = static_cast<float>(std::sqrt(1.0 + dbToPower(_config.clutter_cnr + db) * falloff));
+        }
+    }
+}
+
+void VideoGenerator::scan(const CounterRng& rng, uint64_t tick, const Target* targets, size_t count, VideoScan& out) {
+    sortTargets(rng, tick, targets, count);
+
+    const int bins = _config.range_bins;
+    out.tick = tick;
+    out.azimuths = _config.azimuths;
+    out.range_bins = bins;
+    out.amplitude.resize(size_t(_config.azimuths) * bins);
+    out.intensity.resize(out.amplitude.size());
+
+    _workers.parallelFor(_config.azimuths, 4, [&](size_t begin, size_t end) {
+        std::vector<float> echo_i(bins, 0.0f);
+        std::vector<float> echo_q(bins, 0.0f);
+        std::vector<float> scratch(bins);
+        std::vector<int> touched;
+        for (size_t s = begin; s < end; ++s) {
+            float* amplitude = out.amplitude.data() + s * bins;
+            generateSpoke(rng, tick, static_cast<int>(s), amplitude, echo_i.data(), echo_q.data(), touched);
+            compress(amplitude, scratch.data(), out.intensity.data() + s * bins);
+        }
+    });
+}
+
+// Counting sort by the spoke each target's bearing falls in, so a spoke
+// only looks at the few spokes within a beam width of it.
+void VideoGenerator::sortTargets(const CounterRng& rng, uint64_t tick, const Target* targets, size_t count) {
+    const int azimuths = _config.azimuths;
+    _target_spoke.resize(count);
+    std::fill(_spoke_offsets.begin(), _spoke_offsets.end(), 0u);
+
+    for (size_t i = 0; i < count; ++i) {
+        const Target& t = targets[i];
+        if (t.distance >= MAX_DISTANCE || (_occlusion && !_occlusion->visible(t.distance, t.angle))) {
+            _target_spoke[i] = -1;
+            continue;
+        }
+        double angle = std::fmod(t.angle, 2 * EIGEN_PI);
+        angle = angle < 0.0 ? angle + 2 * EIGEN_PI : angle;
+        const int spoke = std::min(static_cast<int>(angle / _azimuth_step), azimuths - 1);
+        _target_spoke[i] = spoke;
+        ++_spoke_offsets[spoke + 1];
+    }
+    for (int s = 0; s < azimuths; ++s) {
+        _spoke_offsets[s + 1] += _spoke_offsets[s];
+    }
+
+    const size_t sorted = _spoke_offsets[azimuths];
+    _echo_range.resize(sorted);
+    _echo_angle.resize(sorted);
+    _echo_phase.resize(sorted);
+    _spoke_fill.assign(_spoke_offsets.begin(), _spoke_offsets.end() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        const int spoke = _target_spoke[i];
+        if (spoke < 0) {
+            continue;
+        }
+        const Target& t = targets[i];
+        const uint32_t k = _spoke_fill[spoke]++;
+        const auto bits = rng.block(RNG_STREAM_ECHO, static_cast<uint32_t>(t.id), tick);
+        _echo_range[k] = static_cast<float>(t.distance);
+        _echo_angle[k] = static_cast<float>(t.angle);
+        _echo_phase[k] = static_cast<float>(2 * EIGEN_PI * CounterRng::toUnit(bits[0]));
+    }
+}
+
+void VideoGenerator::generateSpoke(const CounterRng& rng, uint64_t tick, int azimuth, float* amplitude,
+    float* echo_i, float* echo_q, std::vector<int>& touched) const {
+    const int bins = _config.range_bins;
+    const uint32_t blocks = static_cast<uint32_t>(bins + 3) / 4;
+    const uint32_t id_base = static_cast<uint32_t>(azimuth) * blocks;
+
+    // Uniforms four to a Philox block, then Rayleigh amplitudes sqrt(-ln u),
+    // which have unit mean power, scaled by the cell's noise and clutter.
+    int b = 0;
+    for (uint32_t j = 0; j < blocks; ++j) {
+        const auto bits = rng.block(RNG_STREAM_VIDEO, id_base + j, tick);
+        for (int k = 0; k < 4 && b < bins; ++k, ++b) {
+            amplitude[b] = static_cast<float>(CounterRng::toUnit(bits[k]));
+        }
+    }
+    Eigen::Map<Eigen::ArrayXf> a(amplitude, bins);
+    Eigen::Map<const Eigen::ArrayXf> sigma(_noise_sigma.data() + size_t(azimuth) * bins, bins);
+    a = sigma * (-a.log()).sqrt();
+
+    const float peak = static_cast<float>(std::pow(10.0, _config.target_snr / 20.0));
+    const float beam_width = static_cast<float>(_config.beam_width);
+    const float beam_k = 2.0f * LN2 / (beam_width * beam_width);
+    const float pulse_bins = static_cast<float>(_config.pulse_length / _bin_length);
+    const float pulse_k = 2.0f * LN2 / (pulse_bins * pulse_bins);
+    const float bin_length = static_cast<float>(_bin_length);
+    const double centre = (azimuth + 0.5) * _azimuth_step;
+
+    // Along an echo both the Gaussian pulse and the phase rotation are
+    // stepped by recurrence, leaving a few multiplies per cell.
+    const float ratio_step = std::exp(-2.0f * pulse_k);
+    const float rotate_c = std::cos(PHASE_STEP);
+    const float rotate_s = std::sin(PHASE_STEP);
+
+    const int azimuths = _config.azimuths;
+    for (int d = -_beam_spokes; d <= _beam_spokes; ++d) {
+        const int spoke = (azimuth + d + azimuths) % azimuths;
+        for (uint32_t t = _spoke_offsets[spoke]; t < _spoke_offsets[spoke + 1]; ++t) {
+            const float theta = static_cast<float>(std::remainder(_echo_angle[t] - centre, 2 * EIGEN_PI));
+            if (std::abs(theta) > beam_width) {
+                continue;
+            }
+            const float centre_bin = _echo_range[t] / bin_length - 0.5f;
+            const int lo = std::max(0, static_cast<int>(std::ceil(centre_bin - pulse_bins)));
+            const int hi = std::min(bins - 1, static_cast<int>(std::floor(centre_bin + pulse_bins)));
+
+            const float x = lo - centre_bin;
+            float e = peak * std::exp(-beam_k * theta * theta - pulse_k * x * x);
+            float ratio = std::exp(-pulse_k * (2.0f * x + 1.0f));
+            const float phase = _echo_phase[t] + PHASE_STEP * lo;
+            float c = std::cos(phase);
+            float s = std::sin(phase);
+            for (int cell = lo; cell <= hi; ++cell) {
+                if (echo_i[cell] == 0.0f && echo_q[cell] == 0.0f) {
+                    touched.push_back(cell);
+                }
+                echo_i[cell] += e * c;
+                echo_q[cell] += e * s;
+                e *= ratio;
+                ratio *= ratio_step;
+                const float next_c = c * rotate_c - s * rotate_s;
+                s = c * rotate_s + s * rotate_c;
+                c = next_c;
+            }
+        }
+    }
+
+    for (int cell : touched) {
+        amplitude[cell] = std::hypot(amplitude[cell] + echo_i[cell], echo_q[cell]);
+        echo_i[cell] = 0.0f;
+        echo_q[cell] = 0.0f;
+    }
+    touched.clear();
+}
+
+void VideoGenerator::compress(const float* amplitude, float* scratch, uint8_t* intensity) const {
+    const int bins = _config.range_bins;
+    const float scale = static_cast<float>(255.0 / _config.display_range);
+    const float offset = static_cast<float>(-_config.display_floor) * scale;
+
+    Eigen::Map<const Eigen::ArrayXf> a(amplitude, bins);
+    Eigen::Map<Eigen::ArrayXf> level(scratch, bins);
+    level = (a.max(1e-6f).log() * (DB_PER_NEPER * scale) + offset).max(0.0f).min(255.0f);
+    for (int b = 0; b < bins; ++b) {
+        intensity[b] = static_cast<uint8_t>(scratch[b] + 0.5f);
+    }
+}
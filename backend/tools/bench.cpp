@@ -0,0 +1,1443 @@
+#include "sim-engine.h"
+#include "scenario.h"
+#include "tick-log.h"
+#include "history-store.h"
+#include "track-codec.h"
+#include "motion-model.h"
+#include "tracker.h"
+#include "sensor.h"
+#include "occlusion.h"
+#include "alarms.h"
+#include "association.h"
+#include "video.h"
+#include "cfar.h"
+#include "clutter-map.h"
+#include "scan-converter.h"
+#include "spatial-grid.h"
+#include <iostream>
+#include <cmath>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <stdexcept>
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+static std::vector<size_t> parseSizes(const std::string& list) {
+    std::vector<size_t> sizes;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t comma = list.find(',', pos);
+        sizes.push_back(std::stoull(list.substr(pos, comma - pos)));
+        pos = comma == std::string::npos ? list.size() : comma + 1;
+    }
+    return sizes;
+}
+
+static std::vector<size_t> sizesArg(int argc, char** argv, std::vector<size_t> defaults) {
+    for (int i = 0; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--sizes") {
+            return parseSizes(argv[i + 1]);
+        }
+    }
+    return defaults;
+}
+
+static int benchScenario(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 10000, 100000, 1000000 });
+
+    std::cout << std::setw(10) << "targets" << std::setw(12) << "file MiB"
+        << std::setw(12) << "map ms" << std::setw(12) << "load ms" << std::setw(12) << "total ms" << '\n';
+
+    for (size_t n : sizes) {
+        const auto path = (std::filesystem::temp_directory_path() / ("radar_bench_" + std::to_string(n) + ".scn")).string();
+        Scenario::write(path, generateScenario({ n, ScenarioDistribution::Uniform, 8, 1 }));
+        const double mib = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+
+        auto t0 = Clock::now();
+        double map_ms = 0.0;
+        double load_ms = 0.0;
+        {
+            Scenario scenario(path);
+            map_ms = elapsedMs(t0);
+
+            auto t1 = Clock::now();
+            LifecycleConfig config;
+            config.max_targets = n;
+            SimulationEngine engine(config, scenario.seed());
+            engine.loadScenario(scenario);
+            load_ms = elapsedMs(t1);
+        }
+        const double total_ms = elapsedMs(t0);
+        std::filesystem::remove(path);
+
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(10) << n << std::setw(12) << mib
+            << std::setw(12) << map_ms << std::setw(12) << load_ms << std::setw(12) << total_ms << '\n';
+    }
+    return 0;
+}
+
+static double median(std::vector<double>& samples) {
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Two engines with the same seed tick alternately (in alternating order),
+// one of them recording, so machine noise hits both equally. Only time inside update() counts; the
+// pause between ticks lets the recorder thread drain, as the server's tick
+// period does.
+static int benchRecord(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 10000, 100000 });
+    constexpr int TICKS = 100;
+
+    std::cout << std::setw(10) << "targets" << std::setw(12) << "plain ms" << std::setw(12) << "record ms"
+        << std::setw(12) << "overhead" << std::setw(10) << "ticks" << std::setw(12) << "log MiB" << '\n';
+
+    for (size_t n : sizes) {
+        const auto path = (std::filesystem::temp_directory_path() / ("radar_bench_" + std::to_string(n) + ".tlog")).string();
+        std::vector<double> plain(TICKS);
+        std::vector<double> recorded(TICKS);
+        {
+            LifecycleConfig config;
+            config.spawn_interval_ticks = 0;
+            config.despawn_outside_coverage = false;
+            config.max_targets = n;
+            SimulationEngine plain_engine(config, 1);
+            SimulationEngine record_engine(config, 1);
+            plain_engine.spawn(n);
+            record_engine.spawn(n);
+            record_engine.record(path);
+
+            auto t0 = Clock::now();
+            plain_engine.update();
+            const auto gap = std::max<std::chrono::microseconds>(
+                std::chrono::microseconds(static_cast<int64_t>(elapsedMs(t0) * 2000)),
+                std::chrono::milliseconds(20));
+
+            auto timedUpdate = [](SimulationEngine& engine) {
+                auto start = Clock::now();
+                engine.update();
+                return elapsedMs(start);
+            };
+            for (int i = 0; i < TICKS; ++i) {
+                if (i % 2 == 0) {
+                    plain[i] = timedUpdate(plain_engine);
+                    recorded[i] = timedUpdate(record_engine);
+                }
+                else {
+                    recorded[i] = timedUpdate(record_engine);
+                    plain[i] = timedUpdate(plain_engine);
+                }
+                std::this_thread::sleep_for(gap);
+            }
+        }
+
+        const double plain_ms = median(plain);
+        const double record_ms = median(recorded);
+        const size_t ticks = TickLog(path).tickCount();
+        const double mib = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+        std::filesystem::remove(path);
+
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(10) << n << std::setw(12) << plain_ms << std::setw(12) << record_ms
+            << std::setw(11) << std::setprecision(1) << (record_ms / plain_ms - 1.0) * 100.0 << '%'
+            << std::setw(10) << ticks << std::setw(12) << mib << '\n';
+    }
+    return 0;
+}
+
+// Query latency against result size over a full in-memory history.
+static int benchHistory(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 10000 });
+
+    for (size_t n : sizes) {
+        LifecycleConfig config;
+        config.spawn_interval_ticks = 0;
+        config.despawn_outside_coverage = false;
+        config.max_targets = n;
+        SimulationEngine engine(config, 1);
+        HistoryConfig history_config;
+        engine.enableHistory(history_config);
+        engine.spawn(n);
+
+        const int ticks = history_config.chunk_ticks * static_cast<int>(history_config.memory_chunks);
+        auto t0 = Clock::now();
+        for (int i = 0; i < ticks; ++i) {
+            engine.update();
+        }
+        std::cout << n << " targets, " << ticks << " ticks of history built in "
+            << std::fixed << std::setprecision(1) << elapsedMs(t0) << " ms" << '\n';
+
+        // Give the history thread time to seal the last chunk, so the queries
+        // below hit indexed chunks only.
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        struct Query {
+            const char* name;
+            HistoryRegion region;
+        };
+        const uint64_t last = static_cast<uint64_t>(ticks);
+        const Query queries[] = {
+            { "region 5deg 50m 8 ticks", { 400.0, 450.0, 10.0, 15.0, last - 8, last } },
+            { "region 30deg 200m 64 ticks", { 300.0, 500.0, 350.0, 20.0, last - 64, last } },
+            { "region 90deg 500m 256 ticks", { 0.0, 500.0, 0.0, 90.0, last - 256, last } },
+            { "region all", { 0.0, MAX_DISTANCE, 0.0, 360.0, 0, last } },
+        };
+
+        std::cout << std::setw(30) << std::left << "query" << std::right
+            << std::setw(12) << "states" << std::setw(12) << "ms" << std::setw(14) << "Mstates/s" << '\n';
+
+        auto report = [](const char* name, size_t found, double ms) {
+            std::cout << std::setw(30) << std::left << name << std::right << std::setw(12) << found
+                << std::setw(12) << std::setprecision(3) << ms
+                << std::setw(14) << std::setprecision(1) << (ms > 0.0 ? found / ms / 1000.0 : 0.0) << '\n';
+        };
+        auto ignore = [](const std::vector<HistoryRecord>&) {};
+
+        for (const Query& q : queries) {
+            t0 = Clock::now();
+            size_t found = engine.history()->queryRegion(q.region, ignore);
+            report(q.name, found, elapsedMs(t0));
+        }
+
+        const int id = engine.getTargets().front().id;
+        t0 = Clock::now();
+        size_t found = engine.history()->queryTrack(id, 0, last, ignore);
+        report("track, full history", found, elapsedMs(t0));
+    }
+    return 0;
+}
+
+// Compression ratio and throughput (median of REPEATS runs) of the track
+// codec on simulated tracks, against 24 bytes per raw (tick, x, y) point, plus the size of a recorded
+// tick log against its raw-block equivalent.
+static int benchCodec(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 1000 });
+    constexpr int TICKS = 1024;
+    constexpr int REPEATS = 5;
+    constexpr double QUANTA[] = { 0.01, 0.05, 0.25, 1.0 };
+
+    for (size_t n : sizes) {
+        const auto log_path = (std::filesystem::temp_directory_path() / ("radar_bench_codec_" + std::to_string(n) + ".tlog")).string();
+        std::vector<std::vector<TrackPoint>> tracks(n);
+        {
+            LifecycleConfig config;
+            config.spawn_interval_ticks = 0;
+            config.despawn_outside_coverage = false;
+            config.max_targets = n;
+            SimulationEngine engine(config, 1);
+            engine.spawn(n);
+            engine.record(log_path);
+
+            for (int tick = 0; tick < TICKS; ++tick) {
+                engine.update();
+                const auto targets = engine.getTargets();
+                for (size_t i = 0; i < targets.size() && i < n; ++i) {
+                    const Eigen::Vector2d p = targets[i].position();
+                    tracks[i].push_back({ static_cast<uint64_t>(tick), p.x(), p.y() });
+                }
+            }
+        }
+
+        size_t points = 0;
+        for (const auto& track : tracks) {
+            points += track.size();
+        }
+        std::cout << n << " tracks, " << points << " points" << '\n';
+        std::cout << std::setw(10) << "quantum" << std::setw(12) << "bits/pt" << std::setw(10) << "ratio"
+            << std::setw(16) << "encode Mpt/s" << std::setw(16) << "decode Mpt/s" << '\n';
+
+        for (double quantum : QUANTA) {
+            std::vector<double> encode_ms(REPEATS);
+            std::vector<double> decode_ms(REPEATS);
+            size_t bytes = 0;
+
+            for (int r = 0; r < REPEATS; ++r) {
+                std::vector<CompressedTrack> encoded(n, CompressedTrack(quantum));
+
+                auto t0 = Clock::now();
+                for (size_t i = 0; i < n; ++i) {
+                    for (const TrackPoint& p : tracks[i]) {
+                        encoded[i].append(p.tick, p.x, p.y);
+                    }
+                }
+                encode_ms[r] = elapsedMs(t0);
+
+                bytes = 0;
+                for (const auto& track : encoded) {
+                    bytes += track.byteSize();
+                }
+
+                std::vector<TrackPoint> decoded;
+                decoded.reserve(TICKS);
+                t0 = Clock::now();
+                size_t checksum = 0;
+                for (const auto& track : encoded) {
+                    decoded.clear();
+                    track.decode(0, UINT64_MAX, decoded);
+                    checksum += decoded.size();
+                }
+                decode_ms[r] = elapsedMs(t0);
+                if (checksum != points) {
+                    throw std::runtime_error("Decoded point count mismatch");
+                }
+            }
+
+            std::cout << std::fixed << std::setw(10) << std::setprecision(2) << quantum
+                << std::setw(12) << std::setprecision(2) << bytes * 8.0 / points
+                << std::setw(9) << std::setprecision(1) << points * 24.0 / bytes << 'x'
+                << std::setw(16) << points / median(encode_ms) / 1000.0
+                << std::setw(16) << points / median(decode_ms) / 1000.0 << '\n';
+        }
+
+        const double log_bytes = static_cast<double>(std::filesystem::file_size(log_path));
+        const double raw_bytes = TickLog(log_path).tickCount() * (sizeof(TickBlockHeader) + n * (sizeof(int32_t) + 3 * sizeof(double) + 3 * sizeof(float)));
+        std::filesystem::remove(log_path);
+        std::cout << "tick log: " << std::setprecision(2) << log_bytes / (1024.0 * 1024.0) << " MiB, "
+            << std::setprecision(1) << raw_bytes / log_bytes << "x smaller than raw blocks" << '\n';
+    }
+    return 0;
+}
+
+// Tick time per motion model: the whole update() and the model step alone.
+static int benchMotion(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 100000 });
+    constexpr int TICKS = 30;
+    const std::vector<std::vector<MotionModel>> groups = {
+        { MotionModel::ConstantVelocity },
+        { MotionModel::CoordinatedTurn },
+        { MotionModel::ConstantAcceleration },
+        { MotionModel::RandomWalk },
+        { MotionModel::ConstantVelocity, MotionModel::CoordinatedTurn,
+          MotionModel::ConstantAcceleration, MotionModel::RandomWalk },
+    };
+
+    std::cout << std::setw(10) << "targets" << std::setw(10) << "model" << std::setw(12) << "update ms"
+        << std::setw(12) << "step ms" << std::setw(14) << "step ns/tgt" << '\n';
+
+    for (size_t n : sizes) {
+        for (const auto& models : groups) {
+            MotionConfig motion;
+            motion.models = models;
+            motion.min_speed = 5.0;
+            motion.max_speed = 30.0;
+
+            LifecycleConfig config;
+            config.spawn_interval_ticks = 0;
+            config.despawn_outside_coverage = false;
+            config.max_targets = n;
+            SimulationEngine engine(config, 1);
+            engine.setMotion(motion);
+            engine.spawn(n);
+
+            MotionSystem system;
+            system.configure(motion);
+            CounterRng rng(1);
+            for (const auto& target : engine.getTargets()) {
+                system.add(target, system.draw(rng, static_cast<uint32_t>(target.id), 0));
+            }
+
+            std::vector<double> update(TICKS);
+            std::vector<double> step(TICKS);
+            for (int i = 0; i < TICKS; ++i) {
+                auto t0 = Clock::now();
+                engine.update();
+                update[i] = elapsedMs(t0);
+
+                auto t1 = Clock::now();
+                system.step(rng, static_cast<uint64_t>(i));
+                step[i] = elapsedMs(t1);
+            }
+
+            const double step_ms = median(step);
+            std::cout << std::fixed << std::setprecision(3)
+                << std::setw(10) << n << std::setw(10) << (models.size() == 1 ? motionModelName(models[0]) : "mixed")
+                << std::setw(12) << median(update) << std::setw(12) << step_ms
+                << std::setw(14) << std::setprecision(2) << step_ms * 1e6 / n << '\n';
+        }
+    }
+    return 0;
+}
+
+// Batched filter bank against the textbook per-track form with Matrix4d
+// products, on the same straight-line tracks and noisy position fixes.
+static int benchTracker(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 10000, 100000 });
+    constexpr int TICKS = 20;
+    using Vector = KalmanBank::Vector;
+    using Matrix = KalmanBank::Matrix;
+
+    std::cout << std::setw(10) << "tracks" << std::setw(12) << "bank ms" << std::setw(12) << "ns/track"
+        << std::setw(12) << "naive ms" << std::setw(10) << "speedup" << std::setw(12) << "rmse m" << '\n';
+
+    for (size_t n : sizes) {
+        TrackerConfig config;
+        CounterRng rng(7);
+        auto gaussian = [&rng](uint32_t id, uint64_t tick) {
+            const auto bits = rng.block(RNG_STREAM_MOTION, id, tick);
+            const double u1 = std::max(CounterRng::toUnit(bits[0]), 1e-12);
+            return std::sqrt(-2.0 * std::log(u1)) * std::cos(2 * EIGEN_PI * CounterRng::toUnit(bits[1]));
+        };
+
+        std::vector<Vector> truth(n);
+        for (size_t i = 0; i < n; ++i) {
+            const auto bits = rng.block(RNG_STREAM_SPAWN, static_cast<uint32_t>(i), 0);
+            const double heading = 2 * EIGEN_PI * CounterRng::toUnit(bits[0]);
+            truth[i] = Vector(0.0, 0.0, 20.0 * std::cos(heading), 20.0 * std::sin(heading));
+        }
+
+        const double r = config.measurement_sigma * config.measurement_sigma;
+        const double v = config.initial_speed_sigma * config.initial_speed_sigma;
+        Matrix initial = Matrix::Zero();
+        initial.diagonal() << r, r, v, v;
+
+        KalmanBank bank(config);
+        std::vector<Vector> naive_x(n, Vector::Zero());
+        std::vector<Matrix> naive_p(n, initial);
+        for (size_t i = 0; i < n; ++i) {
+            bank.add(static_cast<int>(i), Vector::Zero(), initial);
+        }
+
+        const Matrix f = KalmanBank::transition(1.0);
+        const Matrix q = KalmanBank::processNoise(1.0, config.process_noise);
+        Eigen::Matrix<double, 2, 4> h = Eigen::Matrix<double, 2, 4>::Zero();
+        h(0, 0) = 1.0;
+        h(1, 1) = 1.0;
+        const Eigen::Matrix2d rm = Eigen::Matrix2d::Identity() * r;
+
+        std::vector<double> bank_ms(TICKS);
+        std::vector<double> naive_ms(TICKS);
+        std::vector<Eigen::Vector2d> z(n);
+        for (int tick = 1; tick <= TICKS; ++tick) {
+            for (size_t i = 0; i < n; ++i) {
+                truth[i].head<2>() += truth[i].tail<2>();
+                const uint32_t id = static_cast<uint32_t>(i);
+                z[i] = truth[i].head<2>() + config.measurement_sigma
+                    * Eigen::Vector2d(gaussian(id, 2 * tick), gaussian(id, 2 * tick + 1));
+            }
+
+            auto t0 = Clock::now();
+            bank.predict(1.0);
+            for (size_t i = 0; i < n; ++i) {
+                bank.setMeasurement(static_cast<uint32_t>(i), z[i].x(), z[i].y(), r, 0.0, r);
+            }
+            bank.update();
+            bank_ms[tick - 1] = elapsedMs(t0);
+
+            auto t1 = Clock::now();
+            for (size_t i = 0; i < n; ++i) {
+                Vector& x = naive_x[i];
+                Matrix& p = naive_p[i];
+                x = f * x;
+                p = f * p * f.transpose() + q;
+                const Eigen::Matrix2d s = h * p * h.transpose() + rm;
+                const Eigen::Matrix<double, 4, 2> k = p * h.transpose() * s.inverse();
+                x += k * (z[i] - h * x);
+                p -= k * h * p;
+            }
+            naive_ms[tick - 1] = elapsedMs(t1);
+        }
+
+        double squared = 0.0;
+        double mismatch = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            const Vector x = bank.state(static_cast<uint32_t>(i));
+            squared += (x.head<2>() - truth[i].head<2>()).squaredNorm();
+            mismatch = std::max(mismatch, (x - naive_x[i]).cwiseAbs().maxCoeff());
+        }
+        if (mismatch > 1e-6) {
+            std::cerr << "Bank and per-track filters disagree by " << mismatch << std::endl;
+            return 1;
+        }
+
+        const double batched = median(bank_ms);
+        const double naive = median(naive_ms);
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(10) << n << std::setw(12) << batched
+            << std::setw(12) << std::setprecision(1) << batched * 1e6 / n
+            << std::setw(12) << std::setprecision(3) << naive
+            << std::setw(9) << std::setprecision(2) << naive / batched << 'x'
+            << std::setw(12) << std::sqrt(squared / n) << '\n';
+    }
+    return 0;
+}
+
+// IMM against the single constant-velocity filter: position and velocity
+// RMSE against engine ground truth for straight, turning and randomly
+// manoeuvring targets, then predict and update time per tick for both
+// banks. Each track is fed its own target's detection, so the error is the
+// filter's alone and not that of association.
+static int benchImm(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 10000, 100000 });
+    constexpr size_t TARGETS = 2000;
+    constexpr int TICKS = 60;
+    constexpr int WARMUP = 15;
+    const std::vector<MotionModel> motions = {
+        MotionModel::ConstantVelocity, MotionModel::CoordinatedTurn, MotionModel::RandomWalk,
+    };
+    const std::vector<TrackModel> filters = { TrackModel::ConstantVelocity, TrackModel::Interacting };
+
+    std::cout << std::setw(10) << "motion" << std::setw(10) << "filter" << std::setw(12) << "pos rmse"
+        << std::setw(12) << "vel rmse" << '\n';
+    for (MotionModel motion_model : motions) {
+        for (TrackModel filter : filters) {
+            MotionConfig motion;
+            motion.models = { motion_model };
+            motion.max_turn_rate = 6.0 * EIGEN_PI / 180.0;
+
+            LifecycleConfig config;
+            config.spawn_interval_ticks = 0;
+            config.despawn_outside_coverage = false;
+            config.max_targets = TARGETS;
+            SimulationEngine engine(config, 3);
+            engine.setMotion(motion);
+            engine.spawn(TARGETS);
+
+            TrackerConfig tracker_config;
+            tracker_config.model = filter;
+            Tracker tracker(tracker_config);
+            WorkerPool workers(1);
+            const SensorConfig sensor_config;
+            Sensor sensor(sensor_config, workers);
+            CounterRng rng(3);
+            PlotBatch plots;
+            std::vector<TrackReport> tracks;
+
+            double position = 0.0;
+            double velocity = 0.0;
+            for (int tick = 0; tick < TICKS; ++tick) {
+                engine.update();
+                const std::vector<Target> truth = engine.getTargets();
+                sensor.scan(rng, tick, truth.data(), truth.size(), plots);
+
+                tracker.predict();
+                for (size_t i = 0; i < plots.detections; ++i) {
+                    const double distance = plots.distances[i];
+                    const double angle = plots.angles[i];
+                    double rxx, rxy, ryy;
+                    plotCovariance(distance, angle, sensor_config.range_sigma, sensor_config.bearing_sigma, rxx, rxy, ryy);
+                    tracker.observe(plots.target_ids[i], distance * std::cos(angle), distance * std::sin(angle),
+                        rxx, rxy, ryy);
+                }
+                tracker.update();
+
+                if (tick >= WARMUP) {
+                    tracker.report(tracks);
+                    const TrackingError error = trackingError(tracks, truth);
+                    position += error.position_rmse * error.position_rmse;
+                    velocity += error.velocity_rmse * error.velocity_rmse;
+                }
+            }
+            std::cout << std::fixed << std::setprecision(2)
+                << std::setw(10) << motionModelName(motion_model)
+                << std::setw(10) << (filter == TrackModel::Interacting ? "imm" : "cv")
+                << std::setw(12) << std::sqrt(position / (TICKS - WARMUP))
+                << std::setw(12) << std::sqrt(velocity / (TICKS - WARMUP)) << '\n';
+        }
+    }
+
+    std::cout << '\n' << std::setw(10) << "tracks" << std::setw(12) << "cv ms" << std::setw(12) << "imm ms"
+        << std::setw(14) << "imm ns/track" << '\n';
+    for (size_t n : sizes) {
+        constexpr int RUNS = 20;
+        const double r = 25.0;
+        KalmanBank::Matrix initial = KalmanBank::Matrix::Zero();
+        initial.diagonal() << r, r, 900.0, 900.0;
+        KalmanBank cv;
+        ImmBank imm;
+        CounterRng rng(3);
+        for (size_t i = 0; i < n; ++i) {
+            const auto bits = rng.block(RNG_STREAM_SPAWN, static_cast<uint32_t>(i), 0);
+            const KalmanBank::Vector state(1000.0 * CounterRng::toUnit(bits[0]), 1000.0 * CounterRng::toUnit(bits[1]), 0.0, 0.0);
+            cv.add(static_cast<int>(i), state, initial);
+            imm.add(static_cast<int>(i), state, initial);
+        }
+
+        auto run = [&](auto& bank, int tick) {
+            auto t0 = Clock::now();
+            bank.predict(1.0);
+            for (uint32_t i = 0; i < n; ++i) {
+                const auto bits = rng.block(RNG_STREAM_MOTION, i, static_cast<uint64_t>(tick));
+                bank.setMeasurement(i, 20.0 * tick + 5.0 * (CounterRng::toUnit(bits[0]) - 0.5),
+                    5.0 * (CounterRng::toUnit(bits[1]) - 0.5), r, 0.0, r);
+            }
+            bank.update();
+            return elapsedMs(t0);
+        };
+        std::vector<double> cv_ms(RUNS);
+        std::vector<double> imm_ms(RUNS);
+        for (int tick = 0; tick < RUNS; ++tick) {
+            cv_ms[tick] = run(cv, tick);
+            imm_ms[tick] = run(imm, tick);
+        }
+
+        const double imm_median = median(imm_ms);
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(10) << n << std::setw(12) << median(cv_ms) << std::setw(12) << imm_median
+            << std::setw(14) << std::setprecision(1) << imm_median * 1e6 / n << '\n';
+    }
+    return 0;
+}
+
+// Track life cycle against clutter: how many targets hold a confirmed track,
+// how many confirmed tracks are false, and the tracker's time per tick.
+// Fails if clutter adds more false tracks or tick time than the bounds allow
+// over the first, usually clutter-free, run.
+static int benchLifecycle(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 0, 1000, 10000, 50000 });
+    constexpr size_t TARGETS = 1000;
+    constexpr int TICKS = 40;
+    constexpr int WARMUP = 10;
+    constexpr double MATCH_RADIUS = 25.0;
+    constexpr double MAX_FALSE_PER_TARGET = 0.25;
+    constexpr double MAX_MS_PER_CLUTTER_PLOT = 0.002;
+    constexpr double MAX_MS_SLACK = 1.0;
+
+    const auto path = (std::filesystem::temp_directory_path() / "radar_bench_lifecycle.scn").string();
+    Scenario::write(path, generateScenario({ TARGETS, ScenarioDistribution::Uniform, 8, 5 }));
+
+    std::cout << std::setw(10) << "clutter" << std::setw(10) << "targets" << std::setw(11) << "confirmed"
+        << std::setw(11) << "tentative" << std::setw(10) << "coasting" << std::setw(10) << "held"
+        << std::setw(10) << "false" << std::setw(12) << "tick ms" << '\n';
+    {
+        const Scenario scenario(path);
+        size_t base_clutter = 0;
+        size_t base_false = 0;
+        double base_ms = 0.0;
+        for (size_t clutter : sizes) {
+            LifecycleConfig config;
+            config.spawn_interval_ticks = 0;
+            config.despawn_outside_coverage = false;
+            config.max_targets = TARGETS;
+            SimulationEngine engine(config, 5);
+            SensorConfig sensor;
+            sensor.clutter_rate = static_cast<double>(clutter);
+            engine.enableSensor(sensor);
+            engine.enableTracking(TrackerConfig{}, AssociationConfig{});
+            engine.loadScenario(scenario);
+
+            std::vector<double> tick_ms;
+            for (int tick = 0; tick < TICKS; ++tick) {
+                engine.update();
+                if (tick >= WARMUP) {
+                    tick_ms.push_back(engine.getTrackerStats().tick_ms);
+                }
+            }
+
+            const std::vector<Target> targets = engine.getTargets();
+            const std::vector<TrackReport> tracks = engine.getTracks();
+            std::vector<double> xs;
+            std::vector<double> ys;
+            for (const auto& track : tracks) {
+                xs.push_back(track.distance * std::cos(track.angle));
+                ys.push_back(track.distance * std::sin(track.angle));
+            }
+            SpatialGrid grid(MAX_DISTANCE, 50.0);
+            grid.build(xs, ys);
+            std::vector<uint8_t> near_target(tracks.size(), 0);
+            size_t held = 0;
+            for (const auto& target : targets) {
+                const Eigen::Vector2d p = target.position();
+                bool found = false;
+                grid.forEachInRadius(p.x(), p.y(), MATCH_RADIUS, [&](uint32_t i, double) {
+                    near_target[i] = 1;
+                    found = true;
+                });
+                held += found;
+            }
+            const size_t false_tracks = tracks.size() - std::count(near_target.begin(), near_target.end(), 1);
+
+            const TrackerStats stats = engine.getTrackerStats();
+            std::cout << std::fixed << std::setprecision(1)
+                << std::setw(10) << clutter << std::setw(10) << targets.size() << std::setw(11) << stats.confirmed
+                << std::setw(11) << stats.tentative << std::setw(10) << stats.coasting
+                << std::setw(9) << 100.0 * held / targets.size() << '%'
+                << std::setw(10) << false_tracks
+                << std::setw(12) << std::setprecision(2) << median(tick_ms) << '\n';
+
+            if (clutter == sizes.front()) {
+                base_clutter = clutter;
+                base_false = false_tracks;
+                base_ms = median(tick_ms);
+            }
+            const double extra_clutter = clutter > base_clutter ? static_cast<double>(clutter - base_clutter) : 0.0;
+            if (false_tracks > base_false + static_cast<size_t>(MAX_FALSE_PER_TARGET * TARGETS)) {
+                throw std::logic_error("Clutter " + std::to_string(clutter) + " confirms too many false tracks");
+            }
+            if (median(tick_ms) > base_ms + MAX_MS_SLACK + MAX_MS_PER_CLUTTER_PLOT * extra_clutter) {
+                throw std::logic_error("Clutter " + std::to_string(clutter) + " slows the tracker down too much");
+            }
+        }
+    }
+    std::filesystem::remove(path);
+    return 0;
+}
+
+// Sensor scan time against clutter rate, single-threaded and on all cores,
+// over 10k targets.
+static int benchSensor(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 100000, 1000000, 4000000 });
+    constexpr int SCANS = 10;
+    constexpr size_t TARGETS = 10000;
+
+    LifecycleConfig config;
+    config.spawn_interval_ticks = 0;
+    config.despawn_outside_coverage = false;
+    config.max_targets = TARGETS;
+    SimulationEngine engine(config, 3);
+    engine.spawn(TARGETS);
+    const std::vector<Target> targets = engine.getTargets();
+
+    WorkerPool single(1);
+    WorkerPool all;
+    CounterRng rng(3);
+
+    std::cout << std::setw(10) << "clutter" << std::setw(10) << "plots" << std::setw(12) << "1 thr ms"
+        << std::setw(12) << "Mplot/s" << std::setw(8) << "thr" << std::setw(12) << "all ms" << std::setw(12) << "Mplot/s" << '\n';
+
+    for (size_t n : sizes) {
+        SensorConfig sensor_config;
+        sensor_config.clutter_rate = static_cast<double>(n);
+        Sensor single_sensor(sensor_config, single);
+        Sensor parallel_sensor(sensor_config, all);
+
+        PlotBatch plots;
+        std::vector<double> single_ms(SCANS);
+        std::vector<double> parallel_ms(SCANS);
+        for (int i = 0; i < SCANS; ++i) {
+            auto t0 = Clock::now();
+            single_sensor.scan(rng, i, targets.data(), targets.size(), plots);
+            single_ms[i] = elapsedMs(t0);
+
+            auto t1 = Clock::now();
+            parallel_sensor.scan(rng, i, targets.data(), targets.size(), plots);
+            parallel_ms[i] = elapsedMs(t1);
+        }
+
+        const double one = median(single_ms);
+        const double many = median(parallel_ms);
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(10) << n << std::setw(10) << plots.size()
+            << std::setw(12) << one << std::setw(12) << plots.size() / one / 1e3
+            << std::setw(8) << all.threadCount()
+            << std::setw(12) << many << std::setw(12) << plots.size() / many / 1e3 << '\n';
+    }
+    return 0;
+}
+
+// Line of sight through --sizes random obstacles for 100k targets: the
+// occlusion map build and lookup time against intersecting the sight line
+// with every edge, and how often the two agree.
+static bool directlyVisible(const Target& target, const std::vector<Obstacle>& obstacles) {
+    const Eigen::Vector2d t = target.position();
+    for (const auto& obstacle : obstacles) {
+        const auto& v = obstacle.vertices;
+        for (size_t i = 0, j = v.size() - 1; i < v.size(); j = i++) {
+            const Eigen::Vector2d d = v[i] - v[j];
+            const double denominator = t.x() * d.y() - t.y() * d.x();
+            if (denominator == 0.0) {
+                continue;
+            }
+            const double s = (v[j].x() * d.y() - v[j].y() * d.x()) / denominator;
+            const double u = (v[j].x() * t.y() - v[j].y() * t.x()) / denominator;
+            if (s >= 0.0 && s <= 1.0 && u >= 0.0 && u <= 1.0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static int benchOcclusion(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 10, 100, 1000 });
+    constexpr int RUNS = 10;
+    constexpr size_t TARGETS = 100000;
+    constexpr int VERTICES = 8;
+
+    LifecycleConfig config;
+    config.spawn_interval_ticks = 0;
+    config.despawn_outside_coverage = false;
+    config.max_targets = TARGETS;
+    SimulationEngine engine(config, 3);
+    engine.spawn(TARGETS);
+    std::vector<Target> targets = engine.getTargets();
+    for (size_t i = 0; i < targets.size(); ++i) {
+        targets[i].distance = MAX_DISTANCE * std::sqrt((i + 0.5) / targets.size());
+    }
+    CounterRng rng(3);
+
+    std::cout << std::setw(10) << "obstacles" << std::setw(12) << "build ms" << std::setw(12) << "lookup ms"
+        << std::setw(12) << "direct ms" << std::setw(10) << "hidden" << std::setw(10) << "agree" << '\n';
+
+    for (size_t n : sizes) {
+        // Star-shaped polygons of 5 to 30 m radius between 100 m and 900 m out.
+        std::vector<Obstacle> obstacles(n);
+        for (size_t i = 0; i < n; ++i) {
+            const auto bits = rng.block(RNG_STREAM_SPAWN, static_cast<uint32_t>(i), 0);
+            const double distance = 100.0 + 800.0 * CounterRng::toUnit(bits[0]);
+            const double angle = 2 * EIGEN_PI * CounterRng::toUnit(bits[1]);
+            const double radius = 5.0 + 25.0 * CounterRng::toUnit(bits[2]);
+            const Eigen::Vector2d centre(distance * std::cos(angle), distance * std::sin(angle));
+            for (int k = 0; k < VERTICES; ++k) {
+                const auto jitter = rng.block(RNG_STREAM_SPAWN, static_cast<uint32_t>(i), k + 1);
+                const double r = radius * (0.5 + 0.5 * CounterRng::toUnit(jitter[0]));
+                const double a = 2 * EIGEN_PI * k / VERTICES;
+                obstacles[i].vertices.push_back(centre + r * Eigen::Vector2d(std::cos(a), std::sin(a)));
+            }
+        }
+
+        auto t0 = Clock::now();
+        OcclusionMap occlusion(obstacles);
+        const double build_ms = elapsedMs(t0);
+
+        std::vector<uint8_t> mapped(TARGETS);
+        std::vector<double> lookup_ms(RUNS);
+        for (int r = 0; r < RUNS; ++r) {
+            auto t1 = Clock::now();
+            for (size_t i = 0; i < TARGETS; ++i) {
+                mapped[i] = occlusion.visible(targets[i].distance, targets[i].angle);
+            }
+            lookup_ms[r] = elapsedMs(t1);
+        }
+
+        size_t hidden = 0;
+        size_t agree = 0;
+        auto t2 = Clock::now();
+        for (size_t i = 0; i < TARGETS; ++i) {
+            const bool visible = directlyVisible(targets[i], obstacles);
+            hidden += !visible;
+            agree += visible == static_cast<bool>(mapped[i]);
+        }
+        const double direct_ms = elapsedMs(t2);
+
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(10) << n << std::setw(12) << build_ms << std::setw(12) << median(lookup_ms)
+            << std::setw(12) << std::setprecision(1) << direct_ms
+            << std::setw(9) << 100.0 * hidden / TARGETS << '%'
+            << std::setw(9) << std::setprecision(2) << 100.0 * agree / TARGETS << '%' << '\n';
+    }
+    return 0;
+}
+
+// Alarm evaluation time per tick for 100k targets against --sizes zones,
+// half polygons and half range-bearing sectors, with one entry rule per
+// zone plus an approach and a speed rule. Targets move a little between
+// ticks, so some cross zone edges every tick.
+static int benchAlarms(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 10, 100, 1000 });
+    constexpr int TICKS = 20;
+    constexpr size_t TARGETS = 100000;
+    constexpr int VERTICES = 8;
+
+    LifecycleConfig config;
+    config.spawn_interval_ticks = 0;
+    config.despawn_outside_coverage = false;
+    config.max_targets = TARGETS;
+    SimulationEngine engine(config, 3);
+    engine.spawn(TARGETS);
+    const std::vector<Target> targets = engine.getTargets();
+
+    // Targets spread evenly over the coverage, each circling the radar.
+    const size_t n_targets = targets.size();
+    std::vector<int> ids(n_targets);
+    std::vector<double> distance(n_targets);
+    std::vector<double> angle(n_targets);
+    std::vector<double> vx(n_targets);
+    std::vector<double> vy(n_targets);
+    for (size_t i = 0; i < n_targets; ++i) {
+        ids[i] = targets[i].id;
+        distance[i] = MAX_DISTANCE * std::sqrt((i + 0.5) / n_targets);
+        angle[i] = targets[i].angle;
+    }
+    const MotionColumns columns{ ids.data(), distance.data(), angle.data(), vx.data(), vy.data(), n_targets };
+    constexpr double TURN = 0.002;
+
+    WorkerPool single(1);
+    WorkerPool all;
+    CounterRng rng(3);
+
+    std::cout << std::setw(8) << "zones" << std::setw(8) << "rules" << std::setw(10) << "masks"
+        << std::setw(12) << "build ms" << std::setw(12) << "1 thr ms" << std::setw(8) << "thr"
+        << std::setw(12) << "all ms" << std::setw(12) << "alarms/tk" << '\n';
+
+    for (size_t n : sizes) {
+        AlarmConfig alarms;
+        for (size_t z = 0; z < n; ++z) {
+            const auto bits = rng.block(RNG_STREAM_SPAWN, static_cast<uint32_t>(z), 0);
+            const double distance = 100.0 + 800.0 * CounterRng::toUnit(bits[0]);
+            const double angle = 2 * EIGEN_PI * CounterRng::toUnit(bits[1]);
+            const double size = 10.0 + 40.0 * CounterRng::toUnit(bits[2]);
+            AlarmZone zone;
+            zone.name = "zone" + std::to_string(z);
+            if (z % 2 == 0) {
+                const Eigen::Vector2d centre(distance * std::cos(angle), distance * std::sin(angle));
+                for (int k = 0; k < VERTICES; ++k) {
+                    const double a = 2 * EIGEN_PI * k / VERTICES;
+                    zone.vertices.push_back(centre + size * Eigen::Vector2d(std::cos(a), std::sin(a)));
+                }
+            }
+            else {
+                zone.shape = AlarmZone::Shape::Sector;
+                zone.min_range = distance;
+                zone.max_range = distance + size;
+                zone.from_angle = angle;
+                zone.to_angle = angle + size / distance;
+            }
+            alarms.zones.push_back(zone);
+            alarms.rules.push_back({ "enter " + zone.name, static_cast<int>(z) });
+        }
+        alarms.rules.push_back({ "approach", -1, 100.0 });
+        alarms.rules.push_back({ "fast", -1, -1.0, 30.0 });
+
+        auto t0 = Clock::now();
+        AlarmEngine single_engine(alarms, single);
+        const double build_ms = elapsedMs(t0);
+        AlarmEngine parallel_engine(alarms, all);
+
+        std::vector<AlarmEvent> single_events;
+        std::vector<AlarmEvent> parallel_events;
+        std::vector<double> single_ms(TICKS);
+        std::vector<double> parallel_ms(TICKS);
+        size_t raised = 0;
+        for (int tick = 0; tick < TICKS; ++tick) {
+            for (size_t i = 0; i < n_targets; ++i) {
+                angle[i] = std::fmod(angle[i] + TURN, 2 * EIGEN_PI);
+                vx[i] = -distance[i] * TURN * std::sin(angle[i]);
+                vy[i] = distance[i] * TURN * std::cos(angle[i]);
+            }
+            single_events.clear();
+            parallel_events.clear();
+
+            auto t1 = Clock::now();
+            single_engine.evaluate(tick, &columns, 1, single_events);
+            single_ms[tick] = elapsedMs(t1);
+
+            auto t2 = Clock::now();
+            parallel_engine.evaluate(tick, &columns, 1, parallel_events);
+            parallel_ms[tick] = elapsedMs(t2);
+
+            if (single_events.size() != parallel_events.size()) {
+                throw std::logic_error("Alarm events differ between thread counts");
+            }
+            raised += tick > 0 ? parallel_events.size() : 0;
+        }
+
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(8) << n << std::setw(8) << alarms.rules.size() << std::setw(10) << single_engine.maskCount()
+            << std::setw(12) << std::setprecision(1) << build_ms << std::setprecision(3)
+            << std::setw(12) << median(single_ms) << std::setw(8) << all.threadCount()
+            << std::setw(12) << median(parallel_ms)
+            << std::setw(12) << std::setprecision(0) << double(raised) / (TICKS - 1) << '\n';
+    }
+    return 0;
+}
+
+// Raw video generation time for a 360-spoke revolution against --sizes
+// range bins, with 10k targets, on one thread and on all of them.
+static int benchVideo(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 1000, 4096 });
+    constexpr int SCANS = 10;
+    constexpr size_t TARGETS = 10000;
+
+    LifecycleConfig config;
+    config.spawn_interval_ticks = 0;
+    config.despawn_outside_coverage = false;
+    config.max_targets = TARGETS;
+    SimulationEngine engine(config, 3);
+    engine.spawn(TARGETS);
+    const std::vector<Target> targets = engine.getTargets();
+
+    WorkerPool single(1);
+    WorkerPool all;
+    CounterRng rng(3);
+
+    std::cout << std::setw(10) << "bins" << std::setw(12) << "cells" << std::setw(12) << "1 thr ms"
+        << std::setw(12) << "Mcell/s" << std::setw(8) << "thr" << std::setw(12) << "all ms" << std::setw(12) << "Mcell/s" << '\n';
+
+    for (size_t n : sizes) {
+        VideoConfig video_config;
+        video_config.range_bins = static_cast<int>(n);
+        VideoGenerator single_video(video_config, rng, single);
+        VideoGenerator parallel_video(video_config, rng, all);
+
+        VideoScan scan;
+        std::vector<double> single_ms(SCANS);
+        std::vector<double> parallel_ms(SCANS);
+        for (int i = 0; i < SCANS; ++i) {
+            auto t0 = Clock::now();
+            single_video.scan(rng, i, targets.data(), targets.size(), scan);
+            single_ms[i] = elapsedMs(t0);
+
+            auto t1 = Clock::now();
+            parallel_video.scan(rng, i, targets.data(), targets.size(), scan);
+            parallel_ms[i] = elapsedMs(t1);
+        }
+
+        const size_t cells = scan.amplitude.size();
+        const double one = median(single_ms);
+        const double many = median(parallel_ms);
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(10) << n << std::setw(12) << cells
+            << std::setw(12) << one << std::setw(12) << cells / one / 1e3
+            << std::setw(8) << all.threadCount()
+            << std::setw(12) << many << std::setw(12) << cells / many / 1e3 << '\n';
+    }
+    return 0;
+}
+
+// CFAR detection time over one 360-spoke revolution against --sizes range
+// bins, both methods, with 200 targets spread over the coverage. Found is
+// the share of targets with a plot within 15 m; false plots have no target
+// that close.
+static int benchCfar(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 1000, 4096 });
+    constexpr int SCANS = 10;
+    constexpr size_t TARGETS = 200;
+    constexpr double MATCH_RADIUS = 15.0;
+
+    LifecycleConfig config;
+    config.spawn_interval_ticks = 0;
+    config.despawn_outside_coverage = false;
+    config.max_targets = TARGETS;
+    SimulationEngine engine(config, 3);
+    engine.spawn(TARGETS);
+    std::vector<Target> targets = engine.getTargets();
+    for (size_t i = 0; i < targets.size(); ++i) {
+        targets[i].distance = 0.95 * MAX_DISTANCE * std::sqrt((i + 0.5) / targets.size());
+    }
+
+    WorkerPool single(1);
+    WorkerPool all;
+    CounterRng rng(3);
+
+    std::cout << std::setw(10) << "bins" << std::setw(8) << "method" << std::setw(12) << "1 thr ms"
+        << std::setw(12) << "Mcell/s" << std::setw(8) << "thr" << std::setw(12) << "all ms" << std::setw(12) << "Mcell/s"
+        << std::setw(10) << "scans/s" << std::setw(10) << "plots" << std::setw(10) << "found" << std::setw(10) << "false" << '\n';
+
+    for (size_t n : sizes) {
+        VideoConfig video_config;
+        video_config.range_bins = static_cast<int>(n);
+        VideoGenerator video(video_config, rng, all);
+        VideoScan scan;
+        video.scan(rng, 1, targets.data(), targets.size(), scan);
+
+        for (CfarMethod method : { CfarMethod::CellAveraging, CfarMethod::OrderedStatistic }) {
+            CfarConfig cfar_config;
+            cfar_config.method = method;
+            CfarDetector single_detector(cfar_config, video_config, single);
+            CfarDetector parallel_detector(cfar_config, video_config, all);
+
+            PlotBatch plots;
+            std::vector<double> single_ms(SCANS);
+            std::vector<double> parallel_ms(SCANS);
+            for (int i = 0; i < SCANS; ++i) {
+                auto t0 = Clock::now();
+                single_detector.detect(scan, plots);
+                single_ms[i] = elapsedMs(t0);
+
+                auto t1 = Clock::now();
+                parallel_detector.detect(scan, plots);
+                parallel_ms[i] = elapsedMs(t1);
+            }
+
+            std::vector<double> xs(plots.size());
+            std::vector<double> ys(plots.size());
+            for (size_t i = 0; i < plots.size(); ++i) {
+                xs[i] = plots.distances[i] * std::cos(plots.angles[i]);
+                ys[i] = plots.distances[i] * std::sin(plots.angles[i]);
+            }
+            SpatialGrid grid(MAX_DISTANCE, 50.0);
+            grid.build(xs, ys);
+            std::vector<uint8_t> near_target(plots.size(), 0);
+            size_t found = 0;
+            for (const auto& target : targets) {
+                const Eigen::Vector2d p = target.position();
+                bool hit = false;
+                grid.forEachInRadius(p.x(), p.y(), MATCH_RADIUS, [&](uint32_t i, double) {
+                    near_target[i] = 1;
+                    hit = true;
+                });
+                found += hit;
+            }
+            const size_t false_plots = plots.size() - std::count(near_target.begin(), near_target.end(), 1);
+
+            const size_t cells = scan.amplitude.size();
+            const double one = median(single_ms);
+            const double many = median(parallel_ms);
+            std::cout << std::fixed << std::setprecision(2)
+                << std::setw(10) << n << std::setw(8) << (method == CfarMethod::CellAveraging ? "ca" : "os")
+                << std::setw(12) << one << std::setw(12) << cells / one / 1e3
+                << std::setw(8) << all.threadCount()
+                << std::setw(12) << many << std::setw(12) << cells / many / 1e3
+                << std::setw(10) << 1000.0 / many << std::setw(10) << plots.size()
+                << std::setw(9) << std::setprecision(1) << 100.0 * found / targets.size() << '%'
+                << std::setw(10) << false_plots << '\n';
+        }
+    }
+    return 0;
+}
+
+// False plots per scan from target-free video in heavy land clutter, CA
+// CFAR alone against CA with a clutter map warmed up over WARM_SCANS, plus
+// the map's update rate and snapshot save and load time.
+static int benchClutterMap(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 1000, 4096 });
+    constexpr int WARM_SCANS = 32;
+    constexpr int SCANS = 10;
+    const std::string path = (std::filesystem::temp_directory_path() / "radar_bench_clutter.map").string();
+
+    WorkerPool all;
+    CounterRng rng(5);
+
+    std::cout << std::setw(10) << "bins" << std::setw(14) << "update ms" << std::setw(12) << "Mcell/s"
+        << std::setw(12) << "ca false" << std::setw(12) << "map false" << std::setw(12) << "detect ms"
+        << std::setw(12) << "+map ms" << std::setw(10) << "save ms" << std::setw(10) << "load ms" << '\n';
+
+    for (size_t n : sizes) {
+        VideoConfig video_config;
+        video_config.range_bins = static_cast<int>(n);
+        video_config.clutter_cnr = 40.0;
+        video_config.clutter_spread = 8.0;
+        video_config.clutter_range = 0.5 * MAX_DISTANCE;
+        VideoGenerator video(video_config, rng, all);
+        VideoScan scan;
+
+        CfarConfig cfar_config;
+        CfarDetector plain(cfar_config, video_config, all);
+        CfarDetector mapped(cfar_config, video_config, all);
+        ClutterMap map(ClutterMapConfig{}, video_config.azimuths, video_config.range_bins);
+        mapped.setClutterMap(&map);
+
+        PlotBatch plots;
+        uint64_t tick = 1;
+        for (int i = 0; i < WARM_SCANS; ++i) {
+            video.scan(rng, tick++, nullptr, 0, scan);
+            mapped.detect(scan, plots);
+        }
+
+        size_t plain_false = 0;
+        size_t mapped_false = 0;
+        std::vector<double> plain_ms(SCANS);
+        std::vector<double> mapped_ms(SCANS);
+        for (int i = 0; i < SCANS; ++i) {
+            video.scan(rng, tick++, nullptr, 0, scan);
+            auto t0 = Clock::now();
+            plain.detect(scan, plots);
+            plain_ms[i] = elapsedMs(t0);
+            plain_false += plots.size();
+
+            auto t1 = Clock::now();
+            mapped.detect(scan, plots);
+            mapped_ms[i] = elapsedMs(t1);
+            mapped_false += plots.size();
+        }
+
+        std::vector<float> power(scan.amplitude.size());
+        for (size_t i = 0; i < power.size(); ++i) {
+            power[i] = scan.amplitude[i] * scan.amplitude[i];
+        }
+        std::vector<double> update_ms(SCANS);
+        for (int i = 0; i < SCANS; ++i) {
+            map.beginScan();
+            auto t0 = Clock::now();
+            for (int s = 0; s < video_config.azimuths; ++s) {
+                map.update(s, power.data() + size_t(s) * video_config.range_bins);
+            }
+            update_ms[i] = elapsedMs(t0);
+        }
+
+        auto t0 = Clock::now();
+        map.save(path);
+        const double save_ms = elapsedMs(t0);
+        ClutterMap loaded(ClutterMapConfig{}, video_config.azimuths, video_config.range_bins);
+        auto t1 = Clock::now();
+        loaded.load(path);
+        const double load_ms = elapsedMs(t1);
+        std::filesystem::remove(path);
+
+        const size_t cells = power.size();
+        const double update = median(update_ms);
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(10) << n << std::setw(14) << update << std::setw(12) << cells / update / 1e3
+            << std::setw(12) << std::setprecision(1) << double(plain_false) / SCANS
+            << std::setw(12) << double(mapped_false) / SCANS << std::setprecision(2)
+            << std::setw(12) << median(plain_ms) << std::setw(12) << median(mapped_ms)
+            << std::setw(10) << save_ms << std::setw(10) << load_ms << '\n';
+    }
+    return 0;
+}
+
+// Association time for --sizes plots per scan against 10k tracks whose
+// predictions are off by ~5 m, and the share of tracks given the plot of
+// their own target.
+static int benchAssociate(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 20000, 100000, 400000 });
+    constexpr int SCANS = 10;
+    constexpr size_t TRACKS = 10000;
+    constexpr double PREDICTION_SIGMA = 5.0;
+
+    LifecycleConfig config;
+    config.spawn_interval_ticks = 0;
+    config.despawn_outside_coverage = false;
+    config.max_targets = TRACKS;
+    SimulationEngine engine(config, 5);
+    engine.spawn(TRACKS);
+    std::vector<Target> targets = engine.getTargets();
+    CounterRng rng(5);
+    for (auto& t : targets) {
+        const auto bits = rng.block(RNG_STREAM_SPAWN, static_cast<uint32_t>(t.id), 1);
+        t.distance = MAX_DISTANCE * std::sqrt(CounterRng::toUnit(bits[0]));
+        t.angle = 2 * EIGEN_PI * CounterRng::toUnit(bits[1]);
+    }
+
+    SensorConfig sensor_config;
+    std::vector<TrackGate> gates;
+    for (const auto& t : targets) {
+        const auto bits = rng.block(RNG_STREAM_MOTION, static_cast<uint32_t>(t.id), 1);
+        const double radius = PREDICTION_SIGMA * std::sqrt(-2.0 * std::log(CounterRng::toUnit(bits[0])));
+        const double theta = 2 * EIGEN_PI * CounterRng::toUnit(bits[1]);
+        const Eigen::Vector2d p = t.position() + radius * Eigen::Vector2d(std::cos(theta), std::sin(theta));
+        double rxx, rxy, ryy;
+        plotCovariance(t.distance, t.angle, sensor_config.range_sigma, sensor_config.bearing_sigma, rxx, rxy, ryy);
+        const double v = PREDICTION_SIGMA * PREDICTION_SIGMA;
+        gates.push_back({ p.x(), p.y(), rxx + v, rxy, ryy + v });
+    }
+
+    WorkerPool workers;
+    std::cout << std::setw(10) << "plots" << std::setw(10) << "tracks" << std::setw(10) << "edges"
+        << std::setw(10) << "largest" << std::setw(10) << "gate ms" << std::setw(12) << "cluster ms"
+        << std::setw(12) << "assign ms" << std::setw(10) << "total" << std::setw(10) << "correct" << '\n';
+
+    for (size_t n : sizes) {
+        sensor_config.clutter_rate = static_cast<double>(n > TRACKS ? n - TRACKS : 0);
+        Sensor sensor(sensor_config, workers);
+        Associator associator(AssociationConfig{}, workers);
+        PlotBatch plots;
+        std::vector<int32_t> track_plot;
+
+        std::vector<double> gate_ms(SCANS);
+        std::vector<double> cluster_ms(SCANS);
+        std::vector<double> assign_ms(SCANS);
+        std::vector<double> total_ms(SCANS);
+        size_t correct = 0;
+        for (int i = 0; i < SCANS; ++i) {
+            sensor.scan(rng, i, targets.data(), targets.size(), plots);
+            auto t0 = Clock::now();
+            associator.associate(gates, plots, track_plot);
+            total_ms[i] = elapsedMs(t0);
+            gate_ms[i] = associator.stats().gate_ms;
+            cluster_ms[i] = associator.stats().cluster_ms;
+            assign_ms[i] = associator.stats().assign_ms;
+        }
+        for (size_t t = 0; t < TRACKS; ++t) {
+            correct += track_plot[t] >= 0 && plots.target_ids[track_plot[t]] == targets[t].id;
+        }
+
+        const AssociationStats& stats = associator.stats();
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(10) << plots.size() << std::setw(10) << TRACKS << std::setw(10) << stats.edges
+            << std::setw(10) << stats.largest_cluster << std::setw(10) << median(gate_ms)
+            << std::setw(12) << median(cluster_ms) << std::setw(12) << median(assign_ms)
+            << std::setw(10) << median(total_ms)
+            << std::setw(9) << std::setprecision(1) << 100.0 * correct / TRACKS << '%' << '\n';
+    }
+    return 0;
+}
+
+// Scan conversion of 360 x 1000 video into a --sizes pixel square display:
+// lookup table build, a whole revolution, and the 10-spoke sectors a sweep
+// delivers between repaints, against direct per-pixel trigonometry. Differ
+// counts pixels where the peak over a pixel's range bins is not the single
+// bin the direct conversion samples.
+static int benchScanConvert(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 512, 1024, 2048 });
+    constexpr int REPEATS = 10;
+    constexpr int SECTOR = 10;
+
+    LifecycleConfig config;
+    config.spawn_interval_ticks = 0;
+    config.despawn_outside_coverage = false;
+    config.max_targets = 1000;
+    SimulationEngine engine(config, 4);
+    engine.spawn(1000);
+    const std::vector<Target> targets = engine.getTargets();
+
+    WorkerPool workers;
+    CounterRng rng(4);
+    VideoConfig video_config;
+    VideoGenerator video(video_config, rng, workers);
+    VideoScan scan;
+    video.scan(rng, 0, targets.data(), targets.size(), scan);
+    const int azimuths = scan.azimuths;
+    const int bins = scan.range_bins;
+
+    std::cout << std::setw(8) << "pixels" << std::setw(10) << "build ms"
+        << std::setw(10) << "full ms" << std::setw(12) << "sector ms" << std::setw(12) << "direct ms" << std::setw(10) << "differ" << '\n';
+
+    for (size_t n : sizes) {
+        const int side = static_cast<int>(n);
+        ScanConverter converter(workers);
+        auto t0 = Clock::now();
+        converter.resize(side, side, azimuths, bins);
+        const double build_ms = elapsedMs(t0);
+
+        std::vector<double> full_ms(REPEATS);
+        for (int i = 0; i < REPEATS; ++i) {
+            auto t1 = Clock::now();
+            converter.convert(scan.intensity.data(), 0, azimuths);
+            full_ms[i] = elapsedMs(t1);
+        }
+
+        std::vector<double> sector_ms;
+        for (int first = 0; first < azimuths; first += SECTOR) {
+            auto t1 = Clock::now();
+            converter.convert(scan.intensity.data(), first, SECTOR);
+            sector_ms.push_back(elapsedMs(t1));
+        }
+
+        std::vector<uint8_t> image(size_t(side) * side);
+        std::vector<double> direct_ms(REPEATS);
+        const double half = side * 0.5;
+        for (int i = 0; i < REPEATS; ++i) {
+            auto t1 = Clock::now();
+            for (int y = 0; y < side; ++y) {
+                for (int x = 0; x < side; ++x) {
+                    const double dx = x + 0.5 - half;
+                    const double dy = y + 0.5 - half;
+                    const int bin = static_cast<int>(std::sqrt(dx * dx + dy * dy) / half * bins);
+                    double angle = std::atan2(dy, dx);
+                    angle = angle < 0.0 ? angle + 2 * EIGEN_PI : angle;
+                    const int spoke = std::min(static_cast<int>(angle / (2 * EIGEN_PI) * azimuths), azimuths - 1);
+                    image[size_t(y) * side + x] = bin < bins ? scan.intensity[size_t(spoke) * bins + bin] : 0;
+                }
+            }
+            direct_ms[i] = elapsedMs(t1);
+        }
+
+        size_t differ = 0;
+        for (size_t p = 0; p < image.size(); ++p) {
+            differ += converter.image()[p] != image[p];
+        }
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(8) << side << std::setw(10) << build_ms << std::setw(10) << median(full_ms)
+            << std::setw(12) << median(sector_ms) << std::setw(12) << median(direct_ms)
+            << std::setw(10) << differ << '\n';
+    }
+    return 0;
+}
+
+// Burst against sweep publication for --sizes targets: the engine time and
+// target bytes of one whole-world update, against the largest sector of a
+// 16-sector sweep. Bytes are the frame records the server would write.
+static int benchSweep(int argc, char** argv) {
+    const auto sizes = sizesArg(argc, argv, { 10000, 100000 });
+    constexpr int REVOLUTIONS = 10;
+    constexpr int SECTORS = 16;
+    constexpr size_t RECORD_SIZE = 4 + 3 * 8 + 3 * 8 + 1 + (TRAIL_SIZE + 1) * 2 * 8;
+
+    std::cout << std::setw(10) << "targets" << std::setw(12) << "burst ms" << std::setw(12) << "burst KB"
+        << std::setw(12) << "sector ms" << std::setw(12) << "max ms" << std::setw(12) << "max KB"
+        << std::setw(14) << "interval ms" << '\n';
+
+    for (size_t n : sizes) {
+        LifecycleConfig config;
+        config.spawn_interval_ticks = 0;
+        config.max_targets = n;
+        config.despawn_outside_coverage = false;
+
+        SimulationEngine burst(config, 6);
+        burst.spawn(n);
+        std::vector<double> burst_ms(REVOLUTIONS);
+        for (int i = 0; i < REVOLUTIONS; ++i) {
+            auto t0 = Clock::now();
+            burst.update();
+            burst_ms[i] = elapsedMs(t0);
+        }
+
+        SimulationEngine sweep(config, 6);
+        sweep.spawn(n);
+        sweep.enableSweep(SECTORS);
+        std::vector<double> sector_ms;
+        double max_ms = 0.0;
+        size_t max_targets = 0;
+        for (int i = 0; i < REVOLUTIONS * SECTORS; ++i) {
+            auto t0 = Clock::now();
+            sweep.update();
+            const double ms = elapsedMs(t0);
+            sector_ms.push_back(ms);
+            max_ms = std::max(max_ms, ms);
+            for (const auto& sector : sweep.drainSweep()) {
+                max_targets = std::max(max_targets, sector.targets.size());
+            }
+        }
+
+        const double interval = std::chrono::duration<double, std::milli>(sweep.publishInterval()).count();
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(10) << n << std::setw(12) << median(burst_ms) << std::setw(12) << n * RECORD_SIZE / 1024.0
+            << std::setw(12) << median(sector_ms) << std::setw(12) << max_ms
+            << std::setw(12) << max_targets * RECORD_SIZE / 1024.0 << std::setw(14) << interval << '\n';
+    }
+    return 0;
+}
+
+struct BenchCommand {
+    const char* name;
+    const char* description;
+    int (*run)(int argc, char** argv);
+};
+
+static const BenchCommand COMMANDS[] = {
+    { "scenario", "startup time against scenario size [--sizes a,b,c]", benchScenario },
+    { "record", "tick time with and without the tick log recorder [--sizes a,b,c]", benchRecord },
+    { "history", "history query latency against result size [--sizes a,b,c]", benchHistory },
+    { "codec", "track codec ratio and throughput, tick log size [--sizes a,b,c]", benchCodec },
+    { "motion", "tick and motion step time per motion model [--sizes a,b,c]", benchMotion },
+    { "tracker", "Kalman bank predict and update time per tick [--sizes a,b,c]", benchTracker },
+    { "imm", "IMM against constant-velocity tracking accuracy and time per tick [--sizes a,b,c]", benchImm },
+    { "lifecycle", "track confirmation and deletion against clutter rate [--sizes a,b,c]", benchLifecycle },
+    { "sensor", "sensor scan time against clutter rate [--sizes a,b,c]", benchSensor },
+    { "occlusion", "obstacle line-of-sight lookup against direct edge intersection [--sizes a,b,c]", benchOcclusion },
+    { "alarms", "alarm rule evaluation time per tick for 100k targets against zone count [--sizes a,b,c]", benchAlarms },
+    { "associate", "plot-to-track association time against plots per scan [--sizes a,b,c]", benchAssociate },
+    { "video", "raw video revolution time against range bins [--sizes a,b,c]", benchVideo },
+    { "cfar", "CA and OS CFAR detection time and cell rate against range bins [--sizes a,b,c]", benchCfar },
+    { "clutter-map", "false plots with and without a clutter map in heavy clutter, map update rate [--sizes a,b,c]", benchClutterMap },
+    { "scan-convert", "PPI scan conversion time for a revolution and a sector against display size [--sizes a,b,c]", benchScanConvert },
+    { "sweep", "whole-world burst against per-sector sweep update time and message size [--sizes a,b,c]", benchSweep },
+};
+
+int main(int argc, char** argv) {
+    try {
+        if (argc >= 2) {
+            for (const auto& cmd : COMMANDS) {
+                if (argv[1] == std::string(cmd.name)) {
+                    return cmd.run(argc - 2, argv + 2);
+                }
+            }
+        }
+
+        size_t width = 0;
+        for (const auto& cmd : COMMANDS) {
+            width = std::max(width, std::string(cmd.name).size());
+        }
+        std::cout << "Usage: radar_bench <command> [options]\n";
+        for (const auto& cmd : COMMANDS) {
+            std::cout << "  " << std::left << std::setw(static_cast<int>(width + 2)) << cmd.name << std::right
+                << cmd.description << '\n';
+        }
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,66 @@
+#include "scenario.h"
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <chrono>
+
+static void printUsage() {
+    std::cout << "Usage: scenario_gen --out <file> --count <n>"
+        << " [--distribution uniform|gaussian|clusters|ring] [--clusters <k>] [--seed <s>]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    try {
+        ScenarioSpec spec;
+        std::string out_path;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--out") {
+                out_path = value();
+            }
+            else if (arg == "--count") {
+                spec.count = std::stoull(value());
+            }
+            else if (arg == "--distribution") {
+                spec.distribution = parseScenarioDistribution(value());
+            }
+            else if (arg == "--clusters") {
+                spec.clusters = std::stoi(value());
+            }
+            else if (arg == "--seed") {
+                spec.seed = std::stoull(value());
+            }
+            else if (arg == "--help" || arg == "-h") {
+                printUsage();
+                return 0;
+            }
+            else {
+                throw std::runtime_error("Unknown argument: " + arg);
+            }
+        }
+
+        if (out_path.empty() || spec.count == 0) {
+            printUsage();
+            return 1;
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        Scenario::write(out_path, generateScenario(spec));
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        std::cout << "Wrote " << spec.count << " targets to " << out_path << " in " << ms << " ms" << std::endl;
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
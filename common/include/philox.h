@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+enum RngStream : uint32_t {
+    RNG_STREAM_MOTION = 0,
+    RNG_STREAM_SPAWN = 1,
+    RNG_STREAM_COLOR = 2,
+    RNG_STREAM_KINEMATICS = 3,
+    RNG_STREAM_SENSOR = 4,
+    RNG_STREAM_CLUTTER = 5,
+    RNG_STREAM_VIDEO = 6,
+    RNG_STREAM_ECHO = 7,
+    RNG_STREAM_VIDEO_CLUTTER = 8,
+};
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// Output is a pure function of (seed, stream, id, tick), so draws can happen in
+// any order and on any thread and still reproduce the same run.
+class CounterRng {
+public:
+    using Block = std::array<uint32_t, 4>;
+
+    explicit constexpr CounterRng(uint64_t seed = 0) :
+        _seed(seed)
+    {
+    }
+
+    constexpr Block block(uint32_t stream, uint32_t id, uint64_t tick) const {
+        Block ctr{ id, stream, static_cast<uint32_t>(tick), static_cast<uint32_t>(tick >> 32) };
+        uint32_t k0 = static_cast<uint32_t>(_seed);
+        uint32_t k1 = static_cast<uint32_t>(_seed >> 32);
+
+        for (int round = 0; round < 10; ++round) {
+            const uint64_t p0 = uint64_t{ M0 } * ctr[0];
+            const uint64_t p1 = uint64_t{ M1 } * ctr[2];
+            ctr = {
+                static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ k0,
+                static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ k1,
+                static_cast<uint32_t>(p0)
+            };
+            k0 += W0;
+            k1 += W1;
+        }
+        return ctr;
+    }
+
+    double uniform(uint32_t stream, uint32_t id, uint64_t tick) const {
+        return toUnit(block(stream, id, tick)[0]);
+    }
+
+    static double toUnit(uint32_t bits) {
+        return (bits + 0.5) * (1.0 / 4294967296.0);
+    }
+
+    uint64_t seed() const {
+        return _seed;
+    }
+
+private:
+    static constexpr uint32_t M0 = 0xD2511F53u;
+    static constexpr uint32_t M1 = 0xCD9E8D57u;
+    static constexpr uint32_t W0 = 0x9E3779B9u;
+    static constexpr uint32_t W1 = 0xBB67AE85u;
+
+    uint64_t _seed;
+};
+
+// Known-answer vectors for Philox4x32-10 from Random123 (kat_vectors): the
+// counter is (id, stream, tick low, tick high) and the key is the seed.
+static_assert(CounterRng(0).block(0, 0, 0)
+    == CounterRng::Block{ 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u });
+static_assert(CounterRng(0xffffffffffffffffull).block(0xffffffffu, 0xffffffffu, 0xffffffffffffffffull)
+    == CounterRng::Block{ 0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu });
+static_assert(CounterRng(0x299f31d0a4093822ull).block(0x85a308d3u, 0x243f6a88u, 0x0370734413198a2eull)
+    == CounterRng::Block{ 0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u });
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+constexpr uint32_t FRAME_MAGIC = 0xABCDEF01;
+constexpr uint32_t MESSAGE_MAGIC = 0xABCDEF02;
+
+// Every message other than the target frame is framed as
+// MESSAGE_MAGIC, uint16 type, uint32 payload size, payload,
+// so a client can skip types it does not understand.
+constexpr int MESSAGE_HEADER_SIZE = 4 + 2 + 4;
+
+enum class MessageType : uint16_t {
+    TargetEvents = 1,
+    HistoryResult = 2,
+    Tracks = 3,
+    Plots = 4,
+    TrackerStats = 5,
+    VideoSpoke = 6,
+    Sector = 7,
+    Alarms = 8,
+};
+
+// HistoryResult payload: uint32 query id, uint8 final flag, uint32 count,
+// then count records of (uint64 tick, int32 id, float distance, float angle).
+// A query is answered by any number of partial messages and one final
+// message with no records.
+constexpr int HISTORY_RECORD_SIZE = 8 + 4 + 4 + 4;
+
+// Tracks payload: uint32 count, then count records of (int32 id,
+// double distance, double angle, double heading, double speed, double sigma),
+// sigma being the 1-sigma position uncertainty in metres.
+constexpr int TRACK_RECORD_SIZE = 4 + 5 * 8;
+
+// Plots payload: uint64 tick, uint32 count, then count records of
+// (float distance, float angle). Detections and clutter look the same.
+constexpr int PLOT_RECORD_SIZE = 4 + 4;
+
+// TrackerStats payload: uint64 tick, uint32 confirmed, uint32 tentative,
+// uint32 coasting, float milliseconds the tracker took on that tick.
+constexpr int TRACKER_STATS_SIZE = 8 + 3 * 4 + 4;
+
+// VideoSpoke payload: uint64 tick, uint16 azimuth index, uint16 azimuths
+// per revolution, uint16 range bins, then one uint8 intensity per bin,
+// nearest first. A revolution is sent as one message per spoke in sweep
+// order; spoke i covers bearings [i, i + 1) * 2 pi / azimuths.
+constexpr int VIDEO_SPOKE_HEADER_SIZE = 8 + 3 * 2;
+
+// Sector payload: uint64 tick, uint16 sector, uint16 sectors per revolution,
+// uint32 count, then count target records laid out as in the target frame.
+// Sent in sweep mode instead of the frame, one sector at a time as the beam
+// passes; sector i covers bearings [i, i + 1) * 2 pi / sectors, and its
+// targets replace whatever the client showed there. The video spokes of the
+// sector follow it, and plots and tracks follow the last sector.
+constexpr int SECTOR_HEADER_SIZE = 8 + 2 * 2 + 4;
+
+// Alarms payload: uint32 count, then count records of (uint64 tick,
+// int32 target id, float distance, float angle, uint8 rule name length,
+// rule name), one per target and rule that became true on that tick.
+constexpr int ALARM_RECORD_HEADER_SIZE = 8 + 4 + 4 + 4 + 1;
+
+struct TrackReport {
+    int id;
+    double distance;
+    double angle;
+    double heading;
+    double speed;
+    double sigma;
+};
+
+struct TrackerStats {
+    uint64_t tick = 0;
+    uint32_t confirmed = 0;
+    uint32_t tentative = 0;
+    uint32_t coasting = 0;
+    float tick_ms = 0.0f;
+};
+
+struct AlarmReport {
+    uint64_t tick;
+    std::string rule;
+    int id;
+    float distance;
+    float angle;
+};
+
+struct TargetEvent {
+    enum class Type : uint8_t {
+        Spawned = 0,
+        Despawned = 1,
+    };
+
+    Type type;
+    int id;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "worker-pool.h"
+
+// Turns spoke-major polar video (azimuths x range_bins bytes) into a
+// cartesian PPI image with MAX_DISTANCE at the inscribed circle. Bearings
+// follow the display: x to the right, y down. Each image pixel is a lookup
+// into the polar grid, and the lookups are precomputed on resize, grouped by
+// image tile and within a tile by spoke. Converting a swept sector is then a
+// contiguous gather per tile, tiles in parallel, with no trigonometry.
+class ScanConverter {
+public:
+    struct Rect {
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = 0;           // exclusive
+        int y1 = 0;
+
+        bool empty() const { return x1 <= x0 || y1 <= y0; }
+        void unite(const Rect& other);
+    };
+
+    explicit ScanConverter(WorkerPool& workers);
+
+    // Rebuilds the lookup tables; the image is cleared.
+    void resize(int width, int height, int azimuths, int range_bins);
+
+    // Converts spokes [first, first + count), wrapping past the last spoke,
+    // and returns the part of the image that may have changed.
+    Rect convert(const uint8_t* polar, int first, int count);
+
+    int width() const { return _width; }
+    int height() const { return _height; }
+    int azimuths() const { return _azimuths; }
+    int rangeBins() const { return _range_bins; }
+    const uint8_t* image() const { return _image.data(); }
+
+private:
+    static constexpr int TILE = 64;
+
+    void decimate(const uint8_t* polar, int spoke);
+
+    WorkerPool& _workers;
+    int _width = 0;
+    int _height = 0;
+    int _azimuths = 0;
+    int _range_bins = 0;
+    int _decimation = 1;                  // range bins per sample, when a pixel spans several
+    int _samples = 0;                     // samples per decimated spoke
+    int _tiles = 0;
+    std::vector<uint8_t> _image;
+    std::vector<uint8_t> _decimated;      // azimuths x samples, the peak over each run of bins
+    std::vector<uint32_t> _offsets;       // tiles x azimuths + 1, into the lookups below
+    std::vector<uint32_t> _pixels;        // image index of each lookup
+    std::vector<uint32_t> _sources;       // decimated sample feeding it
+    std::vector<Rect> _spoke_bounds;
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <stdexcept>
+
+constexpr int SLOT_INDEX_BITS = 22;
+constexpr uint32_t SLOT_INDEX_MASK = (1u << SLOT_INDEX_BITS) - 1;
+constexpr uint32_t SLOT_GENERATION_MASK = (1u << (31 - SLOT_INDEX_BITS)) - 1;
+// Slots addressable by a handle; a SlotMap holds at most this many values.
+constexpr size_t SLOT_CAPACITY = size_t(SLOT_INDEX_MASK) + 1;
+
+inline int makeSlotHandle(uint32_t index, uint32_t generation) {
+    return static_cast<int>(((generation & SLOT_GENERATION_MASK) << SLOT_INDEX_BITS) | (index & SLOT_INDEX_MASK));
+}
+
+inline uint32_t slotIndex(int handle) {
+    return static_cast<uint32_t>(handle) & SLOT_INDEX_MASK;
+}
+
+inline uint32_t slotGeneration(int handle) {
+    return (static_cast<uint32_t>(handle) >> SLOT_INDEX_BITS) & SLOT_GENERATION_MASK;
+}
+
+// Handles are non-negative ints: the low bits pick a slot, the high bits carry
+// the slot generation, so a handle to a removed element does not match the
+// element that later reuses its slot. The generation has 9 bits; a slot whose
+// last generation is removed is retired rather than wrapped, so no handle is
+// ever issued twice and a stale one can never alias a newer element. Retired
+// slots are not reused, which spends the handle space: the map is full once
+// every slot is live or retired. Values are kept densely packed.
+template<typename T>
+class SlotMap {
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    int nextHandle() const {
+        if (_free_head != NONE) {
+            return makeSlotHandle(_free_head, _slots[_free_head].generation);
+        }
+        if (_slots.size() >= SLOT_CAPACITY) {
+            throw std::length_error("SlotMap is full");
+        }
+        return makeSlotHandle(static_cast<uint32_t>(_slots.size()), 0);
+    }
+
+    int insert(T value) {
+        uint32_t index;
+        if (_free_head != NONE) {
+            index = _free_head;
+            _free_head = _slots[index].next_free;
+        }
+        else {
+            if (_slots.size() >= SLOT_CAPACITY) {
+                throw std::length_error("SlotMap is full");
+            }
+            index = static_cast<uint32_t>(_slots.size());
+            _slots.push_back({});
+        }
+
+        Slot& slot = _slots[index];
+        slot.dense = static_cast<uint32_t>(_values.size());
+        slot.next_free = NONE;
+
+        _values.push_back(std::move(value));
+        _dense_to_slot.push_back(index);
+        return makeSlotHandle(index, slot.generation);
+    }
+
+    bool erase(int handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+
+        const uint32_t index = slotIndex(handle);
+        Slot& slot = _slots[index];
+        const uint32_t hole = slot.dense;
+        const uint32_t last = static_cast<uint32_t>(_values.size() - 1);
+
+        if (hole != last) {
+            _values[hole] = std::move(_values[last]);
+            _dense_to_slot[hole] = _dense_to_slot[last];
+            _slots[_dense_to_slot[hole]].dense = hole;
+        }
+        _values.pop_back();
+        _dense_to_slot.pop_back();
+
+        slot.dense = NONE;
+        if (slot.generation == SLOT_GENERATION_MASK) {
+            return true;
+        }
+        ++slot.generation;
+        slot.next_free = _free_head;
+        _free_head = index;
+        return true;
+    }
+
+    bool contains(int handle) const {
+        if (handle < 0) {
+            return false;
+        }
+        const uint32_t index = slotIndex(handle);
+        return index < _slots.size()
+            && _slots[index].dense != NONE
+            && _slots[index].generation == slotGeneration(handle);
+    }
+
+    T* find(int handle) {
+        return contains(handle) ? &_values[_slots[slotIndex(handle)].dense] : nullptr;
+    }
+
+    const T* find(int handle) const {
+        return contains(handle) ? &_values[_slots[slotIndex(handle)].dense] : nullptr;
+    }
+
+    int handleAt(size_t dense) const {
+        const uint32_t index = _dense_to_slot[dense];
+        return makeSlotHandle(index, _slots[index].generation);
+    }
+
+    T& operator[](size_t dense) { return _values[dense]; }
+    const T& operator[](size_t dense) const { return _values[dense]; }
+
+    iterator begin() { return _values.begin(); }
+    iterator end() { return _values.end(); }
+    const_iterator begin() const { return _values.begin(); }
+    const_iterator end() const { return _values.end(); }
+
+    size_t size() const { return _values.size(); }
+    bool empty() const { return _values.empty(); }
+
+    void reserve(size_t n) {
+        _values.reserve(n);
+        _dense_to_slot.reserve(n);
+        _slots.reserve(n);
+    }
+
+    void clear() {
+        while (!_values.empty()) {
+            erase(handleAt(_values.size() - 1));
+        }
+    }
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Slot {
+        uint32_t dense = NONE;
+        uint32_t generation = 0;
+        uint32_t next_free = NONE;
+    };
+
+    std::vector<T> _values;
+    std::vector<uint32_t> _dense_to_slot;
+    std::vector<Slot> _slots;
+    uint32_t _free_head = NONE;
+};
+
+// Direct-mapped lookup keyed by handles issued elsewhere (e.g. by the server).
+template<typename V>
+class HandleTable {
+public:
+    void set(int handle, V value) {
+        const uint32_t index = slotIndex(handle);
+        if (index >= _entries.size()) {
+            _entries.resize(index + 1);
+        }
+        _entries[index] = { handle, std::move(value) };
+    }
+
+    void erase(int handle) {
+        const uint32_t index = slotIndex(handle);
+        if (index < _entries.size() && _entries[index].handle == handle) {
+            _entries[index] = Entry{};
+        }
+    }
+
+    V* find(int handle) {
+        if (handle < 0) {
+            return nullptr;
+        }
+        const uint32_t index = slotIndex(handle);
+        if (index >= _entries.size() || _entries[index].handle != handle) {
+            return nullptr;
+        }
+        return &_entries[index].value;
+    }
+
+    const V* find(int handle) const {
+        return const_cast<HandleTable*>(this)->find(handle);
+    }
+
+    void clear() {
+        for (auto& e : _entries) {
+            e.handle = -1;
+        }
+    }
+
+private:
+    struct Entry {
+        int handle = -1;
+        V value{};
+    };
+
+    std::vector<Entry> _entries;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class SpatialGrid {
+public:
+    SpatialGrid(double extent, double cell_size);
+
+    void build(const std::vector<double>& xs, const std::vector<double>& ys);
+
+    int nearest(double x, double y, double radius) const;
+
+    template<typename F>
+    void forEachInRadius(double x, double y, double radius, F&& visit) const {
+        int cx0, cy0, cx1, cy1;
+        cellRange(x, y, radius, cx0, cy0, cx1, cy1);
+        const double r2 = radius * radius;
+
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                const int cell = cy * _dim + cx;
+                for (uint32_t k = _cell_start[cell]; k < _cell_start[cell + 1]; ++k) {
+                    const uint32_t i = _items[k];
+                    const double dx = _xs[i] - x;
+                    const double dy = _ys[i] - y;
+                    const double d2 = dx * dx + dy * dy;
+                    if (d2 <= r2) {
+                        visit(i, d2);
+                    }
+                }
+            }
+        }
+    }
+
+    size_t size() const;
+    double cellSize() const;
+
+private:
+    int cellCoord(double v) const;
+    void cellRange(double x, double y, double radius, int& cx0, int& cy0, int& cx1, int& cy1) const;
+
+    double _extent;
+    double _cell_size;
+    int _dim;
+    std::vector<uint32_t> _cell_start;
+    std::vector<uint32_t> _items;
+    std::vector<uint32_t> _point_cell;
+    std::vector<uint32_t> _cursor;
+    std::vector<double> _xs;
+    std::vector<double> _ys;
+};
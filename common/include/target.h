@@ -1,22 +1,28 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <Eigen/Dense>
 
+constexpr double MAX_DISTANCE = 1000.0;
+constexpr size_t TRAIL_SIZE = 3;
+
 struct Target {
     int id;
     double distance;
     double angle;
     double direction;
     Eigen::Vector3d color;
-    std::vector<Eigen::Vector2d> trail;
+    std::array<Eigen::Vector2d, TRAIL_SIZE + 1> trail;
+    int age = 0;
 
     Target(int id, double dist, double ang, double dir, const Eigen::Vector3d& col);
     Target(int id, double dist, double ang, double dir, const Eigen::Vector3d& col, const std::vector<Eigen::Vector2d>& trl);
 
-    void move();
+    // Advances to a new position computed by the motion model.
+    void moveTo(double dist, double ang, double dir);
 
     Eigen::Vector2d position() const;
 };
 
-Eigen::Vector3d generateRandomColor();
\ No newline at end of file
+Eigen::Vector3d generateRandomColor(const std::array<uint32_t, 4>& bits);
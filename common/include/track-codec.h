@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+constexpr size_t TRACK_BLOCK_POINTS = 128;
+constexpr size_t PACK_GROUP_SIZE = 128;
+constexpr double TRACK_DEFAULT_QUANTUM = 0.25;
+
+// Written with logical shifts only, which baseline SSE2 has for 64-bit
+// lanes, so loops over it vectorise.
+inline uint64_t zigzagEncode(int64_t v) {
+    const uint64_t u = static_cast<uint64_t>(v);
+    return (u << 1) ^ (0 - (u >> 63));
+}
+
+inline int64_t zigzagDecode(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// Rounds half away from zero, like llround, without the library call.
+inline int64_t toFixed(double v, double inv_quantum) {
+    const double scaled = v * inv_quantum;
+    return static_cast<int64_t>(scaled + (scaled < 0.0 ? -0.5 : 0.5));
+}
+
+// Fixed-width bit packing: a width byte, then n values of that width packed
+// LSB-first into little-endian 64-bit words. Returns the end of the input.
+void packBits(const uint64_t* values, size_t n, std::vector<uint8_t>& out);
+const uint8_t* unpackBits(const uint8_t* in, size_t n, uint64_t* values);
+
+// Same, in groups of PACK_GROUP_SIZE values with their own width, so a few
+// large values (new targets, wrap-arounds) only widen their own group.
+void packGroups(const uint64_t* values, size_t n, std::vector<uint8_t>& out);
+const uint8_t* unpackGroups(const uint8_t* in, size_t n, uint64_t* values);
+
+void writeVarint(uint64_t v, std::vector<uint8_t>& out);
+const uint8_t* readVarint(const uint8_t* in, uint64_t& v);
+
+// One column of a track block: the first value as a varint, then either
+// the step alone when it never changes (timestamps), or the residuals of a
+// delta or a delta-of-delta predictor, whichever packs narrower. Constant
+// steps cost ~0 bits.
+void encodeSeries(const int64_t* values, size_t n, std::vector<uint8_t>& out);
+const uint8_t* decodeSeries(const uint8_t* in, size_t n, int64_t* values);
+
+struct TrackPoint {
+    uint64_t tick;
+    double x;
+    double y;
+};
+
+// Compressed (tick, x, y) history of one track. Coordinates are stored as
+// multiples of the quantum. Points accumulate in a raw tail and are sealed
+// into blocks of TRACK_BLOCK_POINTS; each block starts from absolute values,
+// so the block index doubles as a seek table and the oldest blocks can be
+// dropped without touching the rest.
+class CompressedTrack {
+public:
+    explicit CompressedTrack(double quantum = TRACK_DEFAULT_QUANTUM);
+
+    void append(uint64_t tick, double x, double y) {
+        if (_tail_columns.empty()) {
+            _tail_columns.resize(3 * TRACK_BLOCK_POINTS);
+        }
+        // Through a local index: the int64_t stores may alias the size_t
+        // _tail, which would otherwise be reloaded after each of them.
+        const size_t i = _tail;
+        int64_t* columns = _tail_columns.data();
+        columns[i] = static_cast<int64_t>(tick);
+        columns[TRACK_BLOCK_POINTS + i] = toFixed(x, _inv_quantum);
+        columns[2 * TRACK_BLOCK_POINTS + i] = toFixed(y, _inv_quantum);
+        _tail = i + 1;
+        if (_tail == TRACK_BLOCK_POINTS) {
+            sealBlock();
+        }
+    }
+    void clear();
+    void trimFront(size_t keep_points);
+
+    size_t size() const;
+    size_t byteSize() const;
+    uint64_t firstTick() const;
+    uint64_t lastTick() const;
+
+    void decode(uint64_t from_tick, uint64_t to_tick, std::vector<TrackPoint>& out) const;
+    void decodeLast(size_t n, std::vector<TrackPoint>& out) const;
+
+private:
+    struct Block {
+        uint64_t first_tick;
+        uint64_t last_tick;
+        size_t offset;
+        size_t count;
+    };
+
+    void sealBlock();
+    void decodeBlock(const Block& block, uint64_t from_tick, uint64_t to_tick, std::vector<TrackPoint>& out) const;
+    void decodeTail(size_t first, uint64_t from_tick, uint64_t to_tick, std::vector<TrackPoint>& out) const;
+
+    double _quantum;
+    double _inv_quantum;
+    std::vector<uint8_t> _bytes;
+    std::vector<Block> _blocks;
+    size_t _sealed_points = 0;
+
+    // Raw tick, x and y columns of the unsealed points, allocated on first
+    // append so that empty tracks stay small.
+    size_t _tail = 0;
+    std::vector<int64_t> _tail_columns;
+};
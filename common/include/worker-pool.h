@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+
+// Persistent threads for data-parallel loops inside a tick. The calling
+// thread takes part, so a pool of one thread runs everything inline.
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t threadCount() const;
+
+    // Splits [0, n) into chunks of at least min_chunk items and calls
+    // fn(begin, end) for each; returns when all chunks are done.
+    void parallelFor(size_t n, size_t min_chunk, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    void workLoop();
+    void runChunks();
+
+    std::vector<std::thread> _threads;
+    std::mutex _run_mutex;
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void(size_t, size_t)>* _fn = nullptr;
+    size_t _n = 0;
+    size_t _chunk = 0;
+    size_t _chunks = 0;
+    std::atomic<size_t> _next_chunk{ 0 };
+    size_t _finished_chunks = 0;
+    size_t _active_workers = 0;
+    uint64_t _generation = 0;
+    bool _stopping = false;
+};
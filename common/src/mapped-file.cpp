@@ -0,0 +1,137 @@
+#include "mapped-file.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    _file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        close();
+        throw std::runtime_error("Failed to stat " + path);
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+    if (_size == 0) {
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        throw std::runtime_error("Failed to map " + path);
+    }
+    _mapping = mapping;
+
+    _data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!_data) {
+        close();
+        throw std::runtime_error("Failed to map " + path);
+    }
+#else
+    _fd = ::open(path.c_str(), O_RDONLY);
+    if (_fd < 0) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    struct stat st;
+    if (::fstat(_fd, &st) != 0) {
+        close();
+        throw std::runtime_error("Failed to stat " + path);
+    }
+    _size = static_cast<size_t>(st.st_size);
+    if (_size == 0) {
+        return;
+    }
+
+    void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+    if (addr == MAP_FAILED) {
+        close();
+        throw std::runtime_error("Failed to map " + path);
+    }
+    _data = static_cast<const uint8_t*>(addr);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+#ifdef _WIN32
+        std::swap(_file, other._file);
+        std::swap(_mapping, other._mapping);
+#else
+        std::swap(_fd, other._fd);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (_data) {
+        UnmapViewOfFile(_data);
+    }
+    if (_mapping) {
+        CloseHandle(static_cast<HANDLE>(_mapping));
+        _mapping = nullptr;
+    }
+    if (_file) {
+        CloseHandle(static_cast<HANDLE>(_file));
+        _file = nullptr;
+    }
+#else
+    if (_data) {
+        ::munmap(const_cast<uint8_t*>(_data), _size);
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+const uint8_t* MappedFile::data() const {
+    return _data;
+}
+
+size_t MappedFile::size() const {
+    return _size;
+}
+
+bool MappedFile::isOpen() const {
+#ifdef _WIN32
+    return _file != nullptr;
+#else
+    return _fd >= 0;
+#endif
+}
@@ -0,0 +1,163 @@
+#include "scan-converter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <Eigen/Dense>
+
+void ScanConverter::Rect::unite(const Rect& other) {
+    if (other.empty()) {
+        return;
+    }
+    if (empty()) {
+        *this = other;
+        return;
+    }
+    x0 = std::min(x0, other.x0);
+    y0 = std::min(y0, other.y0);
+    x1 = std::max(x1, other.x1);
+    y1 = std::max(y1, other.y1);
+}
+
+ScanConverter::ScanConverter(WorkerPool& workers) :
+    _workers(workers)
+{
+}
+
+void ScanConverter::resize(int width, int height, int azimuths, int range_bins) {
+    _width = std::max(0, width);
+    _height = std::max(0, height);
+    _azimuths = std::max(0, azimuths);
+    _range_bins = std::max(0, range_bins);
+    _image.assign(size_t(_width) * _height, 0);
+    _spoke_bounds.assign(_azimuths, Rect{});
+    if (_image.empty() || _azimuths == 0 || _range_bins == 0) {
+        _tiles = 0;
+        _offsets.clear();
+        _pixels.clear();
+        _sources.clear();
+        _decimated.clear();
+        return;
+    }
+
+    const double cx = _width * 0.5;
+    const double cy = _height * 0.5;
+    const double max_r = std::min(_width, _height) * 0.5;
+    const double step = 2 * EIGEN_PI / _azimuths;
+    _decimation = std::max(1, static_cast<int>(std::ceil(_range_bins / max_r)));
+    _samples = (_range_bins + _decimation - 1) / _decimation;
+    _decimated.assign(size_t(_azimuths) * _samples, 0);
+
+    const int tiles_x = (_width + TILE - 1) / TILE;
+    const int tiles_y = (_height + TILE - 1) / TILE;
+    _tiles = tiles_x * tiles_y;
+
+    // Each pixel's key is (tile, spoke), -1 outside the disc; the lookups
+    // are then counting-sorted by key.
+    std::vector<int32_t> keys(_image.size());
+    std::vector<uint32_t> samples(_image.size());
+    _workers.parallelFor(_height, 16, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) {
+            const double dy = y + 0.5 - cy;
+            const int tile_row = static_cast<int>(y) / TILE * tiles_x;
+            for (int x = 0; x < _width; ++x) {
+                const double dx = x + 0.5 - cx;
+                const size_t pixel = y * _width + x;
+                const int bin = static_cast<int>(std::sqrt(dx * dx + dy * dy) / max_r * _range_bins);
+                if (bin >= _range_bins) {
+                    keys[pixel] = -1;
+                    continue;
+                }
+                double angle = std::atan2(dy, dx);
+                angle = angle < 0.0 ? angle + 2 * EIGEN_PI : angle;
+                const int spoke = std::min(static_cast<int>(angle / step), _azimuths - 1);
+                keys[pixel] = (tile_row + x / TILE) * _azimuths + spoke;
+                samples[pixel] = static_cast<uint32_t>(spoke) * _samples + bin / _decimation;
+            }
+        }
+    });
+
+    _offsets.assign(size_t(_tiles) * _azimuths + 1, 0);
+    for (size_t pixel = 0; pixel < keys.size(); ++pixel) {
+        if (keys[pixel] >= 0) {
+            ++_offsets[keys[pixel] + 1];
+        }
+    }
+    for (size_t k = 1; k < _offsets.size(); ++k) {
+        _offsets[k] += _offsets[k - 1];
+    }
+
+    const size_t lookups = _offsets.back();
+    _pixels.resize(lookups);
+    _sources.resize(lookups);
+    std::vector<uint32_t> fill(_offsets.begin(), _offsets.end() - 1);
+    for (size_t pixel = 0; pixel < keys.size(); ++pixel) {
+        const int32_t key = keys[pixel];
+        if (key < 0) {
+            continue;
+        }
+        const uint32_t k = fill[key]++;
+        _pixels[k] = static_cast<uint32_t>(pixel);
+        _sources[k] = samples[pixel];
+
+        const int x = static_cast<int>(pixel % _width);
+        const int y = static_cast<int>(pixel / _width);
+        _spoke_bounds[key % _azimuths].unite({ x, y, x + 1, y + 1 });
+    }
+}
+
+// Peak over each run of bins that falls in one pixel, so a small echo is
+// not lost when the display is coarser than the video.
+void ScanConverter::decimate(const uint8_t* polar, int spoke) {
+    const uint8_t* line = polar + size_t(spoke) * _range_bins;
+    uint8_t* out = _decimated.data() + size_t(spoke) * _samples;
+    if (_decimation == 1) {
+        std::memcpy(out, line, _range_bins);
+        return;
+    }
+    for (int j = 0; j < _samples; ++j) {
+        const int first = j * _decimation;
+        const int last = std::min(first + _decimation, _range_bins);
+        out[j] = *std::max_element(line + first, line + last);
+    }
+}
+
+ScanConverter::Rect ScanConverter::convert(const uint8_t* polar, int first, int count) {
+    Rect changed;
+    if (_tiles == 0 || count <= 0) {
+        return changed;
+    }
+    count = std::min(count, _azimuths);
+    first = ((first % _azimuths) + _azimuths) % _azimuths;
+    const int end = first + count;
+
+    _workers.parallelFor(count, 8, [&](size_t begin, size_t stop) {
+        for (size_t i = begin; i < stop; ++i) {
+            decimate(polar, static_cast<int>((first + i) % _azimuths));
+        }
+    });
+
+    uint8_t* image = _image.data();
+    const uint8_t* decimated = _decimated.data();
+    _workers.parallelFor(_tiles, 1, [&](size_t begin, size_t stop) {
+        auto gather = [&](uint32_t k0, uint32_t k1) {
+            for (uint32_t k = k0; k < k1; ++k) {
+                image[_pixels[k]] = decimated[_sources[k]];
+            }
+        };
+        for (size_t tile = begin; tile < stop; ++tile) {
+            const uint32_t* offsets = _offsets.data() + tile * _azimuths;
+            if (end <= _azimuths) {
+                gather(offsets[first], offsets[end]);
+            }
+            else {
+                gather(offsets[first], offsets[_azimuths]);
+                gather(offsets[0], offsets[end - _azimuths]);
+            }
+        }
+    });
+
+    for (int i = 0; i < count; ++i) {
+        changed.unite(_spoke_bounds[(first + i) % _azimuths]);
+    }
+    return changed;
+}
@@ -0,0 +1,76 @@
+#include "spatial-grid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SpatialGrid::SpatialGrid(double extent, double cell_size) :
+    _extent(extent),
+    _cell_size(cell_size),
+    _dim(std::max(1, static_cast<int>(std::ceil(2.0 * extent / cell_size))))
+{
+    _cell_start.assign(static_cast<size_t>(_dim) * _dim + 1, 0);
+}
+
+int SpatialGrid::cellCoord(double v) const {
+    int c = static_cast<int>(std::floor((v + _extent) / _cell_size));
+    return std::clamp(c, 0, _dim - 1);
+}
+
+void SpatialGrid::cellRange(
+    double x,
+    double y,
+    double radius,
+    int& cx0,
+    int& cy0,
+    int& cx1,
+    int& cy1
+) const {
+    cx0 = cellCoord(x - radius);
+    cx1 = cellCoord(x + radius);
+    cy0 = cellCoord(y - radius);
+    cy1 = cellCoord(y + radius);
+}
+
+void SpatialGrid::build(const std::vector<double>& xs, const std::vector<double>& ys) {
+    const size_t n = std::min(xs.size(), ys.size());
+    _xs.assign(xs.begin(), xs.begin() + n);
+    _ys.assign(ys.begin(), ys.begin() + n);
+
+    _point_cell.resize(n);
+    _items.resize(n);
+    std::fill(_cell_start.begin(), _cell_start.end(), 0);
+
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t cell = static_cast<uint32_t>(cellCoord(_ys[i]) * _dim + cellCoord(_xs[i]));
+        _point_cell[i] = cell;
+        ++_cell_start[cell + 1];
+    }
+    for (size_t c = 1; c < _cell_start.size(); ++c) {
+        _cell_start[c] += _cell_start[c - 1];
+    }
+
+    _cursor.assign(_cell_start.begin(), _cell_start.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        _items[_cursor[_point_cell[i]]++] = static_cast<uint32_t>(i);
+    }
+}
+
+int SpatialGrid::nearest(double x, double y, double radius) const {
+    int best = -1;
+    double best_d2 = std::numeric_limits<double>::max();
+    forEachInRadius(x, y, radius, [&](uint32_t i, double d2) {
+        if (d2 < best_d2) {
+            best_d2 = d2;
+            best = static_cast<int>(i);
+        }
+    });
+    return best;
+}
+
+size_t SpatialGrid::size() const {
+    return _xs.size();
+}
+
+double SpatialGrid::cellSize() const {
+    return _cell_size;
+}
@@ -0,0 +1,434 @@
+#include "track-codec.h"
+#include <algorithm>
+#include <cstring>
+#include <bit>
+#include <array>
+#include <utility>
+
+static int bitWidth(uint64_t v) {
+    return static_cast<int>(std::bit_width(v));
+}
+
+// Values are packed 64 at a time by kernels specialised for each width, so
+// every shift and word index is a compile-time constant: 64 values of width
+// W become exactly W words. Groups shorter than 64 are zero-padded.
+constexpr size_t PACK_CHUNK = 64;
+
+// Every word is first written either by a value starting at its bit 0 or by
+// the spill of one straddling into it, so those writes assign and the output
+// needs no clearing.
+template<int W, size_t J>
+inline void packOne(const uint64_t* in, uint64_t* out) {
+    constexpr size_t bit = J * W;
+    constexpr size_t word = bit / 64;
+    constexpr int shift = static_cast<int>(bit % 64);
+    if constexpr (shift == 0) {
+        out[word] = in[J];
+    }
+    else {
+        out[word] |= in[J] << shift;
+    }
+    if constexpr (shift + W > 64) {
+        out[word + 1] = in[J] >> (64 - shift);
+    }
+}
+
+template<int W, size_t J>
+inline void unpackOne(const uint64_t* in, uint64_t* out) {
+    constexpr size_t bit = J * W;
+    constexpr size_t word = bit / 64;
+    constexpr int shift = static_cast<int>(bit % 64);
+    constexpr uint64_t mask = W == 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << W) - 1;
+    if constexpr (shift + W > 64) {
+        out[J] = ((in[word] >> shift) | (in[word + 1] << (64 - shift))) & mask;
+    }
+    else {
+        out[J] = (in[word] >> shift) & mask;
+    }
+}
+
+template<int W, size_t... J>
+void packChunk(const uint64_t* in, uint64_t* out, std::index_sequence<J...>) {
+    (packOne<W, J>(in, out), ...);
+}
+
+template<int W, size_t... J>
+void unpackChunk(const uint64_t* in, uint64_t* out, std::index_sequence<J...>) {
+    (unpackOne<W, J>(in, out), ...);
+}
+
+using ChunkKernel = void (*)(const uint64_t* in, uint64_t* out);
+
+template<int W>
+void packChunk(const uint64_t* in, uint64_t* out) {
+    packChunk<W>(in, out, std::make_index_sequence<PACK_CHUNK>());
+}
+
+template<int W>
+void unpackChunk(const uint64_t* in, uint64_t* out) {
+    unpackChunk<W>(in, out, std::make_index_sequence<PACK_CHUNK>());
+}
+
+template<size_t... W>
+constexpr std::array<ChunkKernel, sizeof...(W)> packKernels(std::index_sequence<W...>) {
+    return { &packChunk<static_cast<int>(W)>... };
+}
+
+template<size_t... W>
+constexpr std::array<ChunkKernel, sizeof...(W)> unpackKernels(std::index_sequence<W...>) {
+    return { &unpackChunk<static_cast<int>(W)>... };
+}
+
+static const auto PACK_KERNELS = packKernels(std::make_index_sequence<65>());
+static const auto UNPACK_KERNELS = unpackKernels(std::make_index_sequence<65>());
+
+static size_t packedBytes(size_t n, int width) {
+    return (n * width + 63) / 64 * sizeof(uint64_t);
+}
+
+static size_t paddedCount(size_t n) {
+    return (n + PACK_CHUNK - 1) / PACK_CHUNK * PACK_CHUNK;
+}
+
+// values must be readable and zero up to paddedCount(n); n is at most
+// PACK_GROUP_SIZE.
+static void packPadded(const uint64_t* values, size_t n, int width, std::vector<uint8_t>& out) {
+    out.push_back(static_cast<uint8_t>(width));
+    if (width == 0) {
+        return;
+    }
+
+    uint64_t words[PACK_GROUP_SIZE];
+    for (size_t i = 0; i < n; i += PACK_CHUNK) {
+        PACK_KERNELS[width](values + i, words + i / PACK_CHUNK * width);
+    }
+
+    const size_t bytes = packedBytes(n, width);
+    const size_t base = out.size();
+    out.resize(base + bytes);
+    std::memcpy(out.data() + base, words, bytes);
+}
+
+// values must be writable up to paddedCount(n); the values past n are junk.
+static const uint8_t* unpackPadded(const uint8_t* in, size_t n, uint64_t* values) {
+    const int width = *in++;
+    if (width == 0) {
+        std::fill(values, values + n, 0);
+        return in;
+    }
+
+    const size_t bytes = packedBytes(n, width);
+    const size_t chunk_bytes = paddedCount(n) / PACK_CHUNK * width * sizeof(uint64_t);
+    uint64_t words[PACK_GROUP_SIZE];
+    std::memcpy(words, in, bytes);
+    std::memset(reinterpret_cast<uint8_t*>(words) + bytes, 0, chunk_bytes - bytes);
+
+    for (size_t i = 0; i < n; i += PACK_CHUNK) {
+        UNPACK_KERNELS[width](words + i / PACK_CHUNK * width, values + i);
+    }
+    return in + bytes;
+}
+
+void packBits(const uint64_t* values, size_t n, std::vector<uint8_t>& out) {
+    uint64_t all = 0;
+    for (size_t i = 0; i < n; ++i) {
+        all |= values[i];
+    }
+    if (n % PACK_CHUNK == 0) {
+        packPadded(values, n, bitWidth(all), out);
+        return;
+    }
+
+    uint64_t padded[PACK_GROUP_SIZE];
+    std::memcpy(padded, values, n * sizeof(uint64_t));
+    std::fill(padded + n, padded + paddedCount(n), 0);
+    packPadded(padded, n, bitWidth(all), out);
+}
+
+const uint8_t* unpackBits(const uint8_t* in, size_t n, uint64_t* values) {
+    if (n % PACK_CHUNK == 0) {
+        return unpackPadded(in, n, values);
+    }
+
+    uint64_t padded[PACK_GROUP_SIZE];
+    in = unpackPadded(in, n, padded);
+    std::memcpy(values, padded, n * sizeof(uint64_t));
+    return in;
+}
+
+void packGroups(const uint64_t* values, size_t n, std::vector<uint8_t>& out) {
+    for (size_t i = 0; i < n; i += PACK_GROUP_SIZE) {
+        packBits(values + i, std::min(PACK_GROUP_SIZE, n - i), out);
+    }
+}
+
+const uint8_t* unpackGroups(const uint8_t* in, size_t n, uint64_t* values) {
+    for (size_t i = 0; i < n; i += PACK_GROUP_SIZE) {
+        in = unpackBits(in, std::min(PACK_GROUP_SIZE, n - i), values + i);
+    }
+    return in;
+}
+
+void writeVarint(uint64_t v, std::vector<uint8_t>& out) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+const uint8_t* readVarint(const uint8_t* in, uint64_t& v) {
+    v = 0;
+    for (int shift = 0;; shift += 7) {
+        const uint8_t byte = *in++;
+        v |= uint64_t{ byte & 0x7Fu } << shift;
+        if (!(byte & 0x80)) {
+            return in;
+        }
+    }
+}
+
+enum SeriesMode : uint8_t {
+    SERIES_DELTA = 0,
+    SERIES_DELTA_OF_DELTA = 1,
+    SERIES_CONSTANT_STEP = 2,
+};
+
+void encodeSeries(const int64_t* values, size_t n, std::vector<uint8_t>& out) {
+    if (n == 0) {
+        return;
+    }
+    writeVarint(zigzagEncode(values[0]), out);
+
+    // Timestamps almost always advance by one step, which is stored alone.
+    // Other columns usually break the run within a few values.
+    if (n > 1) {
+        const int64_t step = values[1] - values[0];
+        size_t i = 2;
+        while (i < n && values[i] - values[i - 1] == step) {
+            ++i;
+        }
+        if (i == n) {
+            out.push_back(SERIES_CONSTANT_STEP);
+            writeVarint(zigzagEncode(step), out);
+            return;
+        }
+    }
+
+    // Residuals are built zero-padded to whole pack chunks, so they are
+    // packed in place.
+    uint64_t delta[TRACK_BLOCK_POINTS];
+    uint64_t dod[TRACK_BLOCK_POINTS];
+    uint64_t delta_bits = 0;
+    uint64_t dod_bits = 0;
+    if (n > 1) {
+        delta[0] = dod[0] = zigzagEncode(values[1] - values[0]);
+        delta_bits = dod_bits = delta[0];
+    }
+    // Both predictors straight from the values, with no carried step, so
+    // the loop vectorises.
+    for (size_t i = 2; i < n; ++i) {
+        const int64_t step = values[i] - values[i - 1];
+        delta[i - 1] = zigzagEncode(step);
+        dod[i - 1] = zigzagEncode(step - (values[i - 1] - values[i - 2]));
+        delta_bits |= delta[i - 1];
+        dod_bits |= dod[i - 1];
+    }
+    const size_t padded = paddedCount(n - 1);
+    std::fill(delta + n - 1, delta + padded, 0);
+    std::fill(dod + n - 1, dod + padded, 0);
+
+    const int delta_width = bitWidth(delta_bits);
+    const int dod_width = bitWidth(dod_bits);
+    const bool use_dod = dod_width < delta_width;
+    out.push_back(use_dod ? SERIES_DELTA_OF_DELTA : SERIES_DELTA);
+    packPadded(use_dod ? dod : delta, n - 1, use_dod ? dod_width : delta_width, out);
+}
+
+const uint8_t* decodeSeries(const uint8_t* in, size_t n, int64_t* values) {
+    if (n == 0) {
+        return in;
+    }
+    uint64_t first;
+    in = readVarint(in, first);
+    const uint8_t mode = *in++;
+    if (mode == SERIES_CONSTANT_STEP) {
+        uint64_t step;
+        in = readVarint(in, step);
+        const int64_t first_value = zigzagDecode(first);
+        const int64_t step_value = zigzagDecode(step);
+        for (size_t i = 0; i < n; ++i) {
+            values[i] = first_value + static_cast<int64_t>(i) * step_value;
+        }
+        return in;
+    }
+
+    uint64_t residuals[TRACK_BLOCK_POINTS];
+    in = unpackPadded(in, n - 1, residuals);
+
+    int64_t v = zigzagDecode(first);
+    values[0] = v;
+    if (mode == SERIES_DELTA_OF_DELTA) {
+        int64_t d = 0;
+        for (size_t i = 1; i < n; ++i) {
+            d += zigzagDecode(residuals[i - 1]);
+            v += d;
+            values[i] = v;
+        }
+    }
+    else {
+        for (size_t i = 1; i < n; ++i) {
+            v += zigzagDecode(residuals[i - 1]);
+            values[i] = v;
+        }
+    }
+    return in;
+}
+
+CompressedTrack::CompressedTrack(double quantum) :
+    _quantum(quantum),
+    _inv_quantum(1.0 / quantum)
+{
+}
+
+void CompressedTrack::sealBlock() {
+    const size_t n = _tail;
+    const int64_t* ticks = _tail_columns.data();
+    _blocks.push_back({
+        static_cast<uint64_t>(ticks[0]),
+        static_cast<uint64_t>(ticks[n - 1]),
+        _bytes.size(),
+        n
+    });
+    encodeSeries(ticks, n, _bytes);
+    encodeSeries(ticks + TRACK_BLOCK_POINTS, n, _bytes);
+    encodeSeries(ticks + 2 * TRACK_BLOCK_POINTS, n, _bytes);
+    _sealed_points += n;
+    _tail = 0;
+}
+
+void CompressedTrack::clear() {
+    _bytes.clear();
+    _blocks.clear();
+    _sealed_points = 0;
+    _tail = 0;
+}
+
+// Drops whole sealed blocks from the front while at least keep_points remain.
+void CompressedTrack::trimFront(size_t keep_points) {
+    size_t drop = 0;
+    size_t remaining = size();
+    while (drop < _blocks.size() && remaining - _blocks[drop].count >= keep_points) {
+        remaining -= _blocks[drop].count;
+        _sealed_points -= _blocks[drop].count;
+        ++drop;
+    }
+    if (drop == 0) {
+        return;
+    }
+
+    const size_t cut = drop < _blocks.size() ? _blocks[drop].offset : _bytes.size();
+    _bytes.erase(_bytes.begin(), _bytes.begin() + cut);
+    _blocks.erase(_blocks.begin(), _blocks.begin() + drop);
+    for (Block& block : _blocks) {
+        block.offset -= cut;
+    }
+}
+
+size_t CompressedTrack::size() const {
+    return _sealed_points + _tail;
+}
+
+size_t CompressedTrack::byteSize() const {
+    return _bytes.size() + _tail * 3 * sizeof(int64_t);
+}
+
+uint64_t CompressedTrack::firstTick() const {
+    if (!_blocks.empty()) {
+        return _blocks.front().first_tick;
+    }
+    return _tail == 0 ? 0 : static_cast<uint64_t>(_tail_columns[0]);
+}
+
+uint64_t CompressedTrack::lastTick() const {
+    if (_tail > 0) {
+        return static_cast<uint64_t>(_tail_columns[_tail - 1]);
+    }
+    return _blocks.empty() ? 0 : _blocks.back().last_tick;
+}
+
+void CompressedTrack::decodeBlock(const Block& block, uint64_t from_tick, uint64_t to_tick, std::vector<TrackPoint>& out) const {
+    int64_t ticks[TRACK_BLOCK_POINTS];
+    int64_t xs[TRACK_BLOCK_POINTS];
+    int64_t ys[TRACK_BLOCK_POINTS];
+
+    const size_t n = block.count;
+    const uint8_t* p = _bytes.data() + block.offset;
+    p = decodeSeries(p, n, ticks);
+    p = decodeSeries(p, n, xs);
+    decodeSeries(p, n, ys);
+
+    if (block.first_tick >= from_tick && block.last_tick <= to_tick) {
+        const size_t base = out.size();
+        out.resize(base + n);
+        TrackPoint* dst = out.data() + base;
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = { static_cast<uint64_t>(ticks[i]), xs[i] * _quantum, ys[i] * _quantum };
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t tick = static_cast<uint64_t>(ticks[i]);
+        if (tick >= from_tick && tick <= to_tick) {
+            out.push_back({ tick, xs[i] * _quantum, ys[i] * _quantum });
+        }
+    }
+}
+
+void CompressedTrack::decodeTail(size_t first, uint64_t from_tick, uint64_t to_tick, std::vector<TrackPoint>& out) const {
+    const int64_t* ticks = _tail_columns.data();
+    const int64_t* xs = ticks + TRACK_BLOCK_POINTS;
+    const int64_t* ys = ticks + 2 * TRACK_BLOCK_POINTS;
+    for (size_t i = first; i < _tail; ++i) {
+        const uint64_t tick = static_cast<uint64_t>(ticks[i]);
+        if (tick >= from_tick && tick <= to_tick) {
+            out.push_back({ tick, xs[i] * _quantum, ys[i] * _quantum });
+        }
+    }
+}
+
+void CompressedTrack::decode(uint64_t from_tick, uint64_t to_tick, std::vector<TrackPoint>& out) const {
+    auto it = std::lower_bound(_blocks.begin(), _blocks.end(), from_tick, [](const Block& b, uint64_t t) {
+        return b.last_tick < t;
+    });
+    for (; it != _blocks.end() && it->first_tick <= to_tick; ++it) {
+        decodeBlock(*it, from_tick, to_tick, out);
+    }
+    decodeTail(0, from_tick, to_tick, out);
+}
+
+void CompressedTrack::decodeLast(size_t n, std::vector<TrackPoint>& out) const {
+    if (n <= _tail) {
+        decodeTail(_tail - n, 0, UINT64_MAX, out);
+        return;
+    }
+
+    size_t need = n - _tail;
+    size_t first = _blocks.size();
+    while (first > 0 && need > 0) {
+        --first;
+        need -= std::min(need, _blocks[first].count);
+    }
+
+    const size_t start = out.size();
+    for (size_t b = first; b < _blocks.size(); ++b) {
+        decodeBlock(_blocks[b], 0, UINT64_MAX, out);
+    }
+    decodeTail(0, 0, UINT64_MAX, out);
+
+    const size_t decoded = out.size() - start;
+    if (decoded > n) {
+        out.erase(out.begin() + start, out.begin() + start + (decoded - n));
+    }
+}
@@ -0,0 +1,97 @@
+#include "worker-pool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 1; i < threads; ++i) {
+        _threads.emplace_back(&WorkerPool::workLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+size_t WorkerPool::threadCount() const {
+    return _threads.size() + 1;
+}
+
+void WorkerPool::parallelFor(size_t n, size_t min_chunk, const std::function<void(size_t, size_t)>& fn) {
+    if (n == 0) {
+        return;
+    }
+
+    // A few chunks per thread, so one slow chunk does not hold up the rest.
+    const size_t target_chunks = threadCount() * 4;
+    const size_t chunk = std::max<size_t>({ min_chunk, (n + target_chunks - 1) / target_chunks, 1 });
+    if (_threads.empty() || chunk >= n) {
+        fn(0, n);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(_run_mutex);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _fn = &fn;
+        _n = n;
+        _chunk = chunk;
+        _chunks = (n + chunk - 1) / chunk;
+        _next_chunk = 0;
+        _finished_chunks = 0;
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this] {
+        return _finished_chunks == _chunks && _active_workers == 0;
+    });
+    _fn = nullptr;
+}
+
+void WorkerPool::runChunks() {
+    size_t finished = 0;
+    for (size_t c = _next_chunk++; c < _chunks; c = _next_chunk++) {
+        const size_t begin = c * _chunk;
+        (*_fn)(begin, std::min(begin + _chunk, _n));
+        ++finished;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _finished_chunks += finished;
+}
+
+void WorkerPool::workLoop() {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [&] {
+                return _stopping || (_generation != seen && _fn);
+            });
+            if (_stopping) {
+                return;
+            }
+            seen = _generation;
+            ++_active_workers;
+        }
+        runChunks();
+
+        // The caller returns only once every worker has left the job, so
+        // no thread can still be reading it when the next one is posted.
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_active_workers == 0 && _finished_chunks == _chunks) {
+            _done.notify_one();
+        }
+    }
+}
@@ -3,6 +3,7 @@
 #include <QObject>
 #include <QTcpSocket>
 #include "target.h"
+#include "protocol.h"
 
 class NetworkClient : public QObject {
     Q_OBJECT
@@ -13,6 +14,13 @@ public:
 
 signals:
     void newFrame(const std::vector<Target>& targets);
+    void newSector(int sector, int sectors, const std::vector<Target>& targets);
+    void targetEvents(const std::vector<TargetEvent>& events);
+    void newTracks(const std::vector<TrackReport>& tracks);
+    void newPlots(const std::vector<float>& plots);
+    void trackerStats(const TrackerStats& stats);
+    void newAlarms(const std::vector<AlarmReport>& alarms);
+    void videoSpoke(int azimuth, int azimuths, const QByteArray& intensity);
     void errorOccured(const QString& msg);
 
 private slots:
@@ -21,6 +29,8 @@ private slots:
     void onError(QAbstractSocket::SocketError);
 
 private:
+    void handleMessage(quint16 type, const QByteArray& payload);
+
     QTcpSocket* _socket;
     QByteArray  _buffer;
 };
@@ -2,10 +2,19 @@
 
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLFramebufferObject>
 #include <QTimer>
 #include <QMutex>
 #include <vector>
+#include <memory>
 #include "target.h"
+#include "spatial-grid.h"
+#include "slot-map.h"
+#include "track-codec.h"
+#include "protocol.h"
+#include "worker-pool.h"
+#include "scan-converter.h"
 
 class RadarWidget : public QOpenGLWidget, protected QOpenGLFunctions {
     Q_OBJECT
@@ -14,6 +23,16 @@ public:
     ~RadarWidget() override;
 
     void setTargets(const std::vector<Target>& targets);
+    // Sweep mode: replaces the targets shown in one bearing sector and
+    // repaints only around it.
+    void setSectorTargets(int sector, int sectors, const std::vector<Target>& targets);
+    std::vector<Target> targets() const;
+    void setTracks(const std::vector<TrackReport>& tracks);
+    void setPlots(const std::vector<float>& plots);
+    void setVideoSpoke(int azimuth, int azimuths, const QByteArray& intensity);
+    void setPersistence(bool enabled);
+    void setPersistenceDecay(double decay);
+    void setTrailLength(int frames);
 
 signals:
     void cursorPositionChanged(double distance, double angle_deg);
@@ -30,29 +49,83 @@ protected:
     void mousePressEvent(QMouseEvent* event) override;
 
 private:
+    struct LayerRange {
+        GLint first = 0;
+        GLsizei count = 0;
+    };
+
+    void buildStaticLayers(int w, int h);
+    void drawStaticLayer(GLenum mode, const LayerRange& layer);
     void drawTargets();
-    void generateNoise();
-    void drawNoise();
+    void drawTracks();
+    void drawPlots();
+    void uploadVideo();
+    void drawVideo();
     void drawTrails();
+    void drawLongTrails();
+    void updateTracks();
+    void indexTargets();
+    void fileTargets(int sectors);
+    void appendTarget(const Target& target, int sector);
+    void removeTarget(int row);
+    QRect sectorRect(int sector, int sectors) const;
+    QRect markerRect(const Target& target) const;
+    void accumulatePersistence();
+    void drawPersistence();
     void drawSingleTarget(const Target& target);
     
     void onUpdateTimer();
     void onBlinkTimer();
 
+    int pickTarget(const QPointF& pos);
+
     Eigen::Vector2d pixelToPolar(const QPointF& pos) const;
+    Eigen::Vector2d pixelToWorld(const QPointF& pos) const;
     QPointF polarToPixel(double distance, double angle) const;
 
     std::vector<Target> _targets;
-    std::vector<uint8_t> _noise_data;
+    std::vector<TrackReport> _reported_tracks;
+    std::vector<float> _plot_xy;
+    std::vector<double> _target_xs;
+    std::vector<double> _target_ys;
+    SpatialGrid _target_index{ 1000.0, 20.0 };
+    bool _target_index_stale = false;
+    std::vector<std::vector<int>> _sector_rows;   // rows of _targets per sweep sector
+    std::vector<int> _row_sector;
+    std::vector<int> _row_slot;                   // position of the row in its sector
+    HandleTable<int> _target_lookup;
+    HandleTable<CompressedTrack> _tracks;
+    std::vector<int> _track_ids;
+    std::vector<TrackPoint> _trail_points;
+    uint64_t _frame = 0;
+    int _trail_length = 0;
+    std::vector<uint8_t> _video_data;
+    std::vector<uint8_t> _spoke_dirty;
+    WorkerPool _workers;
+    ScanConverter _scan_converter{ _workers };
     QTimer _update_timer;
     QTimer _blink_timer;
-    QMutex _data_mutex;
-    GLuint _grid_list = 0;
-    GLuint _noise_tex = 0;
+    mutable QMutex _data_mutex;
+    QOpenGLBuffer _static_vbo{ QOpenGLBuffer::VertexBuffer };
+    LayerRange _disk_layer;
+    LayerRange _rings_layer;
+    LayerRange _spokes_layer;
+    LayerRange _border_layer;
+    std::unique_ptr<QOpenGLFramebufferObject> _persistence_fbo;
+    GLuint _video_tex = 0;
     QPointF _cursor_pos;
-    int _noise_w = 1000, _noise_h = 360;
+    int _video_bins = 1000, _video_azimuths = 360;
+    bool _video_dirty = false;
+    bool _video_resized = true;
     int _selected_target_id = -1;
+    int _hover_target_id = -1;
 
     bool _blink_only = false;
     bool _blink_on = false;
+    bool _persistence = false;
+    bool _persistence_pending = false;
+    bool _sweeping = false;
+    bool _full_repaint = true;
+    QRect _sweep_rect;                    // to repaint when only sectors changed
+    float _persistence_decay = 0.85f;
 };
\ No newline at end of file
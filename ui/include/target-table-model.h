@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <vector>
+#include <limits>
+#include "target.h"
+#include "slot-map.h"
+
+class TargetTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column {
+        IdColumn = 0,
+        DistanceColumn,
+        BearingColumn,
+        ColumnCount
+    };
+
+    explicit TargetTableModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    void updateTargets(const std::vector<Target>& targets);
+
+    void setRangeFilter(double min_distance, double max_distance);
+    void setBearingFilter(double from_deg, double to_deg);
+    void clearFilters();
+
+    int rowForId(int id) const;
+    int idAt(int row) const;
+
+private:
+    // Ties on the key are broken by id, as in lessThan().
+    struct SortEntry {
+        uint64_t key;
+        uint32_t id;
+        int slot;
+    };
+
+    bool accepts(int slot) const;
+    bool lessThan(int a, int b) const;
+
+    template<typename Pred>
+    void hideRows(Pred&& hide);
+    void showAcceptedRows();
+    void releaseUnseenSlots();
+    void restoreOrder();
+    void sortDisplaced();
+    void refilter();
+
+    std::vector<int> _ids;
+    std::vector<double> _distances;
+    std::vector<double> _bearings;
+    std::vector<double> _keys;
+    std::vector<uint32_t> _seen;
+    std::vector<int> _row_of_slot;
+    HandleTable<int> _slot_of;
+
+    std::vector<int> _order;
+    std::vector<int> _kept;
+    std::vector<SortEntry> _displaced;
+    std::vector<SortEntry> _radix_buffer;
+    std::vector<int> _next_order;
+    std::vector<size_t> _fresh;
+
+    int _sort_column = IdColumn;
+    Qt::SortOrder _sort_order = Qt::AscendingOrder;
+
+    double _min_distance = 0.0;
+    double _max_distance = std::numeric_limits<double>::max();
+    double _bearing_from = 0.0;
+    double _bearing_to = 360.0;
+
+    uint32_t _frame = 0;
+};
@@ -5,13 +5,14 @@
 #include <QLabel>
 #include "radar-widget.h"
 #include "network-client.h"
+#include "target-table-model.h"
 
 #ifdef Q_OS_WIN
 #include <windows.h>
 #endif
 
 
-class QTableWidget;
+class QTableView;
 class QPushButton;
 class QStatusBar;
 
@@ -25,6 +26,13 @@ private slots:
     void exitApp();
     void updateTime();
     void handleNewFrame(const std::vector<Target>& targets);
+    void handleNewSector(int sector, int sectors, const std::vector<Target>& targets);
+    void handleTargetEvents(const std::vector<TargetEvent>& events);
+    void handleNewTracks(const std::vector<TrackReport>& tracks);
+    void handleNewPlots(const std::vector<float>& plots);
+    void handleTrackerStats(const TrackerStats& stats);
+    void handleAlarms(const std::vector<AlarmReport>& alarms);
+    void handleVideoSpoke(int azimuth, int azimuths, const QByteArray& intensity);
     void onTargetSelected(int id);
     void onCursorMoved(double dist, double angle);
     void handleError(const QString& msg);
@@ -40,13 +48,17 @@ private:
     void blockMultipleInstances();
 
     RadarWidget* _radar;
-    QTableWidget* _table;
+    QTableView* _table;
+    TargetTableModel* _table_model;
     QPushButton* _pause_button;
     QPushButton* _exit_button;
     QStatusBar* _status_bar;
     NetworkClient* _client;
     QLockFile* _lock_file;
     QLabel* _cursor_label;
+    QLabel* _tracker_label;
+    QLabel* _alarm_label;
+    quint64 _alarm_count = 0;
     int _selected_target_id = -1;
     bool _paused = false;
     bool _exiting = false;
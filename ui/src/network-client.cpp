@@ -2,6 +2,22 @@
 #include <QDataStream>
 #include <QImage>
 #include <QBuffer>
+#include <cstring>
+
+// One record of the target frame, also used by sector messages.
+static Target readTarget(QDataStream& in, std::vector<Eigen::Vector2d>& trail) {
+    int id; double dist, ang, dir;
+    double r, g, b; uint8_t ts;
+    in >> id >> dist >> ang >> dir;
+    in >> r >> g >> b;
+    in >> ts;
+    trail.clear();
+    for (int j = 0; j < ts; ++j) {
+        double x, y; in >> x >> y;
+        trail.emplace_back(x, y);
+    }
+    return Target(id, dist, ang, dir, Eigen::Vector3d(r, g, b), trail);
+}
 
 NetworkClient::NetworkClient(QObject* parent)
     : QObject(parent), _socket(new QTcpSocket(this))
@@ -30,6 +46,9 @@ void NetworkClient::onError(QAbstractSocket::SocketError) {
     emit errorOccured(_socket->errorString());
 }
 
+// Messages are parsed in place from a read offset and the consumed bytes are
+// dropped once per call, so a burst of small messages (video spokes) costs
+// time linear in the bytes received rather than one shift of the buffer each.
 void NetworkClient::onReadyRead() {
     _buffer.append(_socket->readAll());
 
@@ -38,62 +57,188 @@ void NetworkClient::onReadyRead() {
     QDataStream in(&buf);
     in.setByteOrder(QDataStream::LittleEndian);
 
-    const quint32 MAGIC = 0xABCDEF01;
-    const int TRAIL_SIZE = 3;
     const qint64 PER_TGT_HDR = 4 + 6 * 8 + 1;
-    const qint64 PER_TGT_PT = TRAIL_SIZE * 2 * 8;
+    const qint64 PER_TGT_PT = qint64(TRAIL_SIZE + 1) * 2 * 8;
     const qint64 PER_TGT_SIZE = PER_TGT_HDR + PER_TGT_PT;
 
+    qint64 consumed = 0;
     while (true) {
-        if (buf.bytesAvailable() < int(sizeof(quint32) + sizeof(quint16))) {
+        if (buf.bytesAvailable() < int(sizeof(quint32))) {
             break;
         }
 
         in.startTransaction();
         quint32 magic;  in >> magic;
-        if (magic != MAGIC) {
-            _buffer.remove(0, 1);
-            buf.close();
-            buf.setData(_buffer);
-            buf.open(QIODevice::ReadOnly);
-            in.setDevice(&buf);
-            continue;
-        }
 
-        quint16 count; in >> count;
-        qint64 need = count * PER_TGT_SIZE;
-        if (buf.bytesAvailable() < need) {
-            in.rollbackTransaction();
-            break;
+        if (magic == MESSAGE_MAGIC) {
+            quint16 type; quint32 size;
+            in >> type >> size;
+            if (in.status() != QDataStream::Ok || buf.bytesAvailable() < qint64(size)) {
+                in.rollbackTransaction();
+                break;
+            }
+
+            QByteArray payload(int(size), Qt::Uninitialized);
+            in.readRawData(payload.data(), int(size));
+            in.commitTransaction();
+
+            handleMessage(type, payload);
         }
+        else if (magic == FRAME_MAGIC) {
+            quint32 count; in >> count;
+            qint64 need = qint64(count) * PER_TGT_SIZE;
+            if (in.status() != QDataStream::Ok || buf.bytesAvailable() < need) {
+                in.rollbackTransaction();
+                break;
+            }
 
-        std::vector<Target> targets;
-        targets.reserve(count);
-        for (int i = 0; i < count; ++i) {
-            int id; double dist, ang, dir;
-            double r, g, b; uint8_t ts;
-            in >> id >> dist >> ang >> dir;
-            in >> r >> g >> b;
-            in >> ts;
+            std::vector<Target> targets;
+            targets.reserve(count);
             std::vector<Eigen::Vector2d> trail;
-            trail.reserve(ts);
-            for (int j = 0; j < ts; ++j) {
-                double x, y; in >> x >> y;
-                trail.emplace_back(x, y);
+            for (quint32 i = 0; i < count; ++i) {
+                targets.push_back(readTarget(in, trail));
+            }
+
+            if (in.status() != QDataStream::Ok) {
+                in.rollbackTransaction();
+                break;
             }
-            targets.emplace_back(id, dist, ang, dir, Eigen::Vector3d(r, g, b), trail);
+            in.commitTransaction();
+
+            emit newFrame(targets);
+        }
+        else {
+            // Not at a message: resynchronise one byte further on.
+            in.abortTransaction();
+            in.resetStatus();
+            buf.seek(++consumed);
+            continue;
         }
 
-        in.commitTransaction();
+        consumed = buf.pos();
+    }
 
-        emit newFrame(targets);
+    buf.close();
+    _buffer.remove(0, int(consumed));
+}
 
-        qint64 consumed = buf.pos();
-        _buffer.remove(0, consumed);
+void NetworkClient::handleMessage(quint16 type, const QByteArray& payload) {
+    QDataStream in(payload);
+    in.setByteOrder(QDataStream::LittleEndian);
 
-        buf.close();
-        buf.setData(_buffer);
-        buf.open(QIODevice::ReadOnly);
-        in.setDevice(&buf);
+    switch (static_cast<MessageType>(type)) {
+    case MessageType::TargetEvents: {
+        quint32 count; in >> count;
+        std::vector<TargetEvent> events;
+        events.reserve(count);
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            quint8 kind; qint32 id;
+            in >> kind >> id;
+            events.push_back({ static_cast<TargetEvent::Type>(kind), id });
+        }
+        emit targetEvents(events);
+        break;
+    }
+    case MessageType::Tracks: {
+        quint32 count; in >> count;
+        if (qint64(count) * TRACK_RECORD_SIZE > payload.size()) {
+            break;
+        }
+        std::vector<TrackReport> tracks;
+        tracks.reserve(count);
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            TrackReport t;
+            qint32 id;
+            in >> id >> t.distance >> t.angle >> t.heading >> t.speed >> t.sigma;
+            t.id = id;
+            tracks.push_back(t);
+        }
+        emit newTracks(tracks);
+        break;
+    }
+    case MessageType::Plots: {
+        quint64 tick; quint32 count;
+        in >> tick >> count;
+        if (in.status() != QDataStream::Ok || qint64(count) * PLOT_RECORD_SIZE > payload.size() - 12) {
+            break;
+        }
+        // Interleaved (distance, angle) pairs, copied straight from the payload.
+        std::vector<float> plots(size_t(count) * 2);
+        std::memcpy(plots.data(), payload.constData() + 12, size_t(count) * PLOT_RECORD_SIZE);
+        emit newPlots(plots);
+        break;
+    }
+    case MessageType::TrackerStats: {
+        if (payload.size() < TRACKER_STATS_SIZE) {
+            break;
+        }
+        TrackerStats stats;
+        quint64 tick;
+        quint32 confirmed, tentative, coasting;
+        in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        in >> tick >> confirmed >> tentative >> coasting >> stats.tick_ms;
+        stats.tick = tick;
+        stats.confirmed = confirmed;
+        stats.tentative = tentative;
+        stats.coasting = coasting;
+        emit trackerStats(stats);
+        break;
+    }
+    case MessageType::Alarms: {
+        quint32 count; in >> count;
+        if (qint64(count) * ALARM_RECORD_HEADER_SIZE > payload.size()) {
+            break;
+        }
+        in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        std::vector<AlarmReport> alarms;
+        alarms.reserve(count);
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            quint64 tick; qint32 id; quint8 length;
+            AlarmReport a;
+            in >> tick >> id >> a.distance >> a.angle >> length;
+            QByteArray name(length, Qt::Uninitialized);
+            if (in.readRawData(name.data(), length) != length) {
+                break;
+            }
+            a.tick = tick;
+            a.id = id;
+            a.rule = name.toStdString();
+            alarms.push_back(std::move(a));
+        }
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        emit newAlarms(alarms);
+        break;
     }
-}
\ No newline at end of file
+    case MessageType::VideoSpoke: {
+        quint64 tick; quint16 azimuth, azimuths, bins;
+        in >> tick >> azimuth >> azimuths >> bins;
+        if (in.status() != QDataStream::Ok || azimuth >= azimuths
+            || payload.size() < VIDEO_SPOKE_HEADER_SIZE + bins) {
+            break;
+        }
+        emit videoSpoke(azimuth, azimuths, payload.mid(VIDEO_SPOKE_HEADER_SIZE, bins));
+        break;
+    }
+    case MessageType::Sector: {
+        quint64 tick; quint16 sector, sectors; quint32 count;
+        in >> tick >> sector >> sectors >> count;
+        if (in.status() != QDataStream::Ok || sector >= sectors) {
+            break;
+        }
+        std::vector<Target> targets;
+        std::vector<Eigen::Vector2d> trail;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            targets.push_back(readTarget(in, trail));
+        }
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        emit newSector(sector, sectors, targets);
+        break;
+    }
+    default:
+        break;
+    }
+}
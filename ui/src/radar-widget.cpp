@@ -2,8 +2,13 @@
 #include <QPainter>
 #include <QDateTime>
 #include <QMouseEvent>
+#include <QToolTip>
+#include <algorithm>
 #include <cmath>
-#include <random>
+#include <cstring>
+
+static constexpr double PICK_RADIUS_PX = 12.0;
+static constexpr int SWEEP_MARGIN_PX = 16;     // target markers and trail ends reaching out of a sector
 
 RadarWidget::RadarWidget(QWidget* parent)
     : QOpenGLWidget(parent), QOpenGLFunctions()
@@ -12,23 +17,16 @@ RadarWidget::RadarWidget(QWidget* parent)
     QSurfaceFormat fmt = format();
     fmt.setStencilBufferSize(8);
     setFormat(fmt);
+    // Keeps the last frame, so a sweep can repaint one sector of it.
+    setUpdateBehavior(QOpenGLWidget::PartialUpdate);
 
     setMouseTracking(true);
-    _noise_data.resize(_noise_w * _noise_h);
+    _video_data.resize(_video_bins * _video_azimuths);
+    _spoke_dirty.resize(_video_azimuths);
 
     connect(&_update_timer, &QTimer::timeout, this, [this]() {
-        generateNoise();
-
         makeCurrent();
-        glBindTexture(GL_TEXTURE_2D, _noise_tex);
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        glTexSubImage2D(
-            GL_TEXTURE_2D, 0, 0, 0,
-            _noise_w, _noise_h,
-            GL_LUMINANCE, GL_UNSIGNED_BYTE,
-            _noise_data.data()
-        );
-        glBindTexture(GL_TEXTURE_2D, 0);
+        uploadVideo();
         doneCurrent();
 
         _blink_only = false;
@@ -36,12 +34,16 @@ RadarWidget::RadarWidget(QWidget* parent)
             _blink_on = true;
             _blink_timer.start(200);
         }
-        update();
+        if (!_sweeping) {
+            _full_repaint = true;
+            update();
+        }
     });
     _update_timer.start(500);
     connect(&_blink_timer, &QTimer::timeout, this, [this]() {
         _blink_only = true;
         _blink_on = !_blink_on;
+        _full_repaint = true;
         update();
     });
 
@@ -51,14 +53,14 @@ RadarWidget::RadarWidget(QWidget* parent)
 
 RadarWidget::~RadarWidget() {
     makeCurrent();
-    if (_noise_tex) {
-        glDeleteTextures(1, &_noise_tex);
-        _noise_tex = 0;
+    if (_video_tex) {
+        glDeleteTextures(1, &_video_tex);
+        _video_tex = 0;
     }
-    if (_grid_list) {
-        glDeleteLists(_grid_list, 1);
-        _grid_list = 0;
+    if (_static_vbo.isCreated()) {
+        _static_vbo.destroy();
     }
+    _persistence_fbo.reset();
     doneCurrent();
 }
 
@@ -66,72 +68,22 @@ void RadarWidget::initializeGL() {
     initializeOpenGLFunctions();
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    glGenTextures(1, &_noise_tex);
-    glBindTexture(GL_TEXTURE_2D, _noise_tex);
+    glGenTextures(1, &_video_tex);
+    glBindTexture(GL_TEXTURE_2D, _video_tex);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-
-    glTexImage2D(
-        GL_TEXTURE_2D, 0,
-        GL_LUMINANCE,
-        _noise_w, _noise_h, 0,
-        GL_LUMINANCE,
-        GL_UNSIGNED_BYTE,
-        nullptr
-    );
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    _noise_data.resize(_noise_w * _noise_h);
-
-    _grid_list = glGenLists(1);
-    glNewList(_grid_list, GL_COMPILE);
-
-    glColor3f(0.5f, 0.5f, 0.5f);
-    int maxR = std::min(width(), height()) / 2;
-    for (int r_m = 200; r_m < 1000; r_m += 200) {
-        double radius = double(r_m) * maxR / 1000.0;
-        glBegin(GL_LINE_LOOP);
-        for (int deg = 0; deg < 360; deg += 5) {
-            double a = deg * EIGEN_PI / 180.0;
-            glVertex2f(width() / 2 + radius * cos(a),
-                height() / 2 + radius * sin(a));
-        }
-        glEnd();
-    }
-
-    glColor3f(0.7f, 0.7f, 0.7f);
-    glLineStipple(1, 0x00FF);
-    glEnable(GL_LINE_STIPPLE);
-    for (int i = 0; i < 8; ++i) {
-        double a = i * EIGEN_PI / 4.0;
-        double R = maxR;
-        glBegin(GL_LINES);
-        glVertex2f(width() / 2, height() / 2);
-        glVertex2f(width() / 2 + R * cos(a),
-            height() / 2 + R * sin(a));
-        glEnd();
-    }
-    glDisable(GL_LINE_STIPPLE);
-
-    glEndList();
-
-    
+    _static_vbo.create();
+    _static_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
 }
 
 void RadarWidget::onUpdateTimer() {
-    generateNoise();
-
-    glBindTexture(GL_TEXTURE_2D, _noise_tex);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-        _noise_w, _noise_h,
-        GL_LUMINANCE, GL_UNSIGNED_BYTE,
-        _noise_data.data());
-    glBindTexture(GL_TEXTURE_2D, 0);
+    uploadVideo();
 
     _blink_only = false;
     if (_selected_target_id >= 0 && !_blink_timer.isActive()) {
@@ -139,51 +91,106 @@ void RadarWidget::onUpdateTimer() {
         _blink_timer.start(200);
     }
 
+    _full_repaint = true;
     update();
 }
 
 void RadarWidget::resizeGL(int w, int h) {
     glViewport(0, 0, w, h);
+    buildStaticLayers(w, h);
+    _persistence_fbo.reset();
+    _full_repaint = true;
 
-    if (_grid_list) {
-        glDeleteLists(_grid_list, 1);
-        _grid_list = 0;
+    {
+        QMutexLocker lk(&_data_mutex);
+        _video_resized = true;
     }
+    uploadVideo();
+}
 
-    _grid_list = glGenLists(1);
-    glNewList(_grid_list, GL_COMPILE);
+void RadarWidget::buildStaticLayers(int w, int h) {
+    constexpr int DISK_SEGS = 64;
+    constexpr int RING_STEP_DEG = 5;
+
+    std::vector<GLfloat> verts;
+    auto vertex = [&verts](double x, double y) {
+        verts.push_back(static_cast<GLfloat>(x));
+        verts.push_back(static_cast<GLfloat>(y));
+    };
+    auto vertexCount = [&verts]() {
+        return static_cast<GLint>(verts.size() / 2);
+    };
+
+    const double cx = w * 0.5;
+    const double cy = h * 0.5;
+    const double maxR = std::min(w, h) * 0.5;
+
+    _disk_layer.first = vertexCount();
+    vertex(cx, cy);
+    for (int i = 0; i <= DISK_SEGS; ++i) {
+        double a = 2 * EIGEN_PI * i / DISK_SEGS;
+        vertex(cx + cos(a) * maxR, cy + sin(a) * maxR);
+    }
+    _disk_layer.count = vertexCount() - _disk_layer.first;
 
-    glColor3f(0.5f, 0.5f, 0.5f);
-    int maxR = std::min(w, h) / 2;
-    for (int r_m = 200; r_m <= 1000; r_m += 200) {
+    _rings_layer.first = vertexCount();
+    for (int r_m = 200; r_m < 1000; r_m += 200) {
         double radius = double(r_m) * maxR / 1000.0;
-        glBegin(GL_LINE_LOOP);
-        for (int deg = 0; deg < 360; deg += 5) {
-            double a = deg * EIGEN_PI / 180.0;
-            glVertex2f(w / 2 + radius * cos(a),
-                h / 2 + radius * sin(a));
+        for (int deg = 0; deg < 360; deg += RING_STEP_DEG) {
+            double a0 = deg * EIGEN_PI / 180.0;
+            double a1 = (deg + RING_STEP_DEG) * EIGEN_PI / 180.0;
+            vertex(cx + radius * cos(a0), cy + radius * sin(a0));
+            vertex(cx + radius * cos(a1), cy + radius * sin(a1));
         }
-        glEnd();
     }
+    _rings_layer.count = vertexCount() - _rings_layer.first;
 
-    glColor3f(0.7f, 0.7f, 0.7f);
-    glLineStipple(1, 0x00FF);
-    glEnable(GL_LINE_STIPPLE);
+    _spokes_layer.first = vertexCount();
     for (int i = 0; i < 8; ++i) {
         double a = i * EIGEN_PI / 4.0;
-        double R = maxR;
-        glBegin(GL_LINES);
-        glVertex2f(w / 2, h / 2);
-        glVertex2f(w / 2 + R * cos(a),
-            h / 2 + R * sin(a));
-        glEnd();
+        vertex(cx, cy);
+        vertex(cx + maxR * cos(a), cy + maxR * sin(a));
     }
-    glDisable(GL_LINE_STIPPLE);
+    _spokes_layer.count = vertexCount() - _spokes_layer.first;
+
+    _border_layer.first = vertexCount();
+    for (int i = 0; i < DISK_SEGS; ++i) {
+        double a = 2 * EIGEN_PI * i / DISK_SEGS;
+        vertex(cx + cos(a) * maxR, cy + sin(a) * maxR);
+    }
+    _border_layer.count = vertexCount() - _border_layer.first;
 
-    glEndList();
+    _static_vbo.bind();
+    _static_vbo.allocate(verts.data(), static_cast<int>(verts.size() * sizeof(GLfloat)));
+    _static_vbo.release();
+}
+
+void RadarWidget::drawStaticLayer(GLenum mode, const LayerRange& layer) {
+    _static_vbo.bind();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, nullptr);
+    glDrawArrays(mode, layer.first, layer.count);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    _static_vbo.release();
 }
 
 void RadarWidget::paintGL() {
+    uploadVideo();
+
+    // Persistence fades the whole picture, so it always repaints in full.
+    const bool partial = !_full_repaint && !_persistence && !_sweep_rect.isEmpty();
+    if (partial) {
+        const qreal dpr = devicePixelRatioF();
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(
+            static_cast<GLint>(std::floor(_sweep_rect.x() * dpr)),
+            static_cast<GLint>(std::floor((height() - _sweep_rect.y() - _sweep_rect.height()) * dpr)),
+            static_cast<GLsizei>(std::ceil(_sweep_rect.width() * dpr)),
+            static_cast<GLsizei>(std::ceil(_sweep_rect.height() * dpr)));
+    }
+    _full_repaint = false;
+    _sweep_rect = QRect();
+
     glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
     glMatrixMode(GL_PROJECTION);
@@ -192,58 +199,60 @@ void RadarWidget::paintGL() {
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-    float cx = width() * 0.5f;
-    float cy = height() * 0.5f;
-    float maxR = std::min(width(), height()) * 0.5f;
-    const int segs = 64;
-
     glEnable(GL_STENCIL_TEST);
     glStencilFunc(GL_ALWAYS, 1, 0xFF);
     glStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE);
     glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex2f(cx, cy);
-    for (int i = 0; i <= segs; ++i) {
-        float a = 2 * EIGEN_PI * i / segs;
-        glVertex2f(cx + cos(a) * maxR, cy + sin(a) * maxR);
-    }
-    glEnd();
+    drawStaticLayer(GL_TRIANGLE_FAN, _disk_layer);
 
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glStencilFunc(GL_EQUAL, 1, 0xFF);
     glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 
-    drawNoise();
+    drawVideo();
+
+    if (_persistence) {
+        accumulatePersistence();
+        drawPersistence();
+    }
 
     glDisable(GL_STENCIL_TEST);
 
-    glCallList(_grid_list);
-    drawTrails();
+    glColor3f(0.5f, 0.5f, 0.5f);
+    drawStaticLayer(GL_LINES, _rings_layer);
+
+    glColor3f(0.7f, 0.7f, 0.7f);
+    glLineStipple(1, 0x00FF);
+    glEnable(GL_LINE_STIPPLE);
+    drawStaticLayer(GL_LINES, _spokes_layer);
+    glDisable(GL_LINE_STIPPLE);
+
+    if (!_persistence) {
+        drawTrails();
+    }
+    drawPlots();
     drawTargets();
+    drawTracks();
 
     if (_selected_target_id >= 0 && _blink_on) {
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        for (const auto& t : _targets) {
-            if (t.id == _selected_target_id) {
-                drawSingleTarget(t);
-                break;
-            }
+        if (const int* idx = _target_lookup.find(_selected_target_id)) {
+            drawSingleTarget(_targets[*idx]);
         }
         glDisable(GL_BLEND);
     }
 
     glLineWidth(3.0f);
     glColor3f(1.0f, 0.5f, 0.0f);
-    glBegin(GL_LINE_LOOP);
-    for (int i = 0; i < segs; ++i) {
-        float a = 2 * EIGEN_PI * i / segs;
-        glVertex2f(cx + cos(a) * maxR, cy + sin(a) * maxR);
-    }
-    glEnd();
+    drawStaticLayer(GL_LINE_LOOP, _border_layer);
     glLineWidth(1.0f);
     glColor3f(1, 1, 1);
+
+    if (partial) {
+        glDisable(GL_SCISSOR_TEST);
+    }
 }
 
 void RadarWidget::drawSingleTarget(const Target& target) {
@@ -266,6 +275,235 @@ void RadarWidget::drawSingleTarget(const Target& target) {
 void RadarWidget::setTargets(const std::vector<Target>& targets) {
     QMutexLocker lk(&_data_mutex);
     _targets = targets;
+    indexTargets();
+    _persistence_pending = true;
+
+    if (_trail_length > 0) {
+        updateTracks();
+    }
+}
+
+// Targets shown in the sector, and older copies elsewhere of targets that
+// moved into it, make way for the new ones. Rows are filed per sector so a
+// message touches only the rows it replaces. Trails advance once per
+// revolution, and once per revolution the whole picture is repainted.
+void RadarWidget::setSectorTargets(int sector, int sectors, const std::vector<Target>& targets) {
+    {
+        QMutexLocker lk(&_data_mutex);
+        if (_sector_rows.size() != static_cast<size_t>(sectors)) {
+            fileTargets(sectors);
+        }
+
+        QRect dirty = sectorRect(sector, sectors);
+        for (const auto& t : targets) {
+            const int* row = _target_lookup.find(t.id);
+            if (row && _row_sector[*row] != sector) {
+                dirty |= markerRect(_targets[*row]);
+                removeTarget(*row);
+            }
+        }
+        auto& rows = _sector_rows[sector];
+        while (!rows.empty()) {
+            removeTarget(rows.back());
+        }
+        for (const auto& t : targets) {
+            appendTarget(t, sector);
+        }
+        _target_index_stale = true;
+        _persistence_pending = true;
+
+        if (sector + 1 == sectors && _trail_length > 0) {
+            updateTracks();
+        }
+        _sweeping = true;
+        _full_repaint = _full_repaint || sector == 0;
+        _sweep_rect |= dirty;
+    }
+    update();
+}
+
+std::vector<Target> RadarWidget::targets() const {
+    QMutexLocker lk(&_data_mutex);
+    return _targets;
+}
+
+void RadarWidget::indexTargets() {
+    _target_xs.resize(_targets.size());
+    _target_ys.resize(_targets.size());
+    _target_lookup.clear();
+    for (size_t i = 0; i < _targets.size(); ++i) {
+        _target_lookup.set(_targets[i].id, static_cast<int>(i));
+        Eigen::Vector2d p = _targets[i].position();
+        _target_xs[i] = p.x();
+        _target_ys[i] = p.y();
+    }
+    _target_index.build(_target_xs, _target_ys);
+    _target_index_stale = false;
+    _sector_rows.clear();
+}
+
+// Files every row under the sector its angle falls in; needed only when
+// the sector count changes or the targets came from a whole-scan update.
+void RadarWidget::fileTargets(int sectors) {
+    const double width = 2 * EIGEN_PI / sectors;
+    _sector_rows.assign(sectors, {});
+    _row_sector.resize(_targets.size());
+    _row_slot.resize(_targets.size());
+    for (size_t i = 0; i < _targets.size(); ++i) {
+        double a = std::fmod(_targets[i].angle, 2 * EIGEN_PI);
+        a = a < 0.0 ? a + 2 * EIGEN_PI : a;
+        const int sector = std::min(static_cast<int>(a / width), sectors - 1);
+        _row_sector[i] = sector;
+        _row_slot[i] = static_cast<int>(_sector_rows[sector].size());
+        _sector_rows[sector].push_back(static_cast<int>(i));
+    }
+}
+
+void RadarWidget::appendTarget(const Target& target, int sector) {
+    const int row = static_cast<int>(_targets.size());
+    _targets.push_back(target);
+    Eigen::Vector2d p = target.position();
+    _target_xs.push_back(p.x());
+    _target_ys.push_back(p.y());
+    _target_lookup.set(target.id, row);
+    _row_sector.push_back(sector);
+    _row_slot.push_back(static_cast<int>(_sector_rows[sector].size()));
+    _sector_rows[sector].push_back(row);
+}
+
+// Swap-removes the row, moving the last row into its place.
+void RadarWidget::removeTarget(int row) {
+    auto& rows = _sector_rows[_row_sector[row]];
+    const int slot = _row_slot[row];
+    rows[slot] = rows.back();
+    _row_slot[rows[slot]] = slot;
+    rows.pop_back();
+    _target_lookup.erase(_targets[row].id);
+
+    const int last = static_cast<int>(_targets.size()) - 1;
+    if (row != last) {
+        _targets[row] = std::move(_targets[last]);
+        _target_xs[row] = _target_xs[last];
+        _target_ys[row] = _target_ys[last];
+        _row_sector[row] = _row_sector[last];
+        _row_slot[row] = _row_slot[last];
+        _sector_rows[_row_sector[row]][_row_slot[row]] = row;
+        _target_lookup.set(_targets[row].id, row);
+    }
+    _targets.pop_back();
+    _target_xs.pop_back();
+    _target_ys.pop_back();
+    _row_sector.pop_back();
+    _row_slot.pop_back();
+}
+
+// Bounding box of the sector's wedge: the centre, both arc ends and any
+// axis the arc crosses.
+QRect RadarWidget::sectorRect(int sector, int sectors) const {
+    const double cx = width() / 2.0;
+    const double cy = height() / 2.0;
+    const double maxR = std::min(width(), height()) / 2.0;
+    const double a0 = 2 * EIGEN_PI * sector / sectors;
+    const double a1 = 2 * EIGEN_PI * (sector + 1) / sectors;
+
+    double x0 = cx, x1 = cx, y0 = cy, y1 = cy;
+    auto extend = [&](double a) {
+        const double x = cx + maxR * cos(a);
+        const double y = cy + maxR * sin(a);
+        x0 = std::min(x0, x);
+        x1 = std::max(x1, x);
+        y0 = std::min(y0, y);
+        y1 = std::max(y1, y);
+    };
+    extend(a0);
+    extend(a1);
+    for (int quarter = 1; quarter < 4; ++quarter) {
+        const double a = quarter * EIGEN_PI / 2.0;
+        if (a > a0 && a < a1) {
+            extend(a);
+        }
+    }
+    return QRect(
+        QPoint(static_cast<int>(std::floor(x0)) - SWEEP_MARGIN_PX, static_cast<int>(std::floor(y0)) - SWEEP_MARGIN_PX),
+        QPoint(static_cast<int>(std::ceil(x1)) + SWEEP_MARGIN_PX, static_cast<int>(std::ceil(y1)) + SWEEP_MARGIN_PX)
+    ).intersected(rect());
+}
+
+QRect RadarWidget::markerRect(const Target& target) const {
+    const QPointF center = polarToPixel(target.distance, target.angle);
+    return QRectF(center.x() - SWEEP_MARGIN_PX, center.y() - SWEEP_MARGIN_PX,
+        2 * SWEEP_MARGIN_PX, 2 * SWEEP_MARGIN_PX).toAlignedRect().intersected(rect());
+}
+
+void RadarWidget::setTracks(const std::vector<TrackReport>& tracks) {
+    QMutexLocker lk(&_data_mutex);
+    _reported_tracks = tracks;
+}
+
+// Plots arrive as (distance, angle) pairs and are kept as world x, y so a
+// whole scan is drawn from one vertex array.
+void RadarWidget::setPlots(const std::vector<float>& plots) {
+    QMutexLocker lk(&_data_mutex);
+    const size_t n = plots.size() / 2;
+    _plot_xy.resize(n * 2);
+    for (size_t i = 0; i < n; ++i) {
+        const float distance = plots[2 * i];
+        const float angle = plots[2 * i + 1];
+        _plot_xy[2 * i] = distance * std::cos(angle);
+        _plot_xy[2 * i + 1] = distance * std::sin(angle);
+    }
+}
+
+// Long trails are kept per target id in compressed form (a few bits per
+// point instead of 24 bytes) and decoded only for drawing.
+void RadarWidget::updateTracks() {
+    for (int id : _track_ids) {
+        if (!_target_lookup.find(id)) {
+            _tracks.erase(id);
+        }
+    }
+    _track_ids.clear();
+
+    for (size_t i = 0; i < _targets.size(); ++i) {
+        const int id = _targets[i].id;
+        CompressedTrack* track = _tracks.find(id);
+        if (!track) {
+            _tracks.set(id, CompressedTrack());
+            track = _tracks.find(id);
+        }
+        track->append(_frame, _target_xs[i], _target_ys[i]);
+        track->trimFront(static_cast<size_t>(_trail_length));
+        _track_ids.push_back(id);
+    }
+    ++_frame;
+}
+
+void RadarWidget::setTrailLength(int frames) {
+    QMutexLocker lk(&_data_mutex);
+    _trail_length = std::max(frames, 0);
+    if (_trail_length == 0) {
+        _tracks = {};
+        _track_ids.clear();
+    }
+    _full_repaint = true;
+    update();
+}
+
+void RadarWidget::setPersistence(bool enabled) {
+    _persistence = enabled;
+    _persistence_pending = enabled;
+
+    if (!enabled) {
+        makeCurrent();
+        _persistence_fbo.reset();
+        doneCurrent();
+    }
+    _full_repaint = true;
+    update();
+}
+
+void RadarWidget::setPersistenceDecay(double decay) {
+    _persistence_decay = static_cast<float>(std::clamp(decay, 0.0, 1.0));
 }
 
 void RadarWidget::drawTargets() {
@@ -291,7 +529,58 @@ void RadarWidget::drawTargets() {
     }
 }
 
+void RadarWidget::drawPlots() {
+    if (_plot_xy.empty()) {
+        return;
+    }
+    const double scale = std::min(width(), height()) / 2.0 / 1000.0;
+
+    glPushMatrix();
+    glTranslated(width() / 2.0, height() / 2.0, 0.0);
+    glScaled(scale, scale, 1.0);
+
+    glColor3f(0.9f, 0.8f, 0.3f);
+    glPointSize(2.0f);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, _plot_xy.data());
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(_plot_xy.size() / 2));
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glPointSize(1.0f);
+
+    glPopMatrix();
+}
+
+// Estimated tracks: a square sized by the position uncertainty and a leader
+// line showing where the track will be in one tick.
+void RadarWidget::drawTracks() {
+    const double scale = std::min(width(), height()) / 2.0 / 1000.0;
+
+    glColor3f(0.2f, 1.0f, 0.4f);
+    for (const auto& track : _reported_tracks) {
+        QPointF center = polarToPixel(track.distance, track.angle);
+        const double half = std::max(4.0, 2.0 * track.sigma * scale);
+        const double lead = track.speed * scale;
+
+        glBegin(GL_LINE_LOOP);
+        glVertex2f(center.x() - half, center.y() - half);
+        glVertex2f(center.x() + half, center.y() - half);
+        glVertex2f(center.x() + half, center.y() + half);
+        glVertex2f(center.x() - half, center.y() + half);
+        glEnd();
+
+        glBegin(GL_LINES);
+        glVertex2f(center.x(), center.y());
+        glVertex2f(center.x() + lead * cos(track.heading), center.y() + lead * sin(track.heading));
+        glEnd();
+    }
+}
+
 void RadarWidget::drawTrails() {
+    if (_trail_length > 0) {
+        drawLongTrails();
+        return;
+    }
+
     for (const auto& target : _targets) {
         glColor3f(target.color[0], target.color[1], target.color[2]);
         glLineWidth(2.0f);
@@ -304,19 +593,184 @@ void RadarWidget::drawTrails() {
     }
 }
 
-void RadarWidget::generateNoise() {
-    static thread_local std::mt19937 gen{ std::random_device{}() };
-    static thread_local std::uniform_int_distribution<> dis{ 0, 80 };
-    for (auto& b : _noise_data) {
-        b = static_cast<uint8_t>(dis(gen));
+void RadarWidget::drawLongTrails() {
+    const double scale = std::min(width(), height()) / 2.0 / 1000.0;
+    const double cx = width() / 2.0;
+    const double cy = height() / 2.0;
+
+    glLineWidth(2.0f);
+    for (const auto& target : _targets) {
+        const CompressedTrack* track = _tracks.find(target.id);
+        if (!track) {
+            continue;
+        }
+        _trail_points.clear();
+        track->decodeLast(static_cast<size_t>(_trail_length), _trail_points);
+
+        glColor3f(target.color[0], target.color[1], target.color[2]);
+        glBegin(GL_LINE_STRIP);
+        for (const TrackPoint& p : _trail_points) {
+            glVertex2f(cx + p.x * scale, cy + p.y * scale);
+        }
+        glEnd();
     }
+    glLineWidth(1.0f);
 }
 
-void RadarWidget::drawNoise() {
+void RadarWidget::accumulatePersistence() {
+    const QSize fbo_size = size() * devicePixelRatioF();
+
+    if (!_persistence_fbo || _persistence_fbo->size() != fbo_size) {
+        _persistence_fbo = std::make_unique<QOpenGLFramebufferObject>(fbo_size);
+        _persistence_fbo->bind();
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT);
+        _persistence_fbo->release();
+    }
+
+    if (!_persistence_pending) {
+        return;
+    }
+    _persistence_pending = false;
+
+    GLboolean stencil = glIsEnabled(GL_STENCIL_TEST);
+    glDisable(GL_STENCIL_TEST);
+
+    _persistence_fbo->bind();
+    glViewport(0, 0, fbo_size.width(), fbo_size.height());
+
+    auto fill = [this]() {
+        glBegin(GL_QUADS);
+        glVertex2f(0, 0);
+        glVertex2f(width(), 0);
+        glVertex2f(width(), height());
+        glVertex2f(0, height());
+        glEnd();
+    };
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ZERO, GL_SRC_ALPHA);
+    glColor4f(0.0f, 0.0f, 0.0f, _persistence_decay);
+    fill();
+
+    // In 8 bits the multiply rounds a level below 0.5 / (1 - decay) back to
+    // itself, so one level is also taken off each pass to let trails reach
+    // black.
+    constexpr float LEVEL = 1.0f / 255.0f;
+    glBlendEquation(GL_FUNC_REVERSE_SUBTRACT);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glColor4f(LEVEL, LEVEL, LEVEL, LEVEL);
+    fill();
+    glBlendEquation(GL_FUNC_ADD);
+    glDisable(GL_BLEND);
+
+    glPointSize(4.0f);
+    glBegin(GL_POINTS);
+    for (const auto& target : _targets) {
+        QPointF p = polarToPixel(target.distance, target.angle);
+        glColor3f(target.color[0], target.color[1], target.color[2]);
+        glVertex2f(p.x(), p.y());
+    }
+    glEnd();
+    glPointSize(1.0f);
+
+    _persistence_fbo->release();
+    glViewport(0, 0, fbo_size.width(), fbo_size.height());
+
+    if (stencil) {
+        glEnable(GL_STENCIL_TEST);
+    }
+}
+
+void RadarWidget::drawPersistence() {
+    glColor3f(1.0f, 1.0f, 1.0f);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, _persistence_fbo->texture());
+    glBegin(GL_QUADS);
+    glTexCoord2f(0, 1); glVertex2f(0, 0);
+    glTexCoord2f(1, 1); glVertex2f(width(), 0);
+    glTexCoord2f(1, 0); glVertex2f(width(), height());
+    glTexCoord2f(0, 0); glVertex2f(0, height());
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_BLEND);
+}
+
+// Spokes come from the server's raw video and are kept in polar form; only
+// the spokes received since the last upload are scan converted. A change of
+// layout clears the picture.
+void RadarWidget::setVideoSpoke(int azimuth, int azimuths, const QByteArray& intensity) {
+    QMutexLocker lk(&_data_mutex);
+    const int bins = static_cast<int>(intensity.size());
+    if (azimuths != _video_azimuths || bins != _video_bins) {
+        _video_azimuths = azimuths;
+        _video_bins = bins;
+        _video_data.assign(size_t(azimuths) * bins, 0);
+        _spoke_dirty.assign(azimuths, 0);
+        _video_resized = true;
+    }
+    std::memcpy(_video_data.data() + size_t(azimuth) * bins, intensity.constData(), bins);
+    _spoke_dirty[azimuth] = 1;
+    _video_dirty = true;
+}
+
+// The texture holds the cartesian picture at widget size. A resize rebuilds
+// the converter and uploads everything; otherwise each run of new spokes is
+// converted and only the rectangle it covers is uploaded.
+void RadarWidget::uploadVideo() {
+    QMutexLocker lk(&_data_mutex);
+    if (!_video_tex || (!_video_dirty && !_video_resized)) {
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, _video_tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (_video_resized) {
+        _scan_converter.resize(width(), height(), _video_azimuths, _video_bins);
+        _scan_converter.convert(_video_data.data(), 0, _video_azimuths);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE,
+            _scan_converter.width(), _scan_converter.height(), 0,
+            GL_LUMINANCE, GL_UNSIGNED_BYTE,
+            _scan_converter.image());
+        std::fill(_spoke_dirty.begin(), _spoke_dirty.end(), 0);
+        _video_resized = false;
+    }
+    else {
+        ScanConverter::Rect changed;
+        for (int a = 0; a < _video_azimuths;) {
+            if (!_spoke_dirty[a]) {
+                ++a;
+                continue;
+            }
+            int end = a;
+            while (end < _video_azimuths && _spoke_dirty[end]) {
+                _spoke_dirty[end++] = 0;
+            }
+            changed.unite(_scan_converter.convert(_video_data.data(), a, end - a));
+            a = end;
+        }
+        if (!changed.empty()) {
+            const int stride = _scan_converter.width();
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, changed.x0, changed.y0,
+                changed.x1 - changed.x0, changed.y1 - changed.y0,
+                GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                _scan_converter.image() + size_t(changed.y0) * stride + changed.x0);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    _video_dirty = false;
+}
+
+void RadarWidget::drawVideo() {
     glColor3f(1.0f, 1.0f, 1.0f);
 
     glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, _noise_tex);
+    glBindTexture(GL_TEXTURE_2D, _video_tex);
     glBegin(GL_QUADS);
     glTexCoord2f(0, 0); glVertex2f(0, 0);
     glTexCoord2f(1, 0); glVertex2f(width(), 0);
@@ -338,6 +792,12 @@ Eigen::Vector2d RadarWidget::pixelToPolar(const QPointF& pos) const {
     return { (distance / maxPixels) * 1000.0, angle };
 }
 
+Eigen::Vector2d RadarWidget::pixelToWorld(const QPointF& pos) const {
+    double maxPixels = std::min(width(), height()) / 2.0;
+    double scale = 1000.0 / maxPixels;
+    return { (pos.x() - width() / 2) * scale, (pos.y() - height() / 2) * scale };
+}
+
 QPointF RadarWidget::polarToPixel(double distance, double angle) const {
     double maxPixels = std::min(width(), height()) / 2.0;
     double r = (distance / 1000.0) * maxPixels;
@@ -347,28 +807,51 @@ QPointF RadarWidget::polarToPixel(double distance, double angle) const {
     );
 }
 
+int RadarWidget::pickTarget(const QPointF& pos) {
+    QMutexLocker lk(&_data_mutex);
+    if (_target_index_stale) {
+        _target_index.build(_target_xs, _target_ys);
+        _target_index_stale = false;
+    }
+    double maxPixels = std::min(width(), height()) / 2.0;
+    double radius = PICK_RADIUS_PX * 1000.0 / maxPixels;
+    Eigen::Vector2d world = pixelToWorld(pos);
+
+    return _target_index.nearest(world.x(), world.y(), radius);
+}
+
 void RadarWidget::mouseMoveEvent(QMouseEvent* event) {
     _cursor_pos = event->pos();
     Eigen::Vector2d polar = pixelToPolar(_cursor_pos);
     emit cursorPositionChanged(polar[0], polar[1] * 180 / EIGEN_PI);
-}
 
-void RadarWidget::mousePressEvent(QMouseEvent* event) {
-    Eigen::Vector2d polar = pixelToPolar(event->pos());
-    double min_dist = std::numeric_limits<double>::max();
-    int selected_id = -1;
-
-    for (const auto& target : _targets) {
-        double dx = target.distance - polar[0];
-        double dy = target.angle - polar[1];
-        double dist = sqrt(dx * dx + dy * dy);
+    int idx = pickTarget(_cursor_pos);
+    int hover_id = idx >= 0 ? _targets[idx].id : -1;
+    if (hover_id == _hover_target_id) {
+        return;
+    }
+    _hover_target_id = hover_id;
 
-        if (dist < min_dist && dist < 50) {
-            min_dist = dist;
-            selected_id = target.id;
-        }
+    if (idx < 0) {
+        QToolTip::hideText();
+        return;
     }
 
+    const Target& t = _targets[idx];
+    QToolTip::showText(
+        event->globalPos(),
+        QString("Target %1\n%2 m, %3°")
+            .arg(t.id)
+            .arg(t.distance, 0, 'f', 1)
+            .arg(t.angle * 180.0 / EIGEN_PI, 0, 'f', 1),
+        this
+    );
+}
+
+void RadarWidget::mousePressEvent(QMouseEvent* event) {
+    int idx = pickTarget(event->pos());
+    int selected_id = idx >= 0 ? _targets[idx].id : -1;
+
     _selected_target_id = selected_id;
     emit targetSelected(selected_id);
 }
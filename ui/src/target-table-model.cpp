@@ -0,0 +1,383 @@
+#include "target-table-model.h"
+#include <QString>
+#include <algorithm>
+#include <cstring>
+
+static uint64_t orderedKeyBits(double key, bool ascending) {
+    uint64_t bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    bits = (bits & 0x8000000000000000ull) ? ~bits : bits | 0x8000000000000000ull;
+    return ascending ? bits : ~bits;
+}
+
+TargetTableModel::TargetTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int TargetTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(_order.size());
+}
+
+int TargetTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TargetTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+
+    const int slot = _order[index.row()];
+    if (role == Qt::UserRole) {
+        return _ids[slot];
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+    case IdColumn:
+        return _ids[slot];
+    case DistanceColumn:
+        return QString::number(_distances[slot], 'f', 1);
+    case BearingColumn:
+        return QString::number(_bearings[slot], 'f', 1) + QChar(0x00B0);
+    default:
+        return QVariant();
+    }
+}
+
+QVariant TargetTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QVariant();
+    }
+
+    switch (section) {
+    case IdColumn:
+        return QStringLiteral("ID");
+    case DistanceColumn:
+        return QStringLiteral("Distance");
+    case BearingColumn:
+        return QStringLiteral("Bearing");
+    default:
+        return QVariant();
+    }
+}
+
+void TargetTableModel::sort(int column, Qt::SortOrder order) {
+    if (column < 0 || column >= ColumnCount) {
+        return;
+    }
+    _sort_column = column;
+    _sort_order = order;
+    restoreOrder();
+}
+
+void TargetTableModel::updateTargets(const std::vector<Target>& targets) {
+    ++_frame;
+    _fresh.clear();
+
+    bool changed = false;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        const Target& t = targets[i];
+        const int* found = _slot_of.find(t.id);
+        if (!found) {
+            _fresh.push_back(i);
+            continue;
+        }
+
+        const int slot = *found;
+        const double deg = t.angle * 180.0 / EIGEN_PI;
+        _seen[slot] = _frame;
+        if (_distances[slot] != t.distance || _bearings[slot] != deg) {
+            _distances[slot] = t.distance;
+            _bearings[slot] = deg;
+            changed = true;
+        }
+    }
+
+    hideRows([this](int slot) {
+        return _seen[slot] != _frame || !accepts(slot);
+    });
+    releaseUnseenSlots();
+
+    for (size_t i : _fresh) {
+        const Target& t = targets[i];
+        _slot_of.set(t.id, static_cast<int>(_ids.size()));
+        _ids.push_back(t.id);
+        _distances.push_back(t.distance);
+        _bearings.push_back(t.angle * 180.0 / EIGEN_PI);
+        _keys.push_back(0.0);
+        _seen.push_back(_frame);
+        _row_of_slot.push_back(-1);
+    }
+
+    if (changed && !_order.empty()) {
+        emit dataChanged(
+            index(0, DistanceColumn),
+            index(rowCount() - 1, BearingColumn),
+            { Qt::DisplayRole }
+        );
+    }
+
+    showAcceptedRows();
+    restoreOrder();
+}
+
+void TargetTableModel::setRangeFilter(double min_distance, double max_distance) {
+    _min_distance = min_distance;
+    _max_distance = max_distance;
+    refilter();
+}
+
+void TargetTableModel::setBearingFilter(double from_deg, double to_deg) {
+    _bearing_from = from_deg;
+    _bearing_to = to_deg;
+    refilter();
+}
+
+void TargetTableModel::clearFilters() {
+    _min_distance = 0.0;
+    _max_distance = std::numeric_limits<double>::max();
+    _bearing_from = 0.0;
+    _bearing_to = 360.0;
+    refilter();
+}
+
+void TargetTableModel::refilter() {
+    hideRows([this](int slot) {
+        return !accepts(slot);
+    });
+    showAcceptedRows();
+    restoreOrder();
+}
+
+bool TargetTableModel::accepts(int slot) const {
+    const double d = _distances[slot];
+    if (d < _min_distance || d > _max_distance) {
+        return false;
+    }
+
+    const double b = _bearings[slot];
+    if (_bearing_from <= _bearing_to) {
+        return b >= _bearing_from && b <= _bearing_to;
+    }
+    return b >= _bearing_from || b <= _bearing_to;
+}
+
+bool TargetTableModel::lessThan(int a, int b) const {
+    if (_keys[a] != _keys[b]) {
+        return _sort_order == Qt::AscendingOrder ? _keys[a] < _keys[b] : _keys[a] > _keys[b];
+    }
+    return _ids[a] < _ids[b];
+}
+
+template<typename Pred>
+void TargetTableModel::hideRows(Pred&& hide) {
+    int first_removed = -1;
+
+    for (int row = rowCount() - 1; row >= 0; ) {
+        if (!hide(_order[row])) {
+            --row;
+            continue;
+        }
+
+        const int last = row;
+        while (row >= 0 && hide(_order[row])) {
+            _row_of_slot[_order[row]] = -1;
+            --row;
+        }
+        const int first = row + 1;
+
+        beginRemoveRows(QModelIndex(), first, last);
+        _order.erase(_order.begin() + first, _order.begin() + last + 1);
+        endRemoveRows();
+
+        first_removed = first;
+    }
+
+    if (first_removed < 0) {
+        return;
+    }
+    for (int row = first_removed; row < rowCount(); ++row) {
+        _row_of_slot[_order[row]] = row;
+    }
+}
+
+void TargetTableModel::showAcceptedRows() {
+    _next_order.clear();
+    for (int slot = 0; slot < static_cast<int>(_ids.size()); ++slot) {
+        if (_row_of_slot[slot] < 0 && accepts(slot)) {
+            _next_order.push_back(slot);
+        }
+    }
+    if (_next_order.empty()) {
+        return;
+    }
+
+    const int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(_next_order.size()) - 1);
+    for (int slot : _next_order) {
+        _row_of_slot[slot] = static_cast<int>(_order.size());
+        _order.push_back(slot);
+    }
+    endInsertRows();
+}
+
+void TargetTableModel::releaseUnseenSlots() {
+    for (int slot = static_cast<int>(_ids.size()) - 1; slot >= 0; --slot) {
+        if (_seen[slot] == _frame) {
+            continue;
+        }
+
+        _slot_of.erase(_ids[slot]);
+
+        const int last = static_cast<int>(_ids.size()) - 1;
+        if (slot != last) {
+            _ids[slot] = _ids[last];
+            _distances[slot] = _distances[last];
+            _bearings[slot] = _bearings[last];
+            _keys[slot] = _keys[last];
+            _seen[slot] = _seen[last];
+            _row_of_slot[slot] = _row_of_slot[last];
+
+            _slot_of.set(_ids[slot], slot);
+            if (_row_of_slot[slot] >= 0) {
+                _order[_row_of_slot[slot]] = slot;
+            }
+        }
+
+        _ids.pop_back();
+        _distances.pop_back();
+        _bearings.pop_back();
+        _keys.pop_back();
+        _seen.pop_back();
+        _row_of_slot.pop_back();
+    }
+}
+
+void TargetTableModel::restoreOrder() {
+    for (size_t slot = 0; slot < _ids.size(); ++slot) {
+        switch (_sort_column) {
+        case DistanceColumn:
+            _keys[slot] = _distances[slot];
+            break;
+        case BearingColumn:
+            _keys[slot] = _bearings[slot];
+            break;
+        default:
+            _keys[slot] = _ids[slot];
+            break;
+        }
+    }
+
+    // Rows that are still ordered relative to their neighbours stay put; only
+    // the displaced ones are sorted and merged back in.
+    _kept.clear();
+    _displaced.clear();
+    const bool ascending = _sort_order == Qt::AscendingOrder;
+    const size_t n = _order.size();
+    for (size_t i = 0; i < n; ++i) {
+        const int slot = _order[i];
+        const bool before_next = i + 1 == n || !lessThan(_order[i + 1], slot);
+        const bool after_kept = _kept.empty() || !lessThan(slot, _kept.back());
+        if (before_next && after_kept) {
+            _kept.push_back(slot);
+        }
+        else {
+            _displaced.push_back({ orderedKeyBits(_keys[slot], ascending), static_cast<uint32_t>(_ids[slot]), slot });
+        }
+    }
+
+    if (_displaced.empty()) {
+        return;
+    }
+
+    sortDisplaced();
+
+    _next_order.clear();
+    size_t k = 0;
+    for (const SortEntry& e : _displaced) {
+        while (k < _kept.size() && lessThan(_kept[k], e.slot)) {
+            _next_order.push_back(_kept[k++]);
+        }
+        _next_order.push_back(e.slot);
+    }
+    _next_order.insert(_next_order.end(), _kept.begin() + k, _kept.end());
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve(from.size());
+
+    _order.swap(_next_order);
+    for (size_t row = 0; row < n; ++row) {
+        _row_of_slot[_order[row]] = static_cast<int>(row);
+    }
+
+    for (const QModelIndex& idx : from) {
+        const int slot = _next_order[idx.row()];
+        to.append(index(_row_of_slot[slot], idx.column()));
+    }
+    changePersistentIndexList(from, to);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void TargetTableModel::sortDisplaced() {
+    constexpr size_t RADIX_THRESHOLD = 512;
+    constexpr int DIGIT_BITS = 11;
+    constexpr size_t BUCKETS = size_t(1) << DIGIT_BITS;
+
+    if (_displaced.size() < RADIX_THRESHOLD) {
+        std::sort(_displaced.begin(), _displaced.end(), [](const SortEntry& a, const SortEntry& b) {
+            return a.key != b.key ? a.key < b.key : a.id < b.id;
+        });
+        return;
+    }
+
+    _radix_buffer.resize(_displaced.size());
+    std::vector<uint32_t> counts(BUCKETS);
+
+    // Least significant digits first: the id, then the key.
+    auto pass = [&](auto digit) {
+        std::fill(counts.begin(), counts.end(), 0);
+        for (const SortEntry& e : _displaced) {
+            ++counts[digit(e)];
+        }
+        if (counts[digit(_displaced.front())] == _displaced.size()) {
+            return;
+        }
+
+        uint32_t sum = 0;
+        for (uint32_t& c : counts) {
+            uint32_t tmp = c;
+            c = sum;
+            sum += tmp;
+        }
+        for (const SortEntry& e : _displaced) {
+            _radix_buffer[counts[digit(e)]++] = e;
+        }
+        _displaced.swap(_radix_buffer);
+    };
+    for (int shift = 0; shift < 32; shift += DIGIT_BITS) {
+        pass([shift](const SortEntry& e) { return (e.id >> shift) & (BUCKETS - 1); });
+    }
+    for (int shift = 0; shift < 64; shift += DIGIT_BITS) {
+        pass([shift](const SortEntry& e) { return (e.key >> shift) & (BUCKETS - 1); });
+    }
+}
+
+int TargetTableModel::rowForId(int id) const {
+    const int* slot = _slot_of.find(id);
+    return slot ? _row_of_slot[*slot] : -1;
+}
+
+int TargetTableModel::idAt(int row) const {
+    if (row < 0 || row >= rowCount()) {
+        return -1;
+    }
+    return _ids[_order[row]];
+}
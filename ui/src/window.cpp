@@ -2,8 +2,12 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QHeaderView>
-#include <QTableWidget>
+#include <QTableView>
 #include <QPushButton>
+#include <QCheckBox>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QFormLayout>
 #include <QStatusBar>
 #include <QTimer>
 #include <QApplication>
@@ -42,6 +46,13 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
 
     _client = new NetworkClient(this);
     connect(_client, &NetworkClient::newFrame, this, &MainWindow::handleNewFrame);
+    connect(_client, &NetworkClient::newSector, this, &MainWindow::handleNewSector);
+    connect(_client, &NetworkClient::targetEvents, this, &MainWindow::handleTargetEvents);
+    connect(_client, &NetworkClient::newTracks, this, &MainWindow::handleNewTracks);
+    connect(_client, &NetworkClient::newPlots, this, &MainWindow::handleNewPlots);
+    connect(_client, &NetworkClient::trackerStats, this, &MainWindow::handleTrackerStats);
+    connect(_client, &NetworkClient::newAlarms, this, &MainWindow::handleAlarms);
+    connect(_client, &NetworkClient::videoSpoke, this, &MainWindow::handleVideoSpoke);
     connect(_client, &NetworkClient::errorOccured, this, &MainWindow::handleError);
     _client->connectToServer("127.0.0.1", 5555);
 }
@@ -57,14 +68,19 @@ void MainWindow::setupUI() {
     right->setFixedWidth(400);
     auto* vl = new QVBoxLayout(right);
 
-    _table = new QTableWidget(0, 3);
-    _table->setHorizontalHeaderLabels({ "ID","Distance","Bearing" });
+    _table_model = new TargetTableModel(this);
+    _table = new QTableView;
+    _table->setModel(_table_model);
     _table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     _table->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     _table->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     _table->verticalHeader()->setVisible(false);
+    _table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     _table->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    _table->setSelectionBehavior(QTableWidget::SelectRows);
+    _table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _table->setSelectionMode(QAbstractItemView::SingleSelection);
+    _table->setSortingEnabled(true);
+    _table->sortByColumn(TargetTableModel::IdColumn, Qt::AscendingOrder);
 
     int row_h = _table->verticalHeader()->defaultSectionSize();
     int header_h = _table->horizontalHeader()->height();
@@ -75,10 +91,10 @@ void MainWindow::setupUI() {
 
     vl->addWidget(_table);
 
-    connect(_table, &QTableWidget::itemSelectionChanged, this, [this]() {
-        auto items = _table->selectedItems();
-        if (!items.isEmpty()) {
-            int id = items.first()->text().toInt();
+    connect(_table->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this]() {
+        auto rows = _table->selectionModel()->selectedRows();
+        if (!rows.isEmpty()) {
+            int id = _table_model->idAt(rows.first().row());
             _selected_target_id = id;
             _radar->selectTarget(id);
         }
@@ -88,10 +104,69 @@ void MainWindow::setupUI() {
         }
     });
 
+    auto makeSpin = [](double min, double max, double value) {
+        auto* spin = new QDoubleSpinBox;
+        spin->setRange(min, max);
+        spin->setDecimals(0);
+        spin->setValue(value);
+        return spin;
+    };
+
+    auto* min_range = makeSpin(0, 1000, 0);
+    auto* max_range = makeSpin(0, 1000, 1000);
+    auto* bearing_from = makeSpin(0, 360, 0);
+    auto* bearing_to = makeSpin(0, 360, 360);
+
+    auto* range_row = new QHBoxLayout;
+    range_row->addWidget(min_range);
+    range_row->addWidget(max_range);
+    auto* bearing_row = new QHBoxLayout;
+    bearing_row->addWidget(bearing_from);
+    bearing_row->addWidget(bearing_to);
+
+    auto* filters = new QFormLayout;
+    filters->addRow("Range, m", range_row);
+    filters->addRow("Bearing, °", bearing_row);
+    vl->addLayout(filters);
+
+    auto applyRange = [this, min_range, max_range]() {
+        _table_model->setRangeFilter(min_range->value(), max_range->value());
+    };
+    auto applyBearing = [this, bearing_from, bearing_to]() {
+        _table_model->setBearingFilter(bearing_from->value(), bearing_to->value());
+    };
+    connect(min_range, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, applyRange);
+    connect(max_range, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, applyRange);
+    connect(bearing_from, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, applyBearing);
+    connect(bearing_to, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, applyBearing);
+
     _cursor_label = new QLabel("Cursor: —");
     _cursor_label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
     vl->addWidget(_cursor_label);
 
+    _tracker_label = new QLabel;
+    _tracker_label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+    _tracker_label->hide();
+    vl->addWidget(_tracker_label);
+
+    _alarm_label = new QLabel;
+    _alarm_label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+    _alarm_label->setWordWrap(true);
+    _alarm_label->hide();
+    vl->addWidget(_alarm_label);
+
+    auto* persistence_box = new QCheckBox("Persistence");
+    connect(persistence_box, &QCheckBox::toggled, _radar, &RadarWidget::setPersistence);
+    vl->addWidget(persistence_box);
+
+    auto* trail_length = new QSpinBox;
+    trail_length->setRange(0, 10000);
+    trail_length->setSpecialValueText("Short");
+    connect(trail_length, QOverload<int>::of(&QSpinBox::valueChanged), _radar, &RadarWidget::setTrailLength);
+    auto* trail_form = new QFormLayout;
+    trail_form->addRow("Trail, frames", trail_length);
+    vl->addLayout(trail_form);
+
     _pause_button = new QPushButton("Pause");
     _exit_button  = new QPushButton("Exit");
     connect(_pause_button, &QPushButton::clicked, this, &MainWindow::togglePause);
@@ -183,60 +258,98 @@ void MainWindow::handleNewFrame(const std::vector<Target>& targets) {
     if (_paused) {
         return;
     }
-    int current_selection = _selected_target_id;
     _radar->setTargets(targets);
+    _table_model->updateTargets(targets);
+}
 
-    const int N = int(targets.size());
-    int rows = std::max(N, 9);
-    _table->setRowCount(rows);
-
-    _table->blockSignals(true);
-
-    _table->clearContents();
-    for (int i = 0; i < rows; ++i) {
-        if (i < N) {
-            const auto& t = targets[i];
-            _table->setItem(i, 0, new QTableWidgetItem(QString::number(t.id)));
-            _table->setItem(i, 1, new QTableWidgetItem(QString::number(t.distance)));
-            double deg = t.angle * 180.0 / EIGEN_PI;
-            _table->setItem(i, 2, new QTableWidgetItem(
-                QString::number(deg, 'f', 1) + QChar(0x00B0)
-            ));
-
-            if (t.id == current_selection) {
-                _table->selectRow(i);
-            }
-        }
-        else {
-            _table->setItem(i, 0, new QTableWidgetItem(QString()));
-            _table->setItem(i, 1, new QTableWidgetItem(QString()));
-            _table->setItem(i, 2, new QTableWidgetItem(QString()));
-        }
+// In sweep mode the table follows once per revolution; the radar view takes
+// every sector as it comes.
+void MainWindow::handleNewSector(int sector, int sectors, const std::vector<Target>& targets) {
+    if (_paused) {
+        return;
+    }
+    _radar->setSectorTargets(sector, sectors, targets);
+    if (sector + 1 == sectors) {
+        _table_model->updateTargets(_radar->targets());
     }
+}
 
-    _table->blockSignals(false);
+void MainWindow::handleNewTracks(const std::vector<TrackReport>& tracks) {
+    if (_paused) {
+        return;
+    }
+    _radar->setTracks(tracks);
 }
 
-void MainWindow::onTargetSelected(int id) {
-    _selected_target_id = id;
+void MainWindow::handleNewPlots(const std::vector<float>& plots) {
+    if (_paused) {
+        return;
+    }
+    _radar->setPlots(plots);
+}
 
-    if (id < 0) {
-        _table->clearSelection();
+void MainWindow::handleVideoSpoke(int azimuth, int azimuths, const QByteArray& intensity) {
+    if (_paused) {
         return;
     }
+    _radar->setVideoSpoke(azimuth, azimuths, intensity);
+}
 
-    _table->blockSignals(true);
+void MainWindow::handleTrackerStats(const TrackerStats& stats) {
+    _tracker_label->setText(
+        QString("Tracks: %1 confirmed, %2 coasting, %3 tentative, %4 ms")
+        .arg(stats.confirmed)
+        .arg(stats.coasting)
+        .arg(stats.tentative)
+        .arg(stats.tick_ms, 0, 'f', 2)
+    );
+    _tracker_label->show();
+}
+
+void MainWindow::handleAlarms(const std::vector<AlarmReport>& alarms) {
+    if (alarms.empty()) {
+        return;
+    }
+    _alarm_count += alarms.size();
+    const AlarmReport& last = alarms.back();
+    _alarm_label->setText(
+        QString("Alarms: %1, last %2 on target %3")
+        .arg(_alarm_count)
+        .arg(QString::fromStdString(last.rule))
+        .arg(last.id)
+    );
+    _alarm_label->show();
+    _status_bar->showMessage(
+        QString("Alarm %1: target %2 at %3 m, %4°")
+        .arg(QString::fromStdString(last.rule))
+        .arg(last.id)
+        .arg(last.distance, 0, 'f', 1)
+        .arg(last.angle * 180.0 / EIGEN_PI, 0, 'f', 1),
+        3000
+    );
+}
 
-    for (int i = 0; i < _table->rowCount(); ++i) {
-        if (_table->item(i, 0) && _table->item(i, 0)->text().toInt() == id) {
-            _table->selectRow(i);
-            QModelIndex idx = _table->model()->index(i, 0);
-            _table->scrollTo(idx, QAbstractItemView::PositionAtCenter);
-            break;
+void MainWindow::handleTargetEvents(const std::vector<TargetEvent>& events) {
+    for (const auto& e : events) {
+        if (e.type == TargetEvent::Type::Despawned && e.id == _selected_target_id) {
+            _radar->selectTarget(-1);
+            onTargetSelected(-1);
+            _status_bar->showMessage(QString("Target %1 despawned").arg(e.id), 2000);
         }
     }
+}
+
+void MainWindow::onTargetSelected(int id) {
+    _selected_target_id = id;
+
+    int row = _table_model->rowForId(id);
+    if (row < 0) {
+        _table->clearSelection();
+        return;
+    }
 
-    _table->blockSignals(false);
+    _table->selectRow(row);
+    _table->scrollTo(_table_model->index(row, 0), QAbstractItemView::PositionAtCenter);
 }
 
 void MainWindow::onCursorMoved(double dist, double ang) {